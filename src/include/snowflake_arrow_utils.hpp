@@ -4,13 +4,20 @@
 #include "duckdb/common/arrow/arrow_wrapper.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/common/adbc/adbc.h"
+#include "duckdb/main/client_properties.hpp"
 #include "duckdb/storage/table/scan_state.hpp"
 
 #include <utility>
 #include "snowflake_client_manager.hpp"
+#include "snowflake_conversion_stream.hpp"
+#include "snowflake_query_builder.hpp"
 
 namespace duckdb {
 
+namespace snowflake {
+class SnowflakeScanGroup;
+} // namespace snowflake
+
 // Factory structure to hold ADBC connection and query information
 // This factory pattern allows us to integrate with DuckDB's arrow_scan table
 // function which expects a factory that can produce ArrowArrayStreamWrapper
@@ -25,6 +32,11 @@ struct SnowflakeArrowStreamFactory {
 	// Modified query after applying pushdown (if enabled)
 	std::string modified_query;
 
+	// Qualified table the base query reads (empty: taken from the query's FROM clause)
+	std::string table_name;
+	// Point in the history of the table the scan reads (not set: the current data)
+	snowflake::SnowflakeTimeTravel time_travel;
+
 	// ADBC statement handle - initialized lazily when first needed
 	AdbcStatement statement;
 	bool statement_initialized = false;
@@ -38,23 +50,75 @@ struct SnowflakeArrowStreamFactory {
 	TableFilterSet *current_filters = nullptr;
 	vector<string> column_names; // Maps column indices to names for filter building
 
+	// Fetch tuning applied as statement options (0 = driver default)
+	int32_t prefetch_concurrency = 0;
+	int32_t result_queue_size = 0;
+
+	// Tag of the last executed query, used to find its result again if the stream fails
+	// (empty when the query is not resumable)
+	std::string query_tag;
+	// Testing only: the result stream fails once after this many rows and is resumed (0 = never)
+	idx_t inject_stream_failure = 0;
+	// Number of the last executed statement on the connection (SnowflakeClient::CountStatement)
+	idx_t statement_number = 0;
+
+	// Qualified tables the query reads. When set, the query ID of an executed query is recorded with
+	// the versions of these tables, and an identical query reads that result with RESULT_SCAN while
+	// the tables are unchanged (snowflake_reuse_results).
+	vector<std::string> result_tables;
+
+	// Columns rewritten while fetching (NUMBER mapping, timestamp layouts)
+	vector<snowflake::SnowflakeColumnConversion> column_conversions;
+
+	// Columns fetched as expressions and assembled into STRUCTs (shredded VARIANT columns)
+	shared_ptr<const snowflake::column_expansion_map_t> column_expansions;
+	vector<snowflake::SnowflakeStructAssembly> struct_assemblies;
+
+	// Values bound to the ? markers of the query, in order
+	vector<Value> parameters;
+	ClientProperties client_properties;
+	// Key of the statement in the client's prepared statement cache (empty: not cached)
+	std::string statement_cache_key;
+	// Result schema of the query, shared with the statement cache
+	shared_ptr<ArrowSchemaWrapper> result_schema;
+	// Whether result_schema was bound from a cache rather than looked up for this scan; the scan
+	// then checks it against the schema of the result
+	bool result_schema_cached = false;
+	// Session the statement was created on, kept open until the statement is released
+	shared_ptr<snowflake::SnowflakeSession> session;
+
+	// The scan must run on the session of `connection` (a remote transaction), not on a pooled one
+	bool session_bound = false;
+	// The Snowflake scans of the plan this scan belongs to, whose queries are submitted together
+	// (null: the scan submits its query when it starts)
+	shared_ptr<snowflake::SnowflakeScanGroup> scan_group;
+
 	SnowflakeArrowStreamFactory(shared_ptr<snowflake::SnowflakeClient> conn, const std::string &query_str)
 	    : connection(std::move(conn)), query(query_str), modified_query(query_str) {
 		std::memset(&statement, 0, sizeof(statement));
 	}
 
-	~SnowflakeArrowStreamFactory() {
-		// Clean up the ADBC statement if it was initialized
-		if (statement_initialized) {
-			AdbcError error;
-			AdbcStatementRelease(&statement, &error);
-		}
+	// Releases the ADBC statement, or hands it back to the statement cache
+	~SnowflakeArrowStreamFactory();
+
+	// Resolve fetch options for this scan; 'auto' prefetch concurrency follows the thread count
+	void SetFetchOptions(const snowflake::SnowflakeFetchOptions &options, idx_t thread_count) {
+		prefetch_concurrency = options.GetPrefetchConcurrency(thread_count);
+		result_queue_size = options.result_queue_size;
 	}
 
+	// Bind `values` to the query's ? markers. The statement and result schema of the query are
+	// taken from the client's prepared statement cache if it has them, and returned to it after
+	// the scan.
+	void SetParameters(vector<Value> values, ClientProperties properties);
+
 	// Update pushdown parameters from DuckDB optimizer
 	// This is called by DuckDB when it wants to push filters and projections to
 	// the source
 	void UpdatePushdownParameters(const vector<string> &projection, TableFilterSet *filter_set);
+
+	// The query UpdatePushdownParameters would run for these pushdown parameters
+	std::string BuildPushdownQuery(const vector<string> &projection, TableFilterSet *filter_set) const;
 };
 
 // Function to produce an ArrowArrayStreamWrapper from the factory
@@ -74,4 +138,10 @@ unique_ptr<ArrowArrayStreamWrapper> SnowflakeProduceArrowScan(uintptr_t factory_
 //   Arrow schema
 void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema);
 
+namespace snowflake {
+// Fill `schema` with a view of `source` that keeps it alive until the view is released. The view has
+// its own children array, so binding may reorder the children without affecting other views.
+void ShareArrowSchema(shared_ptr<ArrowSchemaWrapper> source, ArrowSchema &schema);
+} // namespace snowflake
+
 } // namespace duckdb
@@ -2,10 +2,17 @@
 
 #include "duckdb.hpp"
 #include "snowflake_config.hpp"
+#include "snowflake_database.hpp"
 
 #include "duckdb/common/adbc/adbc.h"
+#include "duckdb/common/arrow/arrow_wrapper.hpp"
 // Note: driver_manager functions are provided by DuckDB's build
 
+#include <atomic>
+#include <future>
+#include <list>
+#include <mutex>
+
 namespace duckdb {
 namespace snowflake {
 
@@ -15,42 +22,162 @@ struct SnowflakeColumn {
 	bool is_nullable;
 };
 
+//! An authenticated ADBC connection of a client. The client and every statement created on the connection hold
+//! it, so a session replaced by Reconnect stays open until the last of its statements is released. It is then
+//! reset and returned to the idle pool, or closed if it was marked for discarding.
+struct SnowflakeSession {
+	explicit SnowflakeSession(shared_ptr<SnowflakeDatabase> database);
+	~SnowflakeSession();
+
+	SnowflakeSession(const SnowflakeSession &) = delete;
+	SnowflakeSession &operator=(const SnowflakeSession &) = delete;
+
+	shared_ptr<SnowflakeDatabase> database;
+	AdbcConnection connection;
+	//! Auto-commit was switched off by SetAutoCommit, so the session may have an open transaction
+	std::atomic<bool> in_transaction {false};
+	//! Close the session when it is released instead of returning it to the idle pool
+	std::atomic<bool> discard {false};
+};
+
+//! A statement of a parameterized query with its result schema, kept by the client to run the same
+//! query text again without preparing it and looking up its schema
+struct SnowflakePreparedStatement {
+	SnowflakePreparedStatement();
+	~SnowflakePreparedStatement();
+
+	AdbcStatement statement;
+	shared_ptr<ArrowSchemaWrapper> schema;
+	//! Session the statement was created on, kept open until the statement is released
+	shared_ptr<SnowflakeSession> session;
+};
+
 class SnowflakeClient {
 public:
 	SnowflakeClient();
 	~SnowflakeClient();
 
 	void Connect(const SnowflakeConfig &config);
+	//! Start connecting on a background thread and return immediately. Anything
+	//! that needs the session (GetSession, metadata queries) waits for it.
+	void ConnectAsync(const SnowflakeConfig &config);
+	//! Block until a pending ConnectAsync has finished; rethrows its error
+	void WaitForConnection();
+	//! Whether a ConnectAsync is still in flight
+	bool IsConnecting();
 	void Disconnect();
+	//! Replace the current session with a freshly authenticated one (e.g. after it expired)
+	void Reconnect();
 	bool IsConnected() const;
 	bool TestConnection();
+	//! Close the session for good on Disconnect instead of returning it to the idle pool. For
+	//! sessions that ran user statements, which may have changed them in ways a later user of
+	//! the session would not expect (USE, ALTER SESSION, BEGIN, temporary tables).
+	void DiscardSessionOnRelease() {
+		discard_session = true;
+	}
 
-	AdbcConnection *GetConnection() {
-		return &connection;
+	//! The current session, to create a statement on its connection. The caller keeps it until the statement is
+	//! released, so a Reconnect on another thread cannot close the connection underneath the statement. Each call
+	//! counts as a statement.
+	shared_ptr<SnowflakeSession> GetSession();
+	//! Count a statement created earlier that is about to run again, and return the number of the
+	//! statements started on this client so far
+	idx_t CountStatement() {
+		return ++statement_count;
 	}
 	AdbcDatabase *GetDatabase() {
-		return &database;
+		return database->GetDatabase();
 	}
 	const SnowflakeConfig &GetConfig() const;
 
-	vector<string> ListSchemas(ClientContext &context);
-	vector<string> ListTables(ClientContext &context, const string &schema);
+	vector<string> ListSchemas();
+	vector<string> ListTables(const string &schema);
 	vector<SnowflakeColumn> GetTableInfo(ClientContext &context, const string &schema, const string &table_name);
+	//! Names of the PRIMARY KEY columns of a table (empty if it has none). Snowflake does not
+	//! enforce the key, but it is the natural match key for upserts.
+	vector<string> GetPrimaryKeyColumns(const string &schema, const string &table_name);
+	//! MIN and MAX of each of the given columns as text (empty for NULL). Snowflake answers this
+	//! from micro-partition metadata, without scanning the table.
+	vector<std::pair<string, string>> GetColumnRanges(const string &schema, const string &table_name,
+	                                                  const vector<string> &column_names);
+	//! Size of a table in bytes as Snowflake reports it in its metadata (-1 if it reports none, e.g.
+	//! for a view)
+	int64_t GetTableBytes(const string &schema, const string &table_name);
+	//! MIN and MAX of a Snowflake expression over `relation` (a table name as written in a query) as text,
+	//! empty if the relation has no rows
+	std::pair<string, string> GetExpressionRange(const string &relation, const string &expression);
+	//! Values as text of the first combination of `column_names` that occurs in more than one row of
+	//! `relation` (a table name as written in a query); empty if every combination is unique. Rows
+	//! with a NULL in one of the columns are not considered.
+	vector<string> FindDuplicateKey(const string &relation, const vector<string> &column_names);
+	//! Top-level keys of the object values of a VARIANT / OBJECT column in a sample of
+	//! `sample_rows` rows, each with the comma-separated TYPEOF names of its values
+	vector<std::pair<string, string>> GetVariantKeys(const string &schema, const string &table_name,
+	                                                 const string &column_name, idx_t sample_rows);
+	//! Find the ID of the most recent successful query of this user carrying the given QUERY_TAG
+	string GetQueryIdByTag(const string &query_tag);
+
+	//! Run a statement that does not return rows (DDL, DML) and return the number of affected
+	//! rows (-1 if the driver does not report it). Only idempotent statements are retried.
+	int64_t ExecuteUpdate(const string &query);
+	//! ID of the last query run on this session (LAST_QUERY_ID)
+	string GetLastQueryId();
+	//! ID of the query of the statement that CountStatement numbered `statement_number`, if it was
+	//! the last statement started on this client; empty if another one may have run since
+	string GetLastQueryIdOf(idx_t statement_number);
+	//! SYSTEM$LAST_CHANGE_COMMIT_TIME of each of the given qualified tables, which changes with every
+	//! committed DML or DDL on the table
+	vector<string> GetTableVersions(const vector<string> &table_names);
+	//! Snowflake's CURRENT_TIMESTAMP() as text with nanoseconds and time zone offset
+	string GetCurrentTimestamp();
+
+	//! Switch the session between auto-commit and an explicit transaction that is ended by
+	//! Commit or Rollback
+	void SetAutoCommit(bool enabled);
+	void Commit();
+	void Rollback();
+
+	//! Take the statement cached for `key` out of the cache (nullptr if there is none). The caller
+	//! owns it until it is handed back with CachePreparedStatement.
+	unique_ptr<SnowflakePreparedStatement> TakePreparedStatement(const string &key);
+	//! Keep a statement for the next TakePreparedStatement of `key`. Statements of an earlier
+	//! session are dropped; the least recently cached statement is evicted beyond
+	//! STATEMENT_CACHE_SIZE entries.
+	void CachePreparedStatement(const string &key, unique_ptr<SnowflakePreparedStatement> statement);
+	static constexpr idx_t STATEMENT_CACHE_SIZE = 32;
+
+	//! Throws an IOException describing the failed ADBC operation (no-op on ADBC_STATUS_OK)
+	static void CheckError(const AdbcStatusCode status, const std::string &operation, AdbcError *error);
 
 private:
 	SnowflakeConfig config;
-	AdbcDatabase database;
-	AdbcConnection connection;
-	bool connected = false;
+	shared_ptr<SnowflakeDatabase> database;
+	//! Replaced by Reconnect while other threads may be reading it, so it is only accessed under session_lock
+	shared_ptr<SnowflakeSession> session;
+	std::mutex session_lock;
+	std::atomic<bool> connected {false};
+	std::atomic<bool> discard_session {false};
+	//! Outstanding ConnectAsync, if any
+	std::shared_future<void> pending_connect;
+	std::mutex connect_lock;
+	std::mutex reconnect_lock;
+	//! Statements started on this client (GetSession, CountStatement)
+	std::atomic<idx_t> statement_count {0};
+	//! Prepared statements of this session, most recently cached first
+	std::list<std::pair<string, unique_ptr<SnowflakePreparedStatement>>> statement_cache;
+	std::mutex statement_cache_lock;
+
+	void InitializeConnection();
+	//! Drop the cached statements before their session is released
+	void ClearPreparedStatements();
 
-	vector<vector<string>> ExecuteAndGetStrings(ClientContext &context, const string &query,
-	                                            const vector<string> &expected_col_names);
+	int64_t ExecuteUpdateOnce(const string &query);
+	vector<vector<string>> ExecuteAndGetStrings(const string &query, const vector<string> &expected_col_names);
+	vector<vector<string>> ExecuteAndGetStringsOnce(const string &query, const vector<string> &expected_col_names);
 	unique_ptr<DataChunk> ExecuteAndGetChunk(ClientContext &context, const string &query,
 	                                         const vector<LogicalType> &expected_types,
 	                                         const vector<string> &expected_names);
-	void InitializeDatabase(const SnowflakeConfig &config);
-	void InitializeConnection();
-	void CheckError(const AdbcStatusCode status, const std::string &operation, AdbcError *error);
 };
 
 } // namespace snowflake
@@ -16,12 +16,25 @@ public:
 
 	shared_ptr<SnowflakeClient> GetConnection(const SnowflakeConfig &config);
 
+	//! Like GetConnection, but a new client authenticates on a background thread
+	//! and the call returns without waiting for it
+	shared_ptr<SnowflakeClient> GetConnectionAsync(const SnowflakeConfig &config);
+
 	void ReleaseConnection(const SnowflakeConfig &config);
 
+	//! Get the shared ADBC database for a credential set, initializing it on first use.
+	//! Databases outlive DETACH so that re-attaching reuses the loaded driver and idle sessions.
+	shared_ptr<SnowflakeDatabase> GetDatabase(const SnowflakeConfig &config);
+
+	//! Create a client with its own session that is not shared through GetConnection
+	shared_ptr<SnowflakeClient> CreateConnection(const SnowflakeConfig &config);
+
 private:
 	SnowflakeClientManager() = default;
 	std::unordered_map<SnowflakeConfig, shared_ptr<SnowflakeClient>, SnowflakeConfigHash> connections;
 	std::mutex connection_mutex;
+	std::unordered_map<SnowflakeConfig, shared_ptr<SnowflakeDatabase>, SnowflakeConfigHash> databases;
+	std::mutex database_mutex;
 };
 
 } // namespace snowflake
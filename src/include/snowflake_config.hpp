@@ -2,12 +2,31 @@
 #include <string>
 #include <functional>
 #include <cstdint>
+#include <map>
 
 namespace duckdb {
 namespace snowflake {
 
 enum class SnowflakeAuthType { PASSWORD, OAUTH, KEY_PAIR, EXT_BROWSER, OKTA, MFA };
 
+//! Result fetch tuning applied to each scan statement. These only affect how results
+//! are downloaded, so they are not part of the connection identity.
+struct SnowflakeFetchOptions {
+	//! Number of result chunks the driver downloads in parallel (0 = driver default)
+	int32_t prefetch_concurrency = 0;
+	//! Derive prefetch_concurrency from DuckDB's thread count
+	bool auto_prefetch_concurrency = false;
+	//! Number of record batches the driver buffers ahead of the scan (0 = driver default)
+	int32_t result_queue_size = 0;
+
+	//! Parse a prefetch_concurrency value: a positive integer or 'auto'
+	void SetPrefetchConcurrency(const std::string &value);
+	//! Parse a result_queue_size value: a positive integer
+	void SetResultQueueSize(const std::string &value);
+	//! Effective prefetch concurrency for a database running `thread_count` threads
+	int32_t GetPrefetchConcurrency(uint64_t thread_count) const;
+};
+
 struct SnowflakeConfig {
 	std::string account;
 	std::string warehouse;
@@ -23,6 +42,12 @@ struct SnowflakeConfig {
 	int32_t query_timeout = 300; // seconds
 	bool keep_alive = true;
 	bool use_high_precision = true; // When false, DECIMAL(p,0) converts to INT64
+	bool timestamp_ns = false;      // When true, TIMESTAMP_NTZ(7-9) reads as TIMESTAMP_NS instead of TIMESTAMP
+	int32_t max_retries = 3;        // retries for transient errors, 0 disables retrying
+	int32_t retry_backoff_ms = 250; // initial backoff, doubled on every retry
+	// Snowflake session parameters applied with ALTER SESSION to every new connection
+	std::map<std::string, std::string> session_parameters;
+	SnowflakeFetchOptions fetch_options;
 
 	static SnowflakeConfig ParseConnectionString(const std::string &connection_string);
 
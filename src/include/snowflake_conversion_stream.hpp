@@ -0,0 +1,61 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow.hpp"
+#include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! The Arrow layout of a result column that is rewritten while it is fetched
+enum class SnowflakeColumnLayout : uint8_t {
+	//! decimal128 (NUMBER with use_high_precision)
+	DECIMAL128,
+	//! Arrow timestamp in nanoseconds
+	TIMESTAMP_NS,
+	//! int64 scaled by 10^scale, flat or as the "epoch" field of a struct
+	SCALED_INT64,
+	//! struct(epoch int64 seconds, fraction int32 nanoseconds[, timezone int32])
+	TIMESTAMP_STRUCT
+};
+
+//! A result column whose batches are rewritten into the Arrow layout of target_type
+struct SnowflakeColumnConversion {
+	string column_name;
+	SnowflakeColumnLayout layout;
+	LogicalType target_type;
+	//! Scale of the source values: the NUMBER scale or the fractional second digits of a timestamp
+	uint8_t scale;
+};
+
+//! A STRUCT column assembled from flat result columns: a BOOLEAN column of the same name that is true
+//! for non-NULL rows, and one column per field
+struct SnowflakeStructAssembly {
+	string column_name;
+	vector<string> field_names;
+	//! Result column of each field, in field order
+	vector<string> field_columns;
+};
+
+//! Replace the ArrowTypes of the given columns (by column index) of a bound result schema
+void ReplaceArrowColumnTypes(ArrowTableSchema &arrow_table,
+                             const unordered_map<idx_t, shared_ptr<ArrowType>> &replacements);
+
+//! The value of `key` (compared ignoring case) in the metadata of an Arrow field, empty if not present
+string GetArrowFieldMetadata(const char *metadata, const string &key);
+
+//! Whether the value at `row` (including the array offset) of `array` is valid
+bool IsValidArrowRow(const ArrowArray &array, idx_t row);
+
+//! Turn `array` into a flat column with the validity buffer `validity` and the values `data`, which
+//! holds offset + length values like the original. The original array is released with it.
+void ReplaceColumnData(ArrowArray &array, const void *validity, unsafe_unique_array<data_t> data);
+
+//! Replace `stream` with a stream that takes ownership of it, converts the listed columns of every
+//! record batch and then assembles the listed STRUCT columns. Columns are matched by name, so the
+//! wrapper works on projected results too. A value that cannot be converted fails the stream.
+void WrapConversionStream(ArrowArrayStream &stream, vector<SnowflakeColumnConversion> conversions,
+                          vector<SnowflakeStructAssembly> assemblies = {});
+
+} // namespace snowflake
+} // namespace duckdb
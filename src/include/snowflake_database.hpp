@@ -0,0 +1,67 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "snowflake_config.hpp"
+
+#include "duckdb/common/adbc/adbc.h"
+
+#include <mutex>
+
+namespace duckdb {
+namespace snowflake {
+
+//! SnowflakeDatabase owns the ADBC database handle for one credential set.
+//!
+//! The driver is resolved once per process and each AdbcDatabase is initialized
+//! once per SnowflakeConfig. Connections handed out by AcquireConnection are
+//! reset and returned to an idle pool on release, so the next client for the
+//! same credentials reuses an already authenticated session instead of logging
+//! in again.
+class SnowflakeDatabase {
+public:
+	explicit SnowflakeDatabase(const SnowflakeConfig &config);
+	~SnowflakeDatabase();
+
+	SnowflakeDatabase(const SnowflakeDatabase &) = delete;
+	SnowflakeDatabase &operator=(const SnowflakeDatabase &) = delete;
+
+	//! Initialize connection, reusing an idle authenticated one when available
+	void AcquireConnection(AdbcConnection &connection);
+	//! Hand a connection back to the idle pool so its session can be reused. The session is reset first:
+	//! an open transaction (`in_transaction`) is rolled back and the configured session parameters are
+	//! applied again. A session that cannot be reset is closed instead.
+	void ReleaseConnection(AdbcConnection &connection, bool in_transaction);
+	//! Release a connection for good (e.g. after its session became unusable)
+	void DiscardConnection(AdbcConnection &connection);
+	//! Drop all idle connections, forcing the next acquire to log in again
+	void ClearIdleConnections();
+
+	AdbcDatabase *GetDatabase() {
+		return &database;
+	}
+	const SnowflakeConfig &GetConfig() const {
+		return config;
+	}
+
+	//! Locate the ADBC Snowflake driver. The search runs once per process and
+	//! the result is reused by every database created afterwards.
+	static const string &GetDriverPath();
+
+private:
+	//! Upper bound on idle connections kept per credential set
+	static constexpr idx_t MAX_IDLE_CONNECTIONS = 8;
+
+	SnowflakeConfig config;
+	AdbcDatabase database;
+	std::mutex pool_lock;
+	vector<AdbcConnection> idle_connections;
+
+	void InitializeDatabase();
+	//! Run ALTER SESSION for the configured session parameters on a new or released connection
+	void ApplySessionParameters(AdbcConnection &connection);
+	//! Bring a released session back to the state of a new one
+	void ResetSession(AdbcConnection &connection, bool in_transaction);
+};
+
+} // namespace snowflake
+} // namespace duckdb
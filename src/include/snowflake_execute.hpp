@@ -0,0 +1,75 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "snowflake_config.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+namespace snowflake {
+
+//! Outcome of a statement run by snowflake_execute
+struct SnowflakeStatementResult {
+	string query_id;
+	//! -1 if Snowflake does not report a row count for the statement
+	int64_t rows_affected = -1;
+};
+
+//! Run a statement of any kind (DDL, DML, COPY INTO, CALL, ...) on a session of its own. The session of a
+//! `user_statement` is closed afterwards instead of being returned to the idle pool.
+SnowflakeStatementResult RunSnowflakeStatement(const SnowflakeConfig &config, const string &sql,
+                                               bool user_statement = false);
+
+//! A statement submitted with snowflake_execute(..., async = true), run on a thread of its own
+struct SnowflakeJob {
+	//! Joined by the registry when the job is collected, forgotten or the registry is destroyed
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable finished_cv;
+	bool finished = false;
+	SnowflakeStatementResult result;
+	//! Set if the statement failed
+	ErrorData error;
+	std::chrono::steady_clock::time_point finished_at;
+};
+
+//! Statements submitted with snowflake_execute(..., async = true), running on background threads until
+//! snowflake_wait collects them. Finished jobs nobody waits for are forgotten after an hour, or sooner when
+//! the registry is full. The registry owns the threads: jobs still running when it is destroyed at process exit
+//! are waited for.
+class SnowflakeJobRegistry {
+public:
+	static SnowflakeJobRegistry &GetInstance();
+
+	//! Start running `sql` and return the ID of the job. Throws if too many jobs are running.
+	string Submit(const SnowflakeConfig &config, const string &sql);
+	//! Block until the job has finished and forget it. Rethrows the error of a failed statement.
+	SnowflakeStatementResult Wait(const string &job_id);
+
+private:
+	SnowflakeJobRegistry();
+	~SnowflakeJobRegistry();
+
+	//! Wait for the thread of a job to return
+	static void JoinJob(SnowflakeJob &job);
+
+	//! Forget finished jobs past their retention, or all finished jobs if the registry is full.
+	//! Called with `lock` held.
+	void ExpireJobs();
+
+	std::unordered_map<string, shared_ptr<SnowflakeJob>> jobs;
+	std::mutex lock;
+};
+
+} // namespace snowflake
+
+//! snowflake_execute(sql, profile[, async]): run a statement that need not return rows
+TableFunction GetSnowflakeExecuteFunction();
+//! snowflake_wait(job_id): wait for a statement submitted with async = true
+TableFunction GetSnowflakeWaitFunction();
+
+} // namespace duckdb
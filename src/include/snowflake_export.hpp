@@ -0,0 +1,11 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+//! snowflake_export(table, directory, profile[, partitions, partition_by, consistent]): split a Snowflake table
+//! into partitions, fetch them concurrently and write each to its own Parquet file in `directory`
+TableFunction GetSnowflakeExportFunction();
+
+} // namespace duckdb
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow.hpp"
+#include "duckdb/main/client_properties.hpp"
+#include "snowflake_client.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+namespace snowflake {
+
+//! Fully qualified table that ingested rows are appended to
+struct SnowflakeIngestTarget {
+	string database;
+	string schema;
+	string table;
+
+	string ToString() const {
+		return database + "." + schema + "." + table;
+	}
+};
+
+//! SnowflakeIngestWriter streams Arrow record batches into a Snowflake table
+//! through ADBC bulk ingest (AdbcStatementBindStream).
+//!
+//! The ingest statement runs on a background thread that pulls batches from a
+//! bounded queue, so the driver stages and uploads one batch while the caller
+//! builds the next. All batches written before Finish() are loaded by a single
+//! ingest statement on the writer's connection.
+class SnowflakeIngestWriter {
+public:
+	SnowflakeIngestWriter(shared_ptr<SnowflakeClient> connection, SnowflakeIngestTarget target,
+	                      vector<LogicalType> types, vector<string> names, ClientProperties properties);
+	~SnowflakeIngestWriter();
+
+	SnowflakeIngestWriter(const SnowflakeIngestWriter &) = delete;
+	SnowflakeIngestWriter &operator=(const SnowflakeIngestWriter &) = delete;
+
+	//! Queue a record batch for ingest, taking ownership of it. Blocks while the
+	//! queue is full and throws if the ingest statement already failed.
+	void Write(ArrowArray &batch);
+	//! Signal the end of the data, wait for the ingest to complete and return
+	//! the number of rows written
+	idx_t Finish();
+
+	const SnowflakeIngestTarget &GetTarget() const {
+		return target;
+	}
+
+private:
+	//! Batches buffered ahead of the driver
+	static constexpr idx_t MAX_QUEUED_BATCHES = 2;
+
+	shared_ptr<SnowflakeClient> connection;
+	SnowflakeIngestTarget target;
+	vector<LogicalType> types;
+	vector<string> names;
+	ClientProperties properties;
+
+	std::mutex lock;
+	std::condition_variable batch_available;
+	std::condition_variable space_available;
+	std::deque<ArrowArray> queue;
+	//! No more batches will be written
+	bool finished = false;
+	//! The writer is destroyed without Finish(); the stream reports an error so nothing is loaded
+	bool aborted = false;
+	//! The ingest statement returned (successfully or not)
+	bool done = false;
+	string error_message;
+	idx_t rows_written = 0;
+	std::thread ingest_thread;
+
+	void RunIngest();
+
+	static int GetSchema(ArrowArrayStream *stream, ArrowSchema *out);
+	static int GetNext(ArrowArrayStream *stream, ArrowArray *out);
+	static const char *GetLastError(ArrowArrayStream *stream);
+	static void Release(ArrowArrayStream *stream);
+};
+
+} // namespace snowflake
+} // namespace duckdb
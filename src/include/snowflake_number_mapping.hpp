@@ -0,0 +1,62 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "snowflake_conversion_stream.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! How a Snowflake NUMBER(p, s) column that the driver returns as decimal128 is read
+enum class SnowflakeNumberMapping : uint8_t {
+	//! DECIMAL(p, s) as declared (the default)
+	DECIMAL,
+	//! DOUBLE, converted from the scaled integer
+	DOUBLE,
+	//! The narrowest type that holds the values: an integer type for scale 0, otherwise
+	//! DECIMAL(4/9/18, s). Columns declared wider than 18 digits are sized by their MIN/MAX.
+	NARROW,
+	//! HUGEINT for scale 0 (the decimal128 bytes are used as they are), DECIMAL(p, s) otherwise
+	HUGEINT
+};
+
+//! Parse 'decimal', 'double', 'narrow' or 'hugeint'; `option` names the setting in the error
+SnowflakeNumberMapping ParseNumberMapping(const string &option, const string &value);
+string NumberMappingToString(SnowflakeNumberMapping mapping);
+
+//! The NUMBER mapping of an attached database: a default plus overrides for single columns
+struct SnowflakeNumberPolicy {
+	SnowflakeNumberMapping default_mapping = SnowflakeNumberMapping::DECIMAL;
+	//! Keyed by "COLUMN" (any table) or "TABLE.COLUMN"
+	case_insensitive_map_t<SnowflakeNumberMapping> column_mappings;
+
+	//! Parse a MAP {'[table.]column': 'mapping'} given as number_column_mapping
+	void ParseColumnMappings(const Value &value);
+	SnowflakeNumberMapping GetMapping(const string &table_name, const string &column_name) const;
+	//! Whether any column may be read as NARROW, which needs the value ranges of the table
+	bool UsesNarrow() const;
+};
+
+//! The DuckDB type a NUMBER column with `width` significant digits and `scale` is read as
+LogicalType GetNumberType(SnowflakeNumberMapping mapping, uint8_t width, uint8_t scale);
+
+//! Number of digits of the unscaled value of a NUMBER printed as text (e.g. "-1234.50" with scale 2
+//! has 6); 0 for an empty (NULL) value
+uint8_t GetUnscaledWidth(const string &value, uint8_t scale);
+
+//! Whether `type` is a column the driver delivers as Arrow decimal128
+bool IsDecimal128Column(const ArrowType &type);
+
+//! Replace the DuckDB types of the decimal128 columns listed in `target_types` (by column index).
+//! Returns the columns whose batches have to be converted by WrapConversionStream.
+vector<SnowflakeColumnConversion> ApplyNumberTypes(ArrowTableSchema &arrow_table,
+                                                   const unordered_map<idx_t, LogicalType> &target_types);
+
+//! Rewrite a decimal128 column into the Arrow layout of conversion.target_type. Throws if a value
+//! does not fit the target type.
+void ConvertDecimal128Column(ArrowArray &array, const SnowflakeColumnConversion &conversion);
+
+} // namespace snowflake
+} // namespace duckdb
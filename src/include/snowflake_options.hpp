@@ -2,11 +2,40 @@
 
 #include "duckdb/common/common.hpp"
 #include "duckdb/common/enums/access_mode.hpp"
+#include "snowflake_config.hpp"
+#include "snowflake_number_mapping.hpp"
+#include "snowflake_variant_shredding.hpp"
 #include <map>
 
 namespace duckdb {
 namespace snowflake {
 
+//! Point in time the scans of attached tables read (snapshot option)
+enum class SnowflakeSnapshotMode : uint8_t {
+	//! Every scan reads the current data
+	NONE,
+	//! The scans of a DuckDB transaction read the data as of its first scan
+	TRANSACTION,
+	//! All scans read the data as of snapshot_timestamp
+	TIMESTAMP
+};
+
+//! Where scans unload large tables to (unload_stage, unload_location, unload_threshold)
+struct SnowflakeUnloadOptions {
+	//! Stage the files are unloaded to, e.g. @my_stage/duckdb (empty: scans never unload)
+	string stage;
+	//! Path or URL DuckDB reads the files of the stage from, e.g. the S3 URL of an external stage
+	//! (empty: the files are downloaded to a local temporary directory with GET)
+	string location;
+	idx_t threshold_bytes = DEFAULT_THRESHOLD_BYTES;
+
+	static constexpr idx_t DEFAULT_THRESHOLD_BYTES = idx_t(10) * 1024 * 1024 * 1024;
+
+	bool IsEnabled() const {
+		return !stage.empty();
+	}
+};
+
 struct SnowflakeOptions {
 	//! How to handle database access (READ_ONLY or READ_WRITE)
 	AccessMode access_mode = AccessMode::READ_WRITE;
@@ -17,6 +46,39 @@ struct SnowflakeOptions {
 	//! users must explicitly opt-in.
 	bool enable_pushdown = false;
 
+	//! Authenticate on a background thread so ATTACH returns immediately.
+	//! The first query against the catalog waits for the login if needed.
+	bool async_connect = false;
+
+	//! Schemas whose table lists are loaded in the background right after
+	//! ATTACH ("*" loads every schema). Empty disables the warm-up.
+	vector<string> preload_schemas;
+
+	//! Rows per Arrow record batch handed to the ingest stream by INSERT.
+	//! Larger batches mean fewer, larger files staged by the driver.
+	idx_t insert_batch_size = DEFAULT_INSERT_BATCH_SIZE;
+
+	static constexpr idx_t DEFAULT_INSERT_BATCH_SIZE = 131072;
+
+	//! DuckDB types of the NUMBER columns of attached tables (number_mapping and
+	//! number_column_mapping). Only applies to columns fetched as decimal128, i.e.
+	//! with use_high_precision enabled.
+	SnowflakeNumberPolicy number_policy;
+
+	//! VARIANT / OBJECT columns read as STRUCTs of their top-level keys (variant_shredding and
+	//! variant_sample_size), instead of as JSON text
+	SnowflakeVariantShredding variant_shredding;
+
+	//! Snapshot the scans read through Snowflake time travel (snapshot: 'none', 'transaction' or a
+	//! timestamp). Scans of a transaction that has written read the current data of its session.
+	SnowflakeSnapshotMode snapshot_mode = SnowflakeSnapshotMode::NONE;
+	//! Timestamp with time zone offset, for SnowflakeSnapshotMode::TIMESTAMP
+	string snapshot_timestamp;
+
+	//! Scans of tables of at least unload_threshold bytes unload the table to Parquet files with
+	//! COPY INTO unload_stage and read the files in parallel, instead of streaming one query result
+	SnowflakeUnloadOptions unload;
+
 	//! Whether to treat table and column names from Snowflake as case-sensitive.
 	//! If false (default), names will be converted to lowercase to match DuckDB's
 	//! typical behavior.
@@ -26,8 +88,9 @@ struct SnowflakeOptions {
 	//! A value of 0 disables metadata caching.
 	// uint32_t metadata_cache_ttl_seconds = 3600;
 
-	//! Custom parameters to set on the Snowflake session upon connection.
-	// std::map<string, string> session_parameters;
+	//! Result fetch tuning for scans of attached tables. Session parameters are
+	//! part of SnowflakeConfig since they apply to the connection itself.
+	SnowflakeFetchOptions fetch_options;
 };
 
 } // namespace snowflake
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/parser/parsed_expression.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! Parse the path argument of DuckDB's json_extract functions into the object keys (VARCHAR) and
+//! array indexes (BIGINT) it selects: '$.a.b[0]', '$."a b"', a plain key 'a' or an integer index.
+//! Returns false for paths that select more than one value or that Snowflake cannot express
+//! (wildcards, indexes from the end, JSON pointers).
+bool ParseJSONPath(const Value &path, vector<Value> &steps);
+
+//! The Snowflake expression for json_extract (as_text = false: JSON text of the value) or
+//! json_extract_string (as_text = true: strings unquoted, JSON null as NULL) at `steps` of a
+//! VARIANT, OBJECT or ARRAY column
+unique_ptr<ParsedExpression> BuildPathExpression(const string &column_name, const vector<Value> &steps,
+                                                 bool as_text);
+
+//! Optimizer pass that fetches json_extract / json_extract_string (->, ->>) of a semi-structured
+//! column of an attached table as an extra scan column computed by Snowflake, so only the extracted
+//! values are transferred. A column that is no longer read otherwise is fetched as NULL.
+OptimizerExtension GetSnowflakePathPushdownExtension();
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+//! snowflake_query_batch(queries, profile[, max_concurrency]): run a list of queries concurrently on
+//! pooled sessions and return their rows as each query completes, tagged with the query's list position
+TableFunction GetSnowflakeQueryBatchFunction();
+
+} // namespace duckdb
@@ -1,14 +1,50 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
 #include "duckdb/common/types/value.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/storage/table/scan_state.hpp"
 #include "duckdb/parser/statement/select_statement.hpp"
 #include "duckdb/parser/parsed_expression.hpp"
+#include "duckdb/planner/expression.hpp"
+
+#include <functional>
 
 namespace duckdb {
 namespace snowflake {
 
+//! A result column that is not fetched as the table column of the same name, but as Snowflake
+//! expressions (the fields of a shredded VARIANT column)
+struct SnowflakeColumnExpansion {
+	//! Aliased select list items fetched in place of the column
+	vector<unique_ptr<ParsedExpression>> select_list;
+	//! Expression of each STRUCT field of the column, for filters on a field
+	case_insensitive_map_t<unique_ptr<ParsedExpression>> fields;
+
+	SnowflakeColumnExpansion Copy() const;
+};
+
+//! Expanded columns by name
+using column_expansion_map_t = case_insensitive_map_t<SnowflakeColumnExpansion>;
+
+//! A point in the history of a table that a scan reads (Snowflake time travel), rendered after the
+//! table name as AT(<unit> => <value>)
+struct SnowflakeTimeTravel {
+	//! TIMESTAMP, OFFSET or STATEMENT (empty: the current data)
+	string unit;
+	//! Timestamp text with time zone offset, offset in seconds (BIGINT) or query ID
+	Value value;
+
+	bool IsSet() const {
+		return !unit.empty();
+	}
+	//! The time travel of a DuckDB AT clause; throws for units Snowflake does not support
+	static SnowflakeTimeTravel FromAtClause(const string &unit, const Value &value);
+	static SnowflakeTimeTravel AtTimestamp(const string &timestamp);
+	string ToString() const;
+};
+
 //! SnowflakeQueryBuilder: AST-based query construction for filter and
 //! projection pushdown
 //!
@@ -38,22 +74,53 @@ public:
 	//!   - projection_columns: Columns to select (empty = SELECT *)
 	//!   - filter_set: DuckDB's pre-parsed filters
 	//!   - column_names: Maps column indices to names
+	//!   - expansions: Columns projected and filtered as expressions rather than by name
+	//!   - time_travel: Point in the history of the table to read
 	//! Output: SQL string serialized from AST
 	static string BuildQuery(const string &table_name, const vector<string> &projection_columns,
-	                         TableFilterSet *filter_set, const vector<string> &column_names);
+	                         TableFilterSet *filter_set, const vector<string> &column_names,
+	                         const column_expansion_map_t *expansions = nullptr,
+	                         const SnowflakeTimeTravel *time_travel = nullptr);
 
-private:
 	//! Build WHERE clause expression from DuckDB filters
 	//! Returns nullptr if no filters
 	static unique_ptr<ParsedExpression> BuildWhereExpression(TableFilterSet *filter_set,
-	                                                         const vector<string> &column_names);
+	                                                         const vector<string> &column_names,
+	                                                         const column_expansion_map_t *expansions = nullptr);
+
+	//! Resolves the input column at a BoundReferenceExpression index to a Snowflake expression
+	//! (nullptr if the column has no Snowflake equivalent)
+	using column_resolver_t = std::function<unique_ptr<ParsedExpression>(idx_t)>;
+
+	//! Translate a bound DuckDB expression (comparisons, AND/OR/NOT, IN, BETWEEN, CASE, casts,
+	//! arithmetic and a few string functions over columns and constants) into an expression
+	//! for Snowflake SQL. Returns nullptr if any part of it has no Snowflake translation.
+	static unique_ptr<ParsedExpression> TransformExpression(const Expression &expr,
+	                                                        const column_resolver_t &column_resolver);
 
-	//! Transform a single DuckDB TableFilter to ParsedExpression
-	static unique_ptr<ParsedExpression> TransformFilter(const TableFilter &filter, const string &column_name);
+	//! Name Snowflake stores for a DuckDB identifier. Plain names are upper-cased the
+	//! way Snowflake stores unquoted names, so a table created as `events` can be
+	//! referenced unquoted from Snowflake SQL as well; other names are kept as-is.
+	static string NormalizeIdentifier(const string &name);
+	//! NormalizeIdentifier, written as a quoted Snowflake identifier
+	static string WriteIdentifier(const string &name);
+
+	//! Write a value of an ingest type (GetSnowflakeIngestType) as a Snowflake literal
+	static string WriteLiteral(const Value &value);
+	//! Render rows as the row lists of VALUES clauses - "(1, 'a'), (2, 'b')" - each within
+	//! Snowflake's limits on rows per VALUES clause and on statement length
+	static vector<string> BuildValuesLists(ColumnDataCollection &rows);
+
+private:
+	//! Transform a single DuckDB TableFilter on `column` to ParsedExpression; `expansion` resolves
+	//! filters on STRUCT fields of an expanded column
+	static unique_ptr<ParsedExpression> TransformFilter(const TableFilter &filter, const ParsedExpression &column,
+	                                                    const SnowflakeColumnExpansion *expansion);
 
 	//! Build projection list (SELECT clause expressions)
 	//! Returns empty vector for SELECT *
-	static vector<unique_ptr<ParsedExpression>> BuildProjectionList(const vector<string> &projection_columns);
+	static vector<unique_ptr<ParsedExpression>> BuildProjectionList(const vector<string> &projection_columns,
+	                                                                const column_expansion_map_t *expansions);
 };
 
 } // namespace snowflake
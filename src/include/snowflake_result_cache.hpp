@@ -0,0 +1,59 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "snowflake_config.hpp"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+
+namespace duckdb {
+namespace snowflake {
+
+//! The result Snowflake persisted for a query, with the versions of the tables the query read when it ran
+struct SnowflakePersistedResult {
+	string query_id;
+	//! SnowflakeClient::GetTableVersions of the tables of the query
+	vector<string> table_versions;
+};
+
+//! Process-wide LRU cache of the query IDs of scan queries by connection and final query text, so an
+//! identical scan of unchanged tables reads the persisted result with RESULT_SCAN instead of running
+//! on a warehouse again (snowflake_reuse_results). Snowflake keeps results for 24 hours; entries expire
+//! an hour earlier.
+class SnowflakeResultCache {
+public:
+	static SnowflakeResultCache &GetInstance();
+
+	//! The result recorded for `query`, nullptr if there is none or it has expired
+	shared_ptr<const SnowflakePersistedResult> Get(const SnowflakeConfig &config, const string &query);
+	//! Record the result of `query`, replacing an earlier one
+	void Put(const SnowflakeConfig &config, const string &query, shared_ptr<const SnowflakePersistedResult> result);
+	void Invalidate(const SnowflakeConfig &config, const string &query);
+
+	static constexpr idx_t CAPACITY = 1024;
+	static constexpr idx_t RETENTION_SECONDS = 23 * 60 * 60;
+
+private:
+	SnowflakeResultCache() = default;
+
+	struct Entry {
+		SnowflakeConfig config;
+		string query;
+		shared_ptr<const SnowflakePersistedResult> result;
+		std::chrono::steady_clock::time_point recorded_at;
+	};
+
+	//! Position of an entry in `entries` for a (config, query) key
+	std::list<Entry>::iterator Find(const SnowflakeConfig &config, const string &query);
+	void Erase(std::list<Entry>::iterator entry);
+
+	//! Most recently used first
+	std::list<Entry> entries;
+	//! Entries by hash of their config and query
+	std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+	std::mutex lock;
+};
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow.hpp"
+#include "snowflake_client.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! Statement option used to tag scan queries so their query ID can be found again
+static constexpr const char *SNOWFLAKE_QUERY_TAG_OPTION = "adbc.snowflake.statement.query_tag";
+
+//! Generate a unique query tag for a scan query: `duckdb_scan_<uuid>`, after the QUERY_TAG of the session
+//! parameters if the user set one
+string GenerateScanQueryTag(const SnowflakeConfig &config);
+
+//! Rows after which scan result streams fail once for testing (snowflake_inject_stream_failure, 0: never). Always
+//! 0 unless the extension was built with SNOWFLAKE_TEST_HOOKS.
+idx_t GetInjectedStreamFailure(ClientContext &context);
+
+//! Replace `stream` with a stream that takes ownership of it and counts the rows handed out.
+//! If fetching a batch fails midway, the persisted result of the query tagged `query_tag` is
+//! re-opened with RESULT_SCAN and the rows already delivered are skipped, so the warehouse
+//! query does not have to run again. Gives up after config.max_retries attempts.
+//! For testing, a non-zero `inject_failure_after` makes the stream fail once after that many rows.
+void WrapResumableStream(ArrowArrayStream &stream, shared_ptr<SnowflakeClient> connection, const string &query_tag,
+                         idx_t inject_failure_after = 0);
+
+} // namespace snowflake
+} // namespace duckdb
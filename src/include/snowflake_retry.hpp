@@ -0,0 +1,67 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "snowflake_config.hpp"
+#include "snowflake_debug.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace duckdb {
+namespace snowflake {
+
+//! How a failed Snowflake call should be handled
+enum class SnowflakeErrorClass : uint8_t {
+	//! Connection resets, timeouts, DNS hiccups, 5xx responses - retry after a backoff
+	TRANSIENT,
+	//! The service asked us to slow down - retry after a backoff
+	THROTTLED,
+	//! Session or auth token expired - re-establish the session, then retry
+	SESSION_EXPIRED,
+	//! SQL errors, permissions, interrupts - retrying would fail again
+	PERMANENT
+};
+
+//! Classify a failure by exception type and the error text returned by the driver
+SnowflakeErrorClass ClassifySnowflakeError(const ErrorData &error);
+
+//! Delay before retry number `attempt` (0-based): exponential growth from
+//! config.retry_backoff_ms, randomized within the upper half of the window and
+//! capped at MAX_RETRY_BACKOFF_MS
+idx_t SnowflakeRetryBackoffMs(const SnowflakeConfig &config, idx_t attempt);
+
+//! Whether running the statement twice is harmless (SELECT, SHOW, DESCRIBE, ..., or a WITH clause followed by
+//! a SELECT)
+bool IsIdempotentQuery(const string &query);
+
+static constexpr idx_t MAX_RETRY_BACKOFF_MS = 30000;
+
+//! Run `func` and retry it on transient, throttling and session-expired errors
+//! up to config.max_retries times. `on_retry(error_class)` runs before every new
+//! attempt so the caller can reset statements or reconnect the session.
+template <class FUNC, class ON_RETRY>
+auto RunWithRetry(const SnowflakeConfig &config, const string &operation, FUNC &&func, ON_RETRY &&on_retry)
+    -> decltype(func()) {
+	for (idx_t attempt = 0;; attempt++) {
+		try {
+			return func();
+		} catch (std::exception &ex) {
+			ErrorData error(ex);
+			auto error_class = ClassifySnowflakeError(error);
+			if (error_class == SnowflakeErrorClass::PERMANENT || config.max_retries <= 0 ||
+			    attempt >= static_cast<idx_t>(config.max_retries)) {
+				throw;
+			}
+			auto backoff_ms = SnowflakeRetryBackoffMs(config, attempt);
+			LOG_WARN("%s failed, retrying in %llu ms (attempt %llu of %d): %s\n", operation.c_str(),
+			         static_cast<unsigned long long>(backoff_ms), static_cast<unsigned long long>(attempt + 1),
+			         config.max_retries, error.RawMessage().c_str());
+			std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+			on_retry(error_class);
+		}
+	}
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "snowflake_arrow_utils.hpp"
+
+#include <future>
+#include <mutex>
+
+namespace duckdb {
+namespace snowflake {
+
+struct SnowflakeScanSpool;
+
+//! The Snowflake scans of one plan. When the first of them starts, the queries of the others are
+//! submitted on pooled sessions of their own, so that Snowflake compiles and runs them while DuckDB
+//! works through the pipelines before theirs (prefetch). Scans that run the same query on the same
+//! connection read one result, fetched once and kept until all of them have read it (share).
+class SnowflakeScanGroup {
+public:
+	SnowflakeScanGroup(bool prefetch, bool share) : prefetch(prefetch), share(share) {
+	}
+	~SnowflakeScanGroup();
+
+	//! Add the scan of `factory`, which reads the columns `projection` and runs `query`
+	void AddScan(const SnowflakeArrowStreamFactory &factory, vector<string> projection, string query);
+	//! Whether any scan of the group is submitted ahead of time or shared
+	bool HasWork() const;
+	//! Whether the scan of `factory` is in a group whose queries are submitted ahead of time
+	bool IsPrefetched(const SnowflakeArrowStreamFactory &factory) const;
+	//! Whether the scan of `factory` reads a result that other scans of the plan read as well
+	bool IsShared(const SnowflakeArrowStreamFactory &factory) const;
+
+	//! Called when the scan of `factory` starts. If it is the first scan of the plan to run, the
+	//! queries of the others are submitted. Returns the result of the query submitted for this scan,
+	//! or nullptr if there is none and the scan has to run its query itself.
+	unique_ptr<ArrowArrayStreamWrapper> StartScan(const SnowflakeArrowStreamFactory &factory,
+	                                              const vector<string> &projection);
+
+private:
+	struct ScanMember {
+		//! Identifies the scan; only dereferenced while the plan runs
+		const SnowflakeArrowStreamFactory *factory;
+		vector<string> projection;
+		string query;
+		//! The first member running the same query, whose result this one reads (itself if none)
+		idx_t source;
+		//! Whether other members read the result of this one
+		bool shared = false;
+		bool started = false;
+		std::future<unique_ptr<ArrowArrayStreamWrapper>> prefetched;
+		//! The result of a shared query, once the first of its scans has started
+		shared_ptr<SnowflakeScanSpool> spool;
+	};
+
+	//! The member for the scan of `factory`, or nullptr. The members do not change once the plan is
+	//! optimized, so this needs no lock.
+	const ScanMember *FindMember(const SnowflakeArrowStreamFactory &factory) const;
+
+	bool prefetch;
+	bool share;
+	std::mutex lock;
+	vector<ScanMember> members;
+	//! Submitted queries that no scan took; waited for when the group is destroyed
+	vector<std::future<unique_ptr<ArrowArrayStreamWrapper>>> abandoned;
+};
+
+//! Optimizer pass that groups the Snowflake scans of a plan with more than one of them
+//! (snowflake_prefetch_scans, snowflake_share_scans)
+OptimizerExtension GetSnowflakeScanPrefetchExtension();
+
+} // namespace snowflake
+} // namespace duckdb
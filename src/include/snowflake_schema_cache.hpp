@@ -0,0 +1,58 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow_wrapper.hpp"
+#include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "snowflake_config.hpp"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+
+namespace duckdb {
+namespace snowflake {
+
+//! Result schema of a query as bound by snowflake_query, before the scan's type adjustments
+struct SnowflakeCachedSchema {
+	shared_ptr<ArrowSchemaWrapper> schema;
+	ArrowTableSchema arrow_table;
+};
+
+//! Process-wide LRU cache of the result schemas of snowflake_query by connection and query text, so
+//! binding a query again skips the ExecuteSchema round trip. Entries expire after a TTL
+//! (snowflake_schema_cache_ttl) and are dropped when a scan finds that the result schema changed.
+class SnowflakeSchemaCache {
+public:
+	static SnowflakeSchemaCache &GetInstance();
+
+	//! The schema of `query` cached within the last `ttl_seconds`, nullptr if there is none
+	shared_ptr<const SnowflakeCachedSchema> Get(const SnowflakeConfig &config, const string &query,
+	                                            idx_t ttl_seconds);
+	void Put(const SnowflakeConfig &config, const string &query, shared_ptr<const SnowflakeCachedSchema> schema);
+	void Invalidate(const SnowflakeConfig &config, const string &query);
+
+	static constexpr idx_t CAPACITY = 256;
+	static constexpr idx_t DEFAULT_TTL_SECONDS = 300;
+
+private:
+	SnowflakeSchemaCache() = default;
+
+	struct Entry {
+		SnowflakeConfig config;
+		string query;
+		shared_ptr<const SnowflakeCachedSchema> schema;
+		std::chrono::steady_clock::time_point cached_at;
+	};
+
+	//! Position of an entry in `entries` for a (config, query) key
+	std::list<Entry>::iterator Find(const SnowflakeConfig &config, const string &query);
+
+	//! Most recently used first
+	std::list<Entry> entries;
+	//! Entries by hash of their config and query
+	std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+	std::mutex lock;
+};
+
+} // namespace snowflake
+} // namespace duckdb
@@ -4,6 +4,8 @@
 #include "duckdb/main/secret/secret.hpp"
 #include "duckdb/main/secret/secret_manager.hpp"
 
+#include <map>
+
 namespace duckdb {
 
 //! Custom Snowflake secret that extends KeyValueSecret
@@ -35,6 +37,16 @@ public:
 	string GetPrivateKey() const;
 	string GetPrivateKeyPassphrase() const;
 
+	//! Get connection behaviour fields (empty when not set)
+	string GetMaxRetries() const;
+	string GetRetryBackoffMs() const;
+	string GetPrefetchConcurrency() const;
+	string GetResultQueueSize() const;
+	//! Whether TIMESTAMP_NTZ(7-9) columns read as TIMESTAMP_NS (TIMESTAMP_NS BOOLEAN)
+	bool GetTimestampNs() const;
+	//! Snowflake session parameters (SESSION_PARAMETERS MAP)
+	std::map<string, string> GetSessionParameters() const;
+
 	//! Validate that all required fields are present
 	void Validate() const;
 
@@ -18,6 +18,9 @@ public:
 	// Retrieve Snowflake config from a secret
 	static snowflake::SnowflakeConfig GetCredentials(ClientContext &context, const std::string &profile_name);
 
+	// Add session parameters given as a MAP(VARCHAR, VARCHAR) or STRUCT value
+	static void ParseSessionParameters(const Value &value, std::map<std::string, std::string> &session_parameters);
+
 	// Delete a Snowflake credentials secret
 	static bool DeleteCredentials(ClientContext &context, const std::string &profile_name);
 
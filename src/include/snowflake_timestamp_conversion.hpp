@@ -0,0 +1,22 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/arrow/arrow.hpp"
+#include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "snowflake_conversion_stream.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! Bind the TIMESTAMP_NTZ / _LTZ / _TZ columns of a result schema, recognized from the Snowflake
+//! field metadata (or a time zone on an Arrow timestamp), to TIMESTAMP and TIMESTAMP_TZ. With
+//! `timestamp_ns`, NTZ columns with a scale above 6 are bound to TIMESTAMP_NS instead. Returns the
+//! columns whose batches have to be converted.
+vector<SnowflakeColumnConversion> ApplyTimestampTypes(const ArrowSchema &schema, ArrowTableSchema &arrow_table,
+                                                      bool timestamp_ns);
+
+//! Rewrite a timestamp column into int64 microseconds (nanoseconds for TIMESTAMP_NS) in one pass
+void ConvertTimestampColumn(ArrowArray &array, const SnowflakeColumnConversion &conversion);
+
+} // namespace snowflake
+} // namespace duckdb
@@ -3,20 +3,83 @@
 #include "duckdb/transaction/transaction_manager.hpp"
 #include "duckdb/transaction/transaction.hpp"
 #include "duckdb/storage/storage_extension.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "snowflake_client.hpp"
+#include "snowflake_ingest.hpp"
 #include <mutex>
 
 namespace duckdb {
 namespace snowflake {
 
+class SnowflakeCatalog;
+
+//! SnowflakeTransaction maps an explicit DuckDB transaction (BEGIN ... COMMIT) onto a
+//! Snowflake transaction. The first write pins a session from the pool and turns off its
+//! auto-commit; all writes of the transaction, and scans that follow them, run on that
+//! session until COMMIT or ROLLBACK. Inserts are buffered and sent as multi-row INSERT
+//! statements, so many small writes cost a few round trips instead of one load each.
+//!
+//! Auto-commit transactions (a single statement outside BEGIN) do not pin anything; their
+//! writes use sessions of their own and commit as soon as the statement completes.
 class SnowflakeTransaction : public Transaction {
 public:
-	SnowflakeTransaction(TransactionManager &manager, ClientContext &context);
-	~SnowflakeTransaction() override = default;
+	SnowflakeTransaction(TransactionManager &manager, ClientContext &context, SnowflakeCatalog &catalog);
+	~SnowflakeTransaction() override;
+
+	static SnowflakeTransaction &Get(ClientContext &context, Catalog &catalog);
+
+	//! Whether this transaction was started with BEGIN
+	bool IsExplicit() const {
+		return is_explicit;
+	}
+	//! Whether the transaction has written, i.e. a Snowflake transaction is open or inserts are buffered
+	bool HasRemoteTransaction();
+
+	//! The pinned session of an explicit transaction, starting the Snowflake transaction on
+	//! first use; nullptr for auto-commit transactions. Buffered inserts are flushed first so
+	//! every statement sees the writes that preceded it.
+	shared_ptr<SnowflakeClient> GetConnection();
+
+	//! The Snowflake time the scans of this transaction read with snapshot 'transaction', taken
+	//! when it is first asked for
+	string GetSnapshotTimestamp();
+
+	//! Buffer rows for an INSERT into target. Rows are sent at COMMIT, before the next statement
+	//! that uses the session, or once flush_threshold rows are pending for the table.
+	void BufferInsert(const SnowflakeIngestTarget &target, const vector<string> &column_names, DataChunk &chunk);
+
+	//! Flush buffered inserts and commit the Snowflake transaction, if one is open
+	void Commit();
+	//! Discard buffered inserts and roll back the Snowflake transaction, if one is open
+	void Rollback();
+
+private:
+	struct PendingInsert {
+		SnowflakeIngestTarget target;
+		vector<string> column_names;
+		unique_ptr<ColumnDataCollection> rows;
+	};
+
+	SnowflakeConfig config;
+	bool is_explicit;
+	//! Pending rows of one table that trigger a flush (the catalog's insert_batch_size)
+	idx_t flush_threshold;
+
+	mutex lock;
+	shared_ptr<SnowflakeClient> connection;
+	vector<unique_ptr<PendingInsert>> pending_inserts;
+	string snapshot_timestamp;
+
+	shared_ptr<SnowflakeClient> GetConnectionInternal();
+	void FlushInternal();
+	void FlushInsert(PendingInsert &pending);
+	//! Return the pinned session to the pool with auto-commit restored
+	void ReleaseConnection();
 };
 
 class SnowflakeTransactionManager : public TransactionManager {
 public:
-	explicit SnowflakeTransactionManager(AttachedDatabase &db);
+	SnowflakeTransactionManager(AttachedDatabase &db, SnowflakeCatalog &catalog);
 	~SnowflakeTransactionManager() override = default;
 
 	Transaction &StartTransaction(ClientContext &context) override;
@@ -25,6 +88,7 @@ public:
 	void Checkpoint(ClientContext &context, bool force = false) override;
 
 private:
+	SnowflakeCatalog &catalog;
 	mutex transaction_lock;
 	reference_map_t<Transaction, unique_ptr<Transaction>> transactions;
 };
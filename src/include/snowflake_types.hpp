@@ -4,8 +4,19 @@
 
 namespace duckdb {
 namespace snowflake {
-LogicalType SnowflakeTypeToLogicalType(const std::string &snowflake_type_str);
-// string LogicalTypeToSnowflakeType(const LogicalType& type);
-LogicalType ConvertNumber(uint8_t precision, uint8_t scale);
+//! DuckDB type of a Snowflake column type such as NUMBER(38,2) or TIMESTAMP_NTZ(9).
+//! Matches the type the ADBC driver delivers in the Arrow stream, so binding from
+//! metadata and binding from a result schema agree. use_high_precision mirrors the
+//! driver option of the same name, timestamp_ns the connection option.
+LogicalType SnowflakeTypeToLogicalType(const std::string &snowflake_type_str, bool use_high_precision = true,
+                                       bool timestamp_ns = false);
+//! Snowflake column type used for a DuckDB type in CREATE TABLE. Matches the
+//! values produced by GetSnowflakeIngestType, so created tables can be loaded
+//! through ingest.
+string LogicalTypeToSnowflakeType(const LogicalType &type);
+//! Type a DuckDB column is cast to before it is written to Snowflake through
+//! Arrow ingest. Types without a Snowflake counterpart are widened (unsigned and
+//! 128-bit integers) or rendered as text.
+LogicalType GetSnowflakeIngestType(const LogicalType &type);
 } // namespace snowflake
 } // namespace duckdb
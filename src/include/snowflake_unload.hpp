@@ -0,0 +1,30 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "snowflake_config.hpp"
+#include "snowflake_options.hpp"
+#include "snowflake_query_builder.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! A scan of an attached table that unloads it to Parquet files on a stage (COPY INTO @stage) and reads
+//! the files in parallel with DuckDB's Parquet reader, one file per thread at a time. The files are
+//! removed from the stage, and from the local disk if they were downloaded, when the scan is done.
+struct SnowflakeUnloadBindData : public TableFunctionData {
+	SnowflakeConfig config;
+	SnowflakeUnloadOptions options;
+	//! Qualified table the scan reads
+	string table_name;
+	SnowflakeTimeTravel time_travel;
+	//! Columns of the table and the DuckDB types the scan returns them as
+	vector<string> names;
+	vector<LogicalType> types;
+};
+
+//! The scan function of unloading scans, with projection pushdown. With `enable_pushdown` the filters of
+//! the scan are part of the unloaded query, otherwise DuckDB applies them to the rows read from the files.
+TableFunction GetSnowflakeUnloadScanFunction(bool enable_pushdown);
+
+} // namespace snowflake
+} // namespace duckdb
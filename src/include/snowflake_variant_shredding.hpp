@@ -0,0 +1,67 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "snowflake_conversion_stream.hpp"
+#include "snowflake_query_builder.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! Field of a shredded column holding the JSON text of rows that do not fit the inferred fields
+static constexpr const char *VARIANT_OUTLIER_FIELD = "__json";
+
+//! DuckDB type of a top-level key of a shredded VARIANT column, inferred from a sample
+enum class SnowflakeVariantFieldType : uint8_t {
+	BIGINT,
+	DOUBLE,
+	BOOLEAN,
+	VARCHAR,
+	//! Objects, arrays and keys seen with mixed types, kept as JSON text
+	JSON
+};
+
+struct SnowflakeVariantField {
+	string name;
+	SnowflakeVariantFieldType type;
+};
+
+//! The VARIANT / OBJECT columns of an attached database that are read as STRUCTs
+//! (variant_shredding and variant_sample_size)
+struct SnowflakeVariantShredding {
+	//! "COLUMN" (any table) or "TABLE.COLUMN"
+	case_insensitive_set_t columns;
+	//! Rows sampled to infer the fields of a column
+	idx_t sample_rows = DEFAULT_SAMPLE_ROWS;
+
+	static constexpr idx_t DEFAULT_SAMPLE_ROWS = 1000;
+
+	//! Parse a comma-separated list of columns
+	void ParseColumns(const string &value);
+	bool IsShredded(const string &table_name, const string &column_name) const;
+};
+
+//! The field type of a key seen with the comma-separated TYPEOF names `type_names`
+SnowflakeVariantFieldType InferVariantFieldType(const string &type_names);
+
+//! The fields of a shredded column from (key, TYPEOF names) pairs of the sample. Keys that cannot be
+//! STRUCT field names (duplicates ignoring case, the outlier field) are left to the outlier field.
+vector<SnowflakeVariantField> GetVariantFields(const vector<std::pair<string, string>> &sampled_keys);
+
+//! The Snowflake expressions a shredded column is fetched as: a flag that is true for non-NULL
+//! values, one typed column per field (NULL where the value has another type) and the JSON text of
+//! rows that do not fit the fields
+SnowflakeColumnExpansion BuildVariantExpansion(const string &column_name, const vector<SnowflakeVariantField> &fields);
+
+//! How the columns of BuildVariantExpansion are assembled into the STRUCT column
+SnowflakeStructAssembly GetVariantAssembly(const string &column_name, const vector<SnowflakeVariantField> &fields);
+
+//! Replace the flat columns of every assembly in a bound result schema by one STRUCT column, moving
+//! the schema children of the field columns behind the others. Returns the field columns whose
+//! batches have to be converted first (integers fetched as decimal128).
+vector<SnowflakeColumnConversion> ApplyStructAssemblies(ArrowSchema &schema, ArrowTableSchema &arrow_table,
+                                                        const vector<SnowflakeStructAssembly> &assemblies);
+
+} // namespace snowflake
+} // namespace duckdb
@@ -5,6 +5,8 @@
 #include "snowflake_options.hpp"
 #include "snowflake_schema_set.hpp"
 
+#include <thread>
+
 namespace duckdb {
 namespace snowflake {
 
@@ -19,6 +21,9 @@ public:
 	const SnowflakeOptions &GetOptions() const {
 		return options;
 	}
+	const SnowflakeConfig &GetConfig() const {
+		return client->GetConfig();
+	}
 
 	// Required overrides
 	void Initialize(bool load_builtin) override;
@@ -49,7 +54,8 @@ public:
 
 	string GetDBPath() override;
 
-	// Plan operations (not supported yet, read-only)
+	// Plan operations (INSERT and CREATE TABLE AS are implemented in snowflake_insert.cpp,
+	// UPDATE and DELETE in snowflake_remote_statement.cpp)
 	PhysicalOperator &PlanCreateTableAs(ClientContext &context, PhysicalPlanGenerator &planner, LogicalCreateTable &op,
 	                                    PhysicalOperator &plan) override;
 	PhysicalOperator &PlanInsert(ClientContext &context, PhysicalPlanGenerator &planner, LogicalInsert &op,
@@ -63,6 +69,10 @@ private:
 	shared_ptr<SnowflakeClient> client;
 	SnowflakeSchemaSet schemas;
 	SnowflakeOptions options;
+	//! Background login and catalog preload started at ATTACH
+	std::thread warm_up_thread;
+
+	void WarmUp();
 };
 } // namespace snowflake
 } // namespace duckdb
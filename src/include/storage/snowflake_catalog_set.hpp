@@ -14,17 +14,21 @@ public:
 	virtual ~SnowflakeCatalogSet() = default;
 
 	//! Get a single entry (schema/table)
-	optional_ptr<CatalogEntry> GetEntry(ClientContext &context, const string &name);
+	optional_ptr<CatalogEntry> GetEntry(const string &name);
 
 	//! List all entries
-	void Scan(ClientContext &context, const std::function<void(CatalogEntry &)> &callback);
+	void Scan(const std::function<void(CatalogEntry &)> &callback);
+
+	//! Helper function to ensure loading happens only once. Callers racing a
+	//! load in progress (e.g. the ATTACH warm-up thread) block until it is done.
+	void TryLoadEntries();
+
+	//! Add an entry created through DuckDB (e.g. CREATE TABLE), replacing one of the same name
+	optional_ptr<CatalogEntry> CreateEntry(unique_ptr<CatalogEntry> entry);
 
 protected:
 	//! Underlying function called by TryLoadEntries
-	virtual void LoadEntries(ClientContext &context) = 0;
-
-	//! Helper function to ensure loading happens only once
-	void TryLoadEntries(ClientContext &context);
+	virtual void LoadEntries() = 0;
 
 protected:
 	Catalog &catalog;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/common/index_vector.hpp"
+#include "duckdb/planner/parsed_data/bound_create_table_info.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+class SnowflakeInsertGlobalState;
+
+//! How an upsert (INSERT OR REPLACE, INSERT ... ON CONFLICT) applies the staged rows to
+//! the target table. Expressions are Snowflake SQL in which S is the staged row and T the
+//! existing row of the target table.
+struct SnowflakeMergeInfo {
+	//! The columns that identify a row (the conflict target or the PRIMARY KEY)
+	vector<string> key_columns;
+	//! The "column = expression" assignments applied to matched rows (empty: DO NOTHING)
+	vector<string> assignments;
+	//! Only matched rows satisfying this condition are updated (DO UPDATE ... WHERE)
+	string update_condition;
+};
+
+//! SnowflakeInsert appends the rows of its child to a Snowflake table.
+//!
+//! Every sink thread converts its chunks into Arrow record batches of
+//! insert_batch_size rows and streams them through ADBC bulk ingest on a session
+//! of its own into a transient staging table, so large inserts are uploaded in
+//! parallel. Once all threads are done the staged rows are applied to the target
+//! with a single INSERT ... SELECT (or MERGE for upserts) and the staging table is
+//! dropped, so a failed insert leaves the target unchanged. The operator outputs
+//! the number of inserted rows. For CREATE TABLE AS the rows are staged the same
+//! way and the table is created from the staging table in Finalize, so a failed
+//! load creates no table and does not replace an existing one.
+//!
+//! Inside an explicit transaction rows are not ingested: plain inserts are buffered
+//! in the SnowflakeTransaction and upserts are merged from VALUES lists, both over
+//! the transaction's session.
+class SnowflakeInsert : public PhysicalOperator {
+public:
+	static constexpr const PhysicalOperatorType TYPE = PhysicalOperatorType::EXTENSION;
+
+public:
+	//! INSERT INTO
+	SnowflakeInsert(PhysicalPlan &physical_plan, LogicalOperator &op, TableCatalogEntry &table,
+	                physical_index_vector_t<idx_t> column_index_map);
+	//! CREATE TABLE AS
+	SnowflakeInsert(PhysicalPlan &physical_plan, LogicalOperator &op, SchemaCatalogEntry &schema,
+	                unique_ptr<BoundCreateTableInfo> info);
+
+	//! The table to insert into (INSERT INTO)
+	optional_ptr<TableCatalogEntry> table;
+	//! The schema to create the table in and its definition (CREATE TABLE AS)
+	optional_ptr<SchemaCatalogEntry> schema;
+	unique_ptr<BoundCreateTableInfo> info;
+	//! Maps table columns to the position of their value in the input chunk (empty: all columns, in order)
+	physical_index_vector_t<idx_t> column_index_map;
+	//! Set for upserts
+	unique_ptr<SnowflakeMergeInfo> merge;
+
+public:
+	// Source interface
+	SourceResultType GetData(ExecutionContext &context, DataChunk &chunk, OperatorSourceInput &input) const override;
+
+	bool IsSource() const override {
+		return true;
+	}
+
+public:
+	// Sink interface
+	unique_ptr<GlobalSinkState> GetGlobalSinkState(ClientContext &context) const override;
+	unique_ptr<LocalSinkState> GetLocalSinkState(ExecutionContext &context) const override;
+	SinkResultType Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const override;
+	SinkCombineResultType Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const override;
+	SinkFinalizeType Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+	                          OperatorSinkFinalizeInput &input) const override;
+
+	bool IsSink() const override {
+		return true;
+	}
+
+	bool ParallelSink() const override {
+		return true;
+	}
+
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+
+private:
+	//! Upsert inside BEGIN ... COMMIT: MERGE from VALUES lists over the transaction's session
+	SinkFinalizeType FinalizeTransactionMerge(SnowflakeInsertGlobalState &gstate) const;
+};
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "duckdb/execution/physical_operator.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! SnowflakeRemoteStatement runs a single DML statement in Snowflake and outputs
+//! the number of affected rows. It replaces the local plan of UPDATE and DELETE
+//! statements whose predicates and SET expressions translate to Snowflake SQL, so
+//! no data is moved to DuckDB.
+class SnowflakeRemoteStatement : public PhysicalOperator {
+public:
+	static constexpr const PhysicalOperatorType TYPE = PhysicalOperatorType::EXTENSION;
+
+public:
+	SnowflakeRemoteStatement(PhysicalPlan &physical_plan, LogicalOperator &op, TableCatalogEntry &table, string sql);
+
+	//! The table that is modified
+	TableCatalogEntry &table;
+	//! The statement to run in Snowflake
+	string sql;
+
+public:
+	// Source interface
+	SourceResultType GetData(ExecutionContext &context, DataChunk &chunk, OperatorSourceInput &input) const override;
+
+	bool IsSource() const override {
+		return true;
+	}
+
+	string GetName() const override;
+	InsertionOrderPreservingMap<string> ParamsToString() const override;
+};
+
+} // namespace snowflake
+} // namespace duckdb
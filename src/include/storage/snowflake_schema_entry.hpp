@@ -53,6 +53,12 @@ public:
 
 	bool CatalogTypeIsSupported(CatalogType type);
 
+	//! Load the table list for this schema ahead of the first lookup
+	void PreloadTables();
+
+	//! Create the table and fill it with the rows of the `source` table in a single statement
+	optional_ptr<CatalogEntry> CreateTableAs(ClientContext &context, BoundCreateTableInfo &info, const string &source);
+
 private:
 	shared_ptr<SnowflakeClient> client;
 	unique_ptr<SnowflakeTableSet> tables;
@@ -14,7 +14,7 @@ public:
 
 	//! Fetches all schemas from Snowflake and creates SnowflakeSchemaEntry
 	//! objects for each
-	void LoadEntries(ClientContext &context) override;
+	void LoadEntries() override;
 
 private:
 	shared_ptr<SnowflakeClient> client;
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/catalog/entry_lookup_info.hpp"
+#include "duckdb/planner/tableref/bound_at_clause.hpp"
 #include "snowflake_config.hpp"
 #include "snowflake_client.hpp"
+#include "snowflake_number_mapping.hpp"
+#include "snowflake_query_builder.hpp"
 
 namespace duckdb {
 namespace snowflake {
@@ -54,14 +58,59 @@ public:
 	}
 
 	TableFunction GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) override;
+	//! A scan of the table as of the AT clause of the lookup, or as of the catalog's snapshot
+	TableFunction GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data,
+	                              const EntryLookupInfo &lookup_info) override;
 
 	unique_ptr<BaseStatistics> GetStatistics(ClientContext &context, column_t column_id) override;
 
 	TableStorageInfo GetStorageInfo(ClientContext &context) override;
 
+	//! Fetch the column list from Snowflake if it has not been loaded yet. Table sets
+	//! are listed without columns; statements that bind against the columns (INSERT)
+	//! need them before any scan has run. The columns are read from INFORMATION_SCHEMA,
+	//! without running a query on the table.
+	void LoadColumns(ClientContext &context);
+
+	//! The PRIMARY KEY columns of the table, fetched from Snowflake on first use. They are
+	//! reported as a unique index so ON CONFLICT / INSERT OR REPLACE can bind against them.
+	vector<string> GetPrimaryKeyColumns(ClientContext &context);
+
+	//! Adjust the DuckDB types of a scan's result schema: Snowflake timestamps, shredded VARIANT
+	//! columns and the catalog's NUMBER mapping. Returns the columns the scan has to convert.
+	vector<SnowflakeColumnConversion> BindResultTypes(ArrowSchema &schema, ArrowTableSchema &arrow_table);
+
 private:
 	shared_ptr<SnowflakeClient> client;
+	mutex columns_lock;
 	bool columns_loaded = false;
+	bool primary_key_loaded = false;
+	vector<string> primary_key;
+	//! Significant digits of the values of NARROW-mapped columns wider than 18 digits, from
+	//! their MIN/MAX when first bound (0: unknown or empty)
+	bool number_widths_loaded = false;
+	case_insensitive_map_t<uint8_t> number_widths;
+	//! Shredded VARIANT columns (variant_shredding), inferred when the table is first bound. A scan
+	//! lists the table's columns (scan_columns), fetching the shredded ones as expressions.
+	bool variant_fields_loaded = false;
+	vector<string> scan_columns;
+	shared_ptr<const column_expansion_map_t> column_expansions;
+	vector<SnowflakeStructAssembly> struct_assemblies;
+
+	string GetScanTableName() const;
+	string GetScanQuery(const SnowflakeTimeTravel &time_travel = SnowflakeTimeTravel()) const;
+	TableFunction BindScan(ClientContext &context, unique_ptr<FunctionData> &bind_data,
+	                       optional_ptr<BoundAtClause> at_clause);
+	void SetColumns(const vector<string> &names, const vector<LogicalType> &types);
+	//! Type the columns from INFORMATION_SCHEMA, mapped like the result schema of a scan. Returns false
+	//! if the metadata does not describe the table, which is then bound from its result schema.
+	bool BindMetadataTypes(ClientContext &context, SnowflakeClient &connection, vector<string> &names,
+	                       vector<LogicalType> &types);
+	vector<SnowflakeColumnConversion> ApplyNumberMapping(ArrowTableSchema &arrow_table);
+	//! The types the catalog's NUMBER mapping reads the DECIMAL columns among `types` as, by column index
+	unordered_map<idx_t, LogicalType> GetNumberTypes(const vector<string> &names, const vector<LogicalType> &types);
+	void LoadNumberWidths(const vector<string> &column_names, const vector<uint8_t> &scales);
+	void LoadVariantFields();
 };
 } // namespace snowflake
 } // namespace duckdb
@@ -3,6 +3,7 @@
 #include "snowflake_catalog_set.hpp"
 #include "snowflake_client.hpp"
 #include "snowflake_schema_entry.hpp"
+#include "duckdb/planner/parsed_data/bound_create_table_info.hpp"
 
 namespace duckdb {
 namespace snowflake {
@@ -14,9 +15,15 @@ public:
 	    : SnowflakeCatalogSet(schema.catalog), schema(schema), client(std::move(client)), schema_name(schema_name) {
 	}
 
+	//! Create the table in Snowflake and add it to the set. Returns nullptr if the
+	//! table exists and the statement is CREATE TABLE IF NOT EXISTS. With a `source`
+	//! table the new table is filled with its rows by the same statement.
+	optional_ptr<CatalogEntry> CreateTable(ClientContext &context, BoundCreateTableInfo &info,
+	                                       const string &source = string());
+
 protected:
 	//! Load tables for this schema
-	void LoadEntries(ClientContext &context) override;
+	void LoadEntries() override;
 
 private:
 	SnowflakeSchemaEntry &schema;
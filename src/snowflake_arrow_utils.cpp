@@ -1,7 +1,17 @@
 #include "snowflake_debug.hpp"
 #include "snowflake_arrow_utils.hpp"
 #include "snowflake_query_builder.hpp"
+#include "snowflake_retry.hpp"
+#include "snowflake_scan_prefetch.hpp"
+#include "snowflake_resumable_stream.hpp"
+#include "snowflake_result_cache.hpp"
+#include "snowflake_schema_cache.hpp"
+#include "snowflake_types.hpp"
+#include "duckdb/common/arrow/arrow_appender.hpp"
+#include "duckdb/common/arrow/arrow_converter.hpp"
+#include "duckdb/common/arrow/arrow_type_extension.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
 
 namespace duckdb {
 
@@ -23,6 +33,241 @@ public:
 	}
 };
 
+// Create the ADBC statement for the factory if not already done
+static void InitializeFactoryStatement(SnowflakeArrowStreamFactory &factory) {
+	if (factory.statement_initialized) {
+		return;
+	}
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+
+	// Create a new ADBC statement from the connection
+	factory.session = factory.connection->GetSession();
+	AdbcStatusCode status = AdbcStatementNew(&factory.session->connection, &factory.statement, &error);
+	DPRINT("Statement created at %p for factory %p\n", (void *)&factory.statement, (void *)&factory);
+	if (status != ADBC_STATUS_OK) {
+		std::string error_msg = "Failed to create statement";
+		if (error.message) {
+			error_msg += std::string(": ") + error.message;
+			if (error.release) {
+				error.release(&error);
+			}
+		}
+		throw IOException(error_msg);
+	}
+	factory.statement_initialized = true;
+
+	if (factory.prefetch_concurrency > 0) {
+		auto value = std::to_string(factory.prefetch_concurrency);
+		status = AdbcStatementSetOption(&factory.statement, "adbc.snowflake.rpc.prefetch_concurrency", value.c_str(),
+		                                &error);
+		snowflake::SnowflakeClient::CheckError(status, "Failed to set prefetch_concurrency", &error);
+	}
+	if (factory.result_queue_size > 0) {
+		auto value = std::to_string(factory.result_queue_size);
+		status = AdbcStatementSetOption(&factory.statement, "adbc.rpc.result_queue_size", value.c_str(), &error);
+		snowflake::SnowflakeClient::CheckError(status, "Failed to set result_queue_size", &error);
+	}
+}
+
+// Drop the factory's statement before a retry; it is re-created on the next attempt
+static void ResetFactoryStatement(SnowflakeArrowStreamFactory &factory, snowflake::SnowflakeErrorClass error_class) {
+	if (factory.statement_initialized) {
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		AdbcStatementRelease(&factory.statement, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+		std::memset(&factory.statement, 0, sizeof(factory.statement));
+		factory.statement_initialized = false;
+		factory.session.reset();
+	}
+	if (error_class == snowflake::SnowflakeErrorClass::SESSION_EXPIRED) {
+		factory.connection->Reconnect();
+	}
+}
+
+// Bind the factory's parameters as a one-row batch; the driver takes ownership of it
+static void BindFactoryParameters(SnowflakeArrowStreamFactory &factory) {
+	if (factory.parameters.empty()) {
+		return;
+	}
+	vector<LogicalType> types;
+	vector<string> names;
+	for (idx_t i = 0; i < factory.parameters.size(); i++) {
+		types.push_back(factory.parameters[i].type());
+		names.push_back(std::to_string(i + 1));
+	}
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), types, 1);
+	for (idx_t i = 0; i < factory.parameters.size(); i++) {
+		chunk.SetValue(i, 0, factory.parameters[i]);
+	}
+	chunk.SetCardinality(1);
+	ArrowAppender appender(types, 1, factory.client_properties,
+	                       unordered_map<idx_t, const shared_ptr<ArrowTypeExtensionData>>());
+	appender.Append(chunk, 0, 1, 1);
+	auto values = appender.Finalize();
+	ArrowSchema schema;
+	ArrowConverter::ToArrowSchema(&schema, types, names, factory.client_properties);
+
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	auto status = AdbcStatementBind(&factory.statement, &values, &schema, &error);
+	if (values.release) {
+		values.release(&values);
+	}
+	if (schema.release) {
+		schema.release(&schema);
+	}
+	snowflake::SnowflakeClient::CheckError(status, "Failed to bind query parameters", &error);
+}
+
+// Set `query` (the possibly pushdown-modified query, or a RESULT_SCAN of its earlier result) on the
+// statement and execute it
+static void ExecuteFactoryQuery(SnowflakeArrowStreamFactory &factory, const string &query, ArrowArrayStream &stream,
+                                int64_t &rows_affected) {
+	// Initialize ADBC statement if not already done
+	// We defer this to the produce function to avoid executing the query during
+	// bind
+	InitializeFactoryStatement(factory);
+
+	// Always set the SQL query before execution to ensure we use the modified
+	// query with pushdown This handles the case where the statement was
+	// initialized during schema fetch but pushdown parameters are only available
+	// now during execution
+	{
+		AdbcError set_error;
+		std::memset(&set_error, 0, sizeof(set_error));
+		AdbcStatusCode set_status = AdbcStatementSetSqlQuery(&factory.statement, query.c_str(), &set_error);
+		DPRINT("Setting query on statement: %s\n", query.c_str());
+		if (set_status != ADBC_STATUS_OK) {
+			std::string error_msg = "Failed to set query: ";
+			if (set_error.message) {
+				error_msg += set_error.message;
+				if (set_error.release) {
+					set_error.release(&set_error);
+				}
+			}
+			throw IOException(error_msg);
+		}
+	}
+	BindFactoryParameters(factory);
+
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+
+	// Tag read-only queries so a failed result stream can be re-opened with RESULT_SCAN
+	factory.query_tag.clear();
+	if (snowflake::IsIdempotentQuery(query) && factory.connection->GetConfig().max_retries > 0) {
+		auto query_tag = snowflake::GenerateScanQueryTag(factory.connection->GetConfig());
+		if (AdbcStatementSetOption(&factory.statement, snowflake::SNOWFLAKE_QUERY_TAG_OPTION, query_tag.c_str(),
+		                           &error) == ADBC_STATUS_OK) {
+			factory.query_tag = query_tag;
+		} else {
+			DPRINT("Driver does not support query tags, scan will not be resumable\n");
+			if (error.release) {
+				error.release(&error);
+			}
+			std::memset(&error, 0, sizeof(error));
+		}
+	}
+
+	// ExecuteQuery returns an ArrowArrayStream that provides Arrow record batches
+	factory.statement_number = factory.connection->CountStatement();
+	AdbcStatusCode status = AdbcStatementExecuteQuery(&factory.statement, &stream, &rows_affected, &error);
+	if (status != ADBC_STATUS_OK) {
+		std::string error_msg = "Failed to execute query: ";
+		if (error.message) {
+			error_msg += error.message;
+			if (error.release) {
+				error.release(&error);
+			}
+		}
+		throw IOException(error_msg);
+	}
+}
+
+static bool SameArrowFields(const ArrowSchema &left, const ArrowSchema &right) {
+	if (left.n_children != right.n_children) {
+		return false;
+	}
+	for (int64_t child_idx = 0; child_idx < left.n_children; child_idx++) {
+		auto &left_child = *left.children[child_idx];
+		auto &right_child = *right.children[child_idx];
+		if (string(left_child.name ? left_child.name : "") != string(right_child.name ? right_child.name : "") ||
+		    string(left_child.format ? left_child.format : "") !=
+		        string(right_child.format ? right_child.format : "")) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// A scan bound from a cached schema must produce that schema; otherwise the cache entries are dropped
+// and the scan fails so the query can be bound again
+static void CheckCachedResultSchema(SnowflakeArrowStreamFactory &factory, ArrowArrayStream &stream) {
+	ArrowSchemaWrapper actual;
+	if (stream.get_schema(&stream, &actual.arrow_schema) != 0) {
+		// The stream reports its own error on the first batch
+		return;
+	}
+	if (SameArrowFields(actual.arrow_schema, factory.result_schema->arrow_schema)) {
+		return;
+	}
+	DPRINT("Result schema of %s differs from the cached schema\n", factory.query.c_str());
+	snowflake::SnowflakeSchemaCache::GetInstance().Invalidate(factory.connection->GetConfig(), factory.query);
+	factory.statement_cache_key.clear();
+	stream.release(&stream);
+	throw InvalidInputException("The result schema of the Snowflake query has changed since it was bound; run the "
+	                            "query again");
+}
+
+// Look up the recorded result of `query`. If the tables it read have not changed since, `query` is
+// replaced by a RESULT_SCAN of that result. Returns whether the query that runs is to be recorded, with
+// the current versions of its tables in `table_versions`.
+static bool PrepareResultReuse(SnowflakeArrowStreamFactory &factory, string &query, vector<string> &table_versions) {
+	auto &config = factory.connection->GetConfig();
+	auto &cache = snowflake::SnowflakeResultCache::GetInstance();
+	try {
+		table_versions = factory.connection->GetTableVersions(factory.result_tables);
+	} catch (std::exception &ex) {
+		// e.g. a view, which has no change time of its own
+		DPRINT("Not reusing results of %s: %s\n", query.c_str(), ex.what());
+		return false;
+	}
+	auto persisted = cache.Get(config, query);
+	if (!persisted) {
+		return true;
+	}
+	if (persisted->table_versions != table_versions) {
+		DPRINT("Tables of %s changed since query %s\n", query.c_str(), persisted->query_id.c_str());
+		cache.Invalidate(config, query);
+		return true;
+	}
+	DPRINT("Reading the result of query %s for %s\n", persisted->query_id.c_str(), query.c_str());
+	query = "SELECT * FROM TABLE(RESULT_SCAN(" + KeywordHelper::WriteQuoted(persisted->query_id, '\'') + "))";
+	return false;
+}
+
+// Record the query ID of the query the factory just executed, if no other statement may have run on its
+// session in between
+static void RecordResult(SnowflakeArrowStreamFactory &factory, const string &query, vector<string> table_versions) {
+	auto result = make_shared_ptr<snowflake::SnowflakePersistedResult>();
+	try {
+		result->query_id = factory.connection->GetLastQueryIdOf(factory.statement_number);
+	} catch (std::exception &ex) {
+		DPRINT("Failed to look up the query ID of %s: %s\n", query.c_str(), ex.what());
+		return;
+	}
+	if (result->query_id.empty()) {
+		return;
+	}
+	result->table_versions = std::move(table_versions);
+	snowflake::SnowflakeResultCache::GetInstance().Put(factory.connection->GetConfig(), query, std::move(result));
+}
+
 // This function is called by DuckDB's arrow_scan to produce an
 // ArrowArrayStreamWrapper It's called once per scan to create the stream that
 // will provide data chunks
@@ -42,6 +287,14 @@ unique_ptr<ArrowArrayStreamWrapper> SnowflakeProduceArrowScan(uintptr_t factory_
 		}
 	}
 
+	// The query may have been submitted when the first Snowflake scan of the plan started
+	if (factory->scan_group) {
+		auto prefetched = factory->scan_group->StartScan(*factory, parameters.projected_columns.columns);
+		if (prefetched) {
+			return prefetched;
+		}
+	}
+
 	// Apply pushdown if enabled (this modifies the query before execution)
 	if (factory->filter_pushdown_enabled || factory->projection_pushdown_enabled) {
 		// Extract projection columns from parameters
@@ -68,63 +321,70 @@ unique_ptr<ArrowArrayStreamWrapper> SnowflakeProduceArrowScan(uintptr_t factory_
 		// original query
 	}
 
-	// Initialize ADBC statement if not already done
-	// We defer this to the produce function to avoid executing the query during
-	// bind
-	if (!factory->statement_initialized) {
-		AdbcError error;
-		std::memset(&error, 0, sizeof(error));
-
-		// Create a new ADBC statement from the connection
-		AdbcStatusCode status = AdbcStatementNew(factory->connection->GetConnection(), &factory->statement, &error);
-		DPRINT("Statement created at %p for factory %p\n", (void *)&factory->statement, (void *)factory);
-		if (status != ADBC_STATUS_OK) {
-			throw IOException("Failed to create statement");
-		}
-		factory->statement_initialized = true;
-	}
-
-	// Always set the SQL query before execution to ensure we use the modified
-	// query with pushdown This handles the case where the statement was
-	// initialized during schema fetch but pushdown parameters are only available
-	// now during execution
-	{
-		AdbcError set_error;
-		std::memset(&set_error, 0, sizeof(set_error));
-		AdbcStatusCode set_status =
-		    AdbcStatementSetSqlQuery(&factory->statement, factory->modified_query.c_str(), &set_error);
-		DPRINT("Setting query on statement: %s\n", factory->modified_query.c_str());
-		if (set_status != ADBC_STATUS_OK) {
-			std::string error_msg = "Failed to set query: ";
-			if (set_error.message) {
-				error_msg += set_error.message;
-				if (set_error.release) {
-					set_error.release(&set_error);
-				}
-			}
-			throw IOException(error_msg);
-		}
-	}
-
 	// Execute the query and get the ArrowArrayStream
 	// This is where the actual query execution happens
 	auto wrapper = make_uniq<SnowflakeArrowArrayStreamWrapper>();
 	struct ArrowArrayStream adbc_stream;
-	int64_t rows_affected;
-	AdbcError error;
-	std::memset(&error, 0, sizeof(error));
+	int64_t rows_affected = -1;
+	std::memset(&adbc_stream, 0, sizeof(adbc_stream));
 
-	// ExecuteQuery returns an ArrowArrayStream that provides Arrow record batches
-	AdbcStatusCode status = AdbcStatementExecuteQuery(&factory->statement, &adbc_stream, &rows_affected, &error);
-	if (status != ADBC_STATUS_OK) {
-		std::string error_msg = "Failed to execute query: ";
-		if (error.message) {
-			error_msg += error.message;
-			if (error.release) {
-				error.release(&error);
+	// An identical query of unchanged tables may have left a result to read instead of running again
+	auto query = factory->modified_query;
+	vector<string> table_versions;
+	bool record_result = false;
+	if (!factory->result_tables.empty() && factory->parameters.empty() && snowflake::IsIdempotentQuery(query)) {
+		record_result = PrepareResultReuse(*factory, query, table_versions);
+	}
+	auto execute = [&](const string &query_to_run) {
+		// Read-only queries are retried on transient errors, with a new session if it expired
+		if (snowflake::IsIdempotentQuery(query_to_run)) {
+			auto &config = factory->connection->GetConfig();
+			snowflake::RunWithRetry(
+			    config, "Snowflake query",
+			    [&]() { ExecuteFactoryQuery(*factory, query_to_run, adbc_stream, rows_affected); },
+			    [&](snowflake::SnowflakeErrorClass error_class) { ResetFactoryStatement(*factory, error_class); });
+		} else {
+			ExecuteFactoryQuery(*factory, query_to_run, adbc_stream, rows_affected);
+		}
+	};
+	try {
+		if (query != factory->modified_query) {
+			try {
+				execute(query);
+			} catch (std::exception &ex) {
+				// The persisted result is gone (e.g. purged early): run the query after all
+				DPRINT("RESULT_SCAN failed, running %s: %s\n", factory->modified_query.c_str(), ex.what());
+				snowflake::SnowflakeResultCache::GetInstance().Invalidate(factory->connection->GetConfig(),
+				                                                          factory->modified_query);
+				query = factory->modified_query;
+				record_result = true;
+				execute(query);
 			}
+		} else {
+			execute(query);
 		}
-		throw IOException(error_msg);
+	} catch (std::exception &) {
+		if (factory->result_schema_cached) {
+			// e.g. the table was dropped - do not bind the next query from the cached schema either
+			snowflake::SnowflakeSchemaCache::GetInstance().Invalidate(factory->connection->GetConfig(),
+			                                                          factory->query);
+		}
+		throw;
+	}
+	if (factory->result_schema_cached) {
+		CheckCachedResultSchema(*factory, adbc_stream);
+	}
+	if (record_result) {
+		RecordResult(*factory, query, std::move(table_versions));
+	}
+
+	if (!factory->query_tag.empty()) {
+		snowflake::WrapResumableStream(adbc_stream, factory->connection, factory->query_tag,
+		                               factory->inject_stream_failure);
+	}
+	if (!factory->column_conversions.empty() || !factory->struct_assemblies.empty()) {
+		// Outermost, so rows re-read after a resume are converted too
+		snowflake::WrapConversionStream(adbc_stream, factory->column_conversions, factory->struct_assemblies);
 	}
 
 	// Transfer ownership of the ADBC stream to our wrapper
@@ -135,25 +395,15 @@ unique_ptr<ArrowArrayStreamWrapper> SnowflakeProduceArrowScan(uintptr_t factory_
 	return std::move(wrapper);
 }
 
-// This function is called by DuckDB's arrow_scan during bind to get the schema
-// It allows DuckDB to know the column types before actually executing the query
-void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema) {
-	auto factory = reinterpret_cast<SnowflakeArrowStreamFactory *>(factory_ptr);
-
+static void GetFactorySchema(SnowflakeArrowStreamFactory &factory, ArrowSchema &schema) {
 	// Initialize statement if not already done
-	if (!factory->statement_initialized) {
-		AdbcError error;
-		std::memset(&error, 0, sizeof(error));
-
-		AdbcStatusCode status = AdbcStatementNew(factory->connection->GetConnection(), &factory->statement, &error);
-		DPRINT("Statement created at %p for factory %p\n", (void *)&factory->statement, (void *)factory);
-		if (status != ADBC_STATUS_OK) {
-			throw IOException("Failed to create statement");
-		}
-		factory->statement_initialized = true;
+	if (!factory.statement_initialized) {
+		InitializeFactoryStatement(factory);
 
 		// Set the query (use modified_query which includes pushdown)
-		status = AdbcStatementSetSqlQuery(&factory->statement, factory->modified_query.c_str(), &error);
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		AdbcStatusCode status = AdbcStatementSetSqlQuery(&factory.statement, factory.modified_query.c_str(), &error);
 		if (status != ADBC_STATUS_OK) {
 			std::string error_msg = "Failed to set query: ";
 			if (error.message) {
@@ -165,6 +415,7 @@ void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema)
 			throw IOException(error_msg);
 		}
 	}
+	BindFactoryParameters(factory);
 
 	// Execute with schema only - this is a lightweight operation that just
 	// returns the schema without actually executing the full query
@@ -172,8 +423,8 @@ void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema)
 	std::memset(&schema_error, 0, sizeof(schema_error));
 	std::memset(&schema, 0, sizeof(schema));
 
-	AdbcStatusCode schema_status = AdbcStatementExecuteSchema(&factory->statement, &schema, &schema_error);
-	DPRINT("ExecuteSchema completed for statement %p\n", (void *)&factory->statement);
+	AdbcStatusCode schema_status = AdbcStatementExecuteSchema(&factory.statement, &schema, &schema_error);
+	DPRINT("ExecuteSchema completed for statement %p\n", (void *)&factory.statement);
 	if (schema_status != ADBC_STATUS_OK) {
 		std::string error_msg = "Failed to get schema: ";
 		if (schema_error.message) {
@@ -186,6 +437,115 @@ void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema)
 	}
 }
 
+// This function is called by DuckDB's arrow_scan during bind to get the schema
+// It allows DuckDB to know the column types before actually executing the query
+void SnowflakeGetArrowSchema(ArrowArrayStream *factory_ptr, ArrowSchema &schema) {
+	auto factory = reinterpret_cast<SnowflakeArrowStreamFactory *>(factory_ptr);
+
+	if (factory->result_schema) {
+		// Looked up by an earlier scan of the same prepared statement
+		snowflake::ShareArrowSchema(factory->result_schema, schema);
+		return;
+	}
+
+	// ExecuteSchema does not run the query, so it is safe to retry for any statement
+	auto &config = factory->connection->GetConfig();
+	if (factory->statement_cache_key.empty()) {
+		snowflake::RunWithRetry(
+		    config, "Snowflake schema lookup", [&]() { GetFactorySchema(*factory, schema); },
+		    [&](snowflake::SnowflakeErrorClass error_class) { ResetFactoryStatement(*factory, error_class); });
+		return;
+	}
+	auto result_schema = make_shared_ptr<ArrowSchemaWrapper>();
+	snowflake::RunWithRetry(
+	    config, "Snowflake schema lookup", [&]() { GetFactorySchema(*factory, result_schema->arrow_schema); },
+	    [&](snowflake::SnowflakeErrorClass error_class) { ResetFactoryStatement(*factory, error_class); });
+	factory->result_schema = std::move(result_schema);
+	snowflake::ShareArrowSchema(factory->result_schema, schema);
+}
+
+SnowflakeArrowStreamFactory::~SnowflakeArrowStreamFactory() {
+	if (!statement_initialized) {
+		return;
+	}
+	if (!statement_cache_key.empty() && result_schema) {
+		auto prepared = make_uniq<snowflake::SnowflakePreparedStatement>();
+		prepared->statement = statement;
+		prepared->schema = result_schema;
+		prepared->session = session;
+		connection->CachePreparedStatement(statement_cache_key, std::move(prepared));
+		return;
+	}
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	AdbcStatementRelease(&statement, &error);
+	if (error.release) {
+		error.release(&error);
+	}
+}
+
+void SnowflakeArrowStreamFactory::SetParameters(vector<Value> values, ClientProperties properties) {
+	// Sent as the types Snowflake ingest understands, so the driver can bind every parameter
+	parameters.clear();
+	statement_cache_key = query;
+	for (auto &value : values) {
+		auto bind_type = snowflake::GetSnowflakeIngestType(value.type());
+		parameters.push_back(value.DefaultCastAs(bind_type));
+		statement_cache_key += "\n" + bind_type.ToString();
+	}
+	client_properties = std::move(properties);
+
+	auto prepared = connection->TakePreparedStatement(statement_cache_key);
+	if (!prepared) {
+		return;
+	}
+	if (statement_initialized) {
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		AdbcStatementRelease(&statement, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+	}
+	statement = prepared->statement;
+	std::memset(&prepared->statement, 0, sizeof(prepared->statement));
+	statement_initialized = true;
+	result_schema = prepared->schema;
+	result_schema_cached = true;
+	session = prepared->session;
+}
+
+namespace snowflake {
+
+//! A view of a shared schema with its own children array
+struct SnowflakeSharedSchema {
+	shared_ptr<ArrowSchemaWrapper> source;
+	vector<ArrowSchema *> children;
+};
+
+static void SharedSchemaRelease(ArrowSchema *schema) {
+	if (!schema->release) {
+		return;
+	}
+	delete reinterpret_cast<SnowflakeSharedSchema *>(schema->private_data);
+	schema->release = nullptr;
+}
+
+void ShareArrowSchema(shared_ptr<ArrowSchemaWrapper> source, ArrowSchema &schema) {
+	auto shared = make_uniq<SnowflakeSharedSchema>();
+	auto &source_schema = source->arrow_schema;
+	for (int64_t child_idx = 0; child_idx < source_schema.n_children; child_idx++) {
+		shared->children.push_back(source_schema.children[child_idx]);
+	}
+	schema = source_schema;
+	schema.children = shared->children.empty() ? nullptr : shared->children.data();
+	shared->source = std::move(source);
+	schema.private_data = shared.release();
+	schema.release = SharedSchemaRelease;
+}
+
+} // namespace snowflake
+
 void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string> &projection,
                                                            TableFilterSet *filter_set) {
 	DPRINT("UpdatePushdownParameters called: projection_size=%lu, "
@@ -195,13 +555,21 @@ void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string>
 	// Store the parameters
 	projection_columns = projection;
 	current_filters = filter_set;
+	modified_query = BuildPushdownQuery(projection, filter_set);
+}
 
+string SnowflakeArrowStreamFactory::BuildPushdownQuery(const vector<string> &projection,
+                                                       TableFilterSet *filter_set) const {
 	try {
 		// Extract table name from base query (e.g., "SELECT * FROM
-		// database.schema.table")
-		string table_name;
-		size_t from_pos = StringUtil::Upper(query).find(" FROM ");
-		if (from_pos != string::npos) {
+		// database.schema.table"), unless the table entry has set it because the
+		// base query lists expressions before FROM
+		string table_name = this->table_name;
+		if (table_name.empty()) {
+			size_t from_pos = StringUtil::Upper(query).find(" FROM ");
+			if (from_pos == string::npos) {
+				throw InvalidInputException("Invalid base query format: missing FROM clause");
+			}
 			table_name = query.substr(from_pos + 6); // Skip " FROM "
 			StringUtil::Trim(table_name);
 			// Remove trailing semicolon if present
@@ -209,8 +577,6 @@ void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string>
 				table_name.pop_back();
 				StringUtil::Trim(table_name);
 			}
-		} else {
-			throw InvalidInputException("Invalid base query format: missing FROM clause");
 		}
 
 		// Determine what to push down based on enabled flags
@@ -218,13 +584,16 @@ void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string>
 		TableFilterSet *filters_to_push = nullptr;
 
 		// Only apply projection if projection pushdown is enabled
-		if (projection_pushdown_enabled && !projection_columns.empty()) {
-			cols_to_project = projection_columns;
+		if (projection_pushdown_enabled && !projection.empty()) {
+			cols_to_project = projection;
+		} else if (column_expansions) {
+			// SELECT * would fetch the expanded columns as they are stored
+			cols_to_project = column_names;
 		}
 
 		// Only push filters if filter pushdown is enabled
 		if (filter_pushdown_enabled) {
-			filters_to_push = current_filters;
+			filters_to_push = filter_set;
 		}
 
 		// Build the complete query using AST construction
@@ -233,10 +602,11 @@ void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string>
 		// schema (column_names). So we pass cols_to_project as the column mapping
 		// for filters.
 		vector<string> filter_column_names = cols_to_project.empty() ? column_names : cols_to_project;
-		modified_query = snowflake::SnowflakeQueryBuilder::BuildQuery(table_name, cols_to_project, filters_to_push,
-		                                                              filter_column_names);
+		auto result = snowflake::SnowflakeQueryBuilder::BuildQuery(
+		    table_name, cols_to_project, filters_to_push, filter_column_names, column_expansions.get(), &time_travel);
 
-		DPRINT("Pushdown applied:\n  Original: %s\n  Modified: %s\n", query.c_str(), modified_query.c_str());
+		DPRINT("Pushdown applied:\n  Original: %s\n  Modified: %s\n", query.c_str(), result.c_str());
+		return result;
 
 	} catch (const NotImplementedException &e) {
 		// Re-throw NotImplementedException - don't fall back in strict mode
@@ -244,7 +614,7 @@ void SnowflakeArrowStreamFactory::UpdatePushdownParameters(const vector<string>
 	} catch (const std::exception &e) {
 		// Fallback for other exceptions (e.g., parsing errors)
 		DPRINT("Pushdown failed: %s, using original query\n", e.what());
-		modified_query = query;
+		return query;
 	}
 }
 
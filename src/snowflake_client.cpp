@@ -1,82 +1,57 @@
 #include "snowflake_debug.hpp"
 #include "snowflake_client.hpp"
 #include "snowflake_types.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_retry.hpp"
 
 #include "duckdb/common/exception.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
 
 #include <cstring>
-#include <fstream>
-
-#ifdef _WIN32
-#include <windows.h>
-#include <io.h>
-#define access _access
-#else
-#include <dlfcn.h>
-#include <sys/stat.h>
-#include <unistd.h>
-#endif
 
 namespace duckdb {
 namespace snowflake {
 
-// Helper function to check if a file exists
-static bool FileExists(const std::string &path) {
-#ifdef _WIN32
-	return (access(path.c_str(), 0) == 0);
-#else
-	struct stat buffer;
-	return (stat(path.c_str(), &buffer) == 0);
-#endif
-}
-
-// Get the directory where the current extension is located
-static std::string GetExtensionDirectory() {
-#ifdef _WIN32
-	HMODULE hModule = NULL;
-	// Get handle to the module containing this function
-	if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-	                      reinterpret_cast<LPCTSTR>(&GetExtensionDirectory), &hModule)) {
-		char path[MAX_PATH];
-		if (GetModuleFileNameA(hModule, path, sizeof(path))) {
-			std::string full_path(path);
-			// Find the last directory separator
-			size_t last_sep = full_path.find_last_of("/\\");
-			std::string dir = (last_sep != std::string::npos) ? full_path.substr(0, last_sep) : ".";
-
-			DPRINT("GetExtensionDirectory: module path = %s\n", path);
-			DPRINT("GetExtensionDirectory: parent_path = %s\n", dir.c_str());
-
-			return dir;
+SnowflakePreparedStatement::SnowflakePreparedStatement() {
+	std::memset(&statement, 0, sizeof(statement));
+}
+
+SnowflakePreparedStatement::~SnowflakePreparedStatement() {
+	if (statement.private_data) {
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		AdbcStatementRelease(&statement, &error);
+		if (error.release) {
+			error.release(&error);
 		}
 	}
-	// Fallback to current directory
-	return ".";
-#else
-	Dl_info info;
-	// Use a function from this library to get its path
-	if (dladdr(reinterpret_cast<void *>(&GetExtensionDirectory), &info)) {
-		std::string path(info.dli_fname);
-		// Find the last directory separator
-		size_t last_sep = path.find_last_of("/\\");
-		std::string dir = (last_sep != std::string::npos) ? path.substr(0, last_sep) : ".";
+}
 
-		DPRINT("GetExtensionDirectory: dli_fname = %s\n", info.dli_fname);
-		DPRINT("GetExtensionDirectory: parent_path = %s\n", dir.c_str());
+SnowflakeSession::SnowflakeSession(shared_ptr<SnowflakeDatabase> database_p) : database(std::move(database_p)) {
+	std::memset(&connection, 0, sizeof(connection));
+}
 
-		return dir;
+SnowflakeSession::~SnowflakeSession() {
+	if (!connection.private_data) {
+		// Never connected
+		return;
+	}
+	try {
+		if (discard) {
+			database->DiscardConnection(connection);
+		} else {
+			// Keep the authenticated session around for the next client with these credentials
+			database->ReleaseConnection(connection, in_transaction);
+		}
+	} catch (const std::exception &e) {
+		DPRINT("Releasing a Snowflake session failed: %s\n", e.what());
 	}
-	// Fallback to current directory
-	return ".";
-#endif
 }
 
 SnowflakeClient::SnowflakeClient() {
-	std::memset(&database, 0, sizeof(database));
-	std::memset(&connection, 0, sizeof(connection));
 }
 
 SnowflakeClient::~SnowflakeClient() {
@@ -84,267 +59,181 @@ SnowflakeClient::~SnowflakeClient() {
 }
 
 void SnowflakeClient::Connect(const SnowflakeConfig &config) {
-	if (connected) {
-		Disconnect();
-	}
+	Disconnect();
 
 	this->config = config;
-	InitializeDatabase(config);
 	InitializeConnection();
-	connected = true;
 }
 
-void SnowflakeClient::Disconnect() {
-	if (!connected) {
-		return;
-	}
-
-	AdbcError error;
-	std::memset(&error, 0, sizeof(error));
-	AdbcStatusCode status;
-
-	status = AdbcConnectionRelease(&connection, &error);
-	CheckError(status, "Failed to release ADBC connection", &error);
-
-	status = AdbcDatabaseRelease(&database, &error);
-	CheckError(status, "Failed to release ADBC database", &error);
+void SnowflakeClient::ConnectAsync(const SnowflakeConfig &config) {
+	Disconnect();
 
-	connected = false;
+	this->config = config;
+	std::lock_guard<std::mutex> lock(connect_lock);
+	pending_connect = std::async(std::launch::async, [this]() { InitializeConnection(); }).share();
 }
 
-bool SnowflakeClient::IsConnected() const {
-	return connected;
+void SnowflakeClient::WaitForConnection() {
+	std::shared_future<void> pending;
+	{
+		std::lock_guard<std::mutex> lock(connect_lock);
+		pending = pending_connect;
+	}
+	if (pending.valid()) {
+		pending.get();
+	}
 }
 
-const SnowflakeConfig &SnowflakeClient::GetConfig() const {
-	return config;
+bool SnowflakeClient::IsConnecting() {
+	std::lock_guard<std::mutex> lock(connect_lock);
+	return pending_connect.valid() &&
+	       pending_connect.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
 }
 
-void SnowflakeClient::InitializeDatabase(const SnowflakeConfig &config) {
-	AdbcError error;
-	std::memset(&error, 0, sizeof(error));
-
-	AdbcStatusCode status = AdbcDatabaseNew(&database, &error);
-	CheckError(status, "Failed to create ADBC database", &error);
-
-	// Use ADBC driver manager to load the Snowflake driver dynamically
-	// Try multiple locations for the driver
-	std::vector<std::string> search_paths;
-
-	// 1. Try the extension directory (for packaged extensions with driver)
-	std::string extension_dir = GetExtensionDirectory();
-	search_paths.push_back(extension_dir + "/" + SNOWFLAKE_ADBC_LIB);
-
-	// 2. Check environment variable (for custom locations)
-	const char *env_path = std::getenv("SNOWFLAKE_ADBC_DRIVER_PATH");
-	if (env_path) {
-		search_paths.push_back(env_path);
-	}
-
-	// 3. Try system paths
-#ifdef _WIN32
-	search_paths.push_back(std::string("C:\\Windows\\System32\\") + SNOWFLAKE_ADBC_LIB);
-	search_paths.push_back(std::string("C:\\Program Files\\Snowflake\\") + SNOWFLAKE_ADBC_LIB);
-#else
-	search_paths.push_back(std::string("/usr/local/lib/") + SNOWFLAKE_ADBC_LIB);
-	search_paths.push_back(std::string("/usr/lib/") + SNOWFLAKE_ADBC_LIB);
-#endif
-
-	// 4. Try just the filename - let the system search for it
-	search_paths.emplace_back(SNOWFLAKE_ADBC_LIB);
-
-	// Find the first existing driver
-	std::string driver_path;
-	for (const auto &path : search_paths) {
-		DPRINT("Checking for driver at: %s\n", path.c_str());
-		if (FileExists(path)) {
-			driver_path = path;
-			DPRINT("Found driver at: %s\n", driver_path.c_str());
-			break;
-		}
+void SnowflakeClient::InitializeConnection() {
+	// The database (and the loaded driver) is shared by every client using the same credentials
+	database = SnowflakeClientManager::GetInstance().GetDatabase(config);
+	auto new_session = make_shared_ptr<SnowflakeSession>(database);
+	RunWithRetry(
+	    config, "Snowflake login", [&]() { database->AcquireConnection(new_session->connection); },
+	    [&](SnowflakeErrorClass error_class) {
+		    if (error_class == SnowflakeErrorClass::SESSION_EXPIRED) {
+			    database->ClearIdleConnections();
+		    }
+	    });
+	{
+		std::lock_guard<std::mutex> lock(session_lock);
+		session = std::move(new_session);
 	}
+	connected = true;
+}
 
-	if (driver_path.empty()) {
-		// Driver not found - provide helpful error message
-		std::string error_msg =
-		    std::string("ADBC Snowflake driver (") + SNOWFLAKE_ADBC_LIB + ") not found. Searched locations:\n";
-		for (const auto &path : search_paths) {
-			error_msg += "  - " + path + "\n";
-		}
-
-		throw IOException(error_msg);
+shared_ptr<SnowflakeSession> SnowflakeClient::GetSession() {
+	statement_count++;
+	WaitForConnection();
+	std::lock_guard<std::mutex> lock(session_lock);
+	if (!session) {
+		throw IOException("Snowflake client is not connected");
 	}
+	return session;
+}
 
-	LOG_INFO("Extension directory: %s\n", extension_dir.c_str());
-	LOG_INFO("Final adbc driver path: %s\n", driver_path.c_str());
+void SnowflakeClient::Reconnect() {
+	WaitForConnection();
+	std::lock_guard<std::mutex> lock(reconnect_lock);
+	if (!database) {
+		InitializeConnection();
+		return;
+	}
+	DPRINT("Reconnecting Snowflake session\n");
+	// Idle sessions were opened around the same time and have most likely expired as well
+	database->ClearIdleConnections();
 
-	status = AdbcDatabaseSetOption(&database, "driver", driver_path.c_str(), &error);
-	CheckError(status, "Failed to set Snowflake driver path", &error);
+	auto new_session = make_shared_ptr<SnowflakeSession>(database);
+	database->AcquireConnection(new_session->connection);
 
-	// Set connection parameters
-	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.account", config.account.c_str(), &error);
-	CheckError(status, "Failed to set account", &error);
+	ClearPreparedStatements();
+	shared_ptr<SnowflakeSession> old_session;
+	{
+		std::lock_guard<std::mutex> lock(session_lock);
+		old_session = std::move(session);
+		session = std::move(new_session);
+	}
+	connected = true;
+	if (old_session) {
+		// The old session is dead anyway. Statements other threads still run on it keep it open until they are
+		// released, so it is closed by whoever lets go of it last.
+		old_session->discard = true;
+	}
+}
 
-	// Set authentication based on type
-	switch (config.auth_type) {
-	case SnowflakeAuthType::PASSWORD:
-		// Default auth type, set username and password
-		if (!config.username.empty()) {
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username", &error);
-		}
-		if (!config.password.empty()) {
-			status = AdbcDatabaseSetOption(&database, "password", config.password.c_str(), &error);
-			CheckError(status, "Failed to set password", &error);
-		}
-		break;
-	case SnowflakeAuthType::OAUTH:
-		// For External OAuth - use auth_oauth and provide token
-		LOG_DEBUG("Configuring OAuth authentication\n");
-
-		// Set auth_type to 'auth_oauth' - this is the correct ADBC parameter
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_oauth", &error);
-		CheckError(status, "Failed to set OAuth auth type", &error);
-		LOG_DEBUG("Set auth_type=auth_oauth\n");
-
-		// Set the OAuth token
-		if (!config.oauth_token.empty()) {
-			LOG_DEBUG("Setting token (length: %zu)\n", config.oauth_token.length());
-			status =
-			    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_token", config.oauth_token.c_str(), &error);
-			CheckError(status, "Failed to set OAuth token", &error);
-			LOG_DEBUG("Token set successfully\n");
-		}
+void SnowflakeClient::Disconnect() {
+	// Never release state underneath a background connect that is still running
+	try {
+		WaitForConnection();
+	} catch (...) {
+		// A failed connect leaves nothing to release
+	}
+	{
+		std::lock_guard<std::mutex> lock(connect_lock);
+		pending_connect = std::shared_future<void>();
+	}
+	if (!connected) {
+		return;
+	}
 
-		// Username may still be needed for user mapping
-		if (!config.username.empty()) {
-			LOG_DEBUG("Setting username: %s\n", config.username.c_str());
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username for OAuth", &error);
-		}
-		break;
-	case SnowflakeAuthType::KEY_PAIR:
-		// Key pair authentication with JWT
-		if (!config.username.empty()) {
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username", &error);
-		}
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_jwt", &error);
-		CheckError(status, "Failed to set key-pair auth type", &error);
-		if (!config.private_key.empty()) {
-			// Check if this is a file path by testing if the file exists
-			bool is_file_path = FileExists(config.private_key);
-
-			if (is_file_path) {
-				// Read the key file content
-				std::ifstream key_file(config.private_key);
-				if (!key_file.is_open()) {
-					throw IOException("Failed to open private key file: " + config.private_key);
-				}
-				std::string key_content((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
-				key_file.close();
-
-				// Use pkcs8_value for file content (supports both encrypted and unencrypted keys)
-				status =
-				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_value",
-				                          key_content.c_str(), &error);
-				CheckError(status, "Failed to set private key content", &error);
-			} else {
-				// Assume it's the key content directly (PEM format)
-				status =
-				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_value",
-				                          config.private_key.c_str(), &error);
-				CheckError(status, "Failed to set private key content", &error);
-			}
+	ClearPreparedStatements();
+	connected = false;
+	shared_ptr<SnowflakeSession> released;
+	{
+		std::lock_guard<std::mutex> lock(session_lock);
+		released = std::move(session);
+	}
+	if (released && discard_session) {
+		released->discard = true;
+	}
+	// Pooled or closed here, or when the last statement still using it is released
+	released.reset();
+	database.reset();
+}
 
-			// Set passphrase if provided (for encrypted keys)
-			if (!config.private_key_passphrase.empty()) {
-				status =
-				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_password",
-				                          config.private_key_passphrase.c_str(), &error);
-				CheckError(status, "Failed to set private key passphrase", &error);
-			}
-		}
-		break;
-	case SnowflakeAuthType::EXT_BROWSER:
-		// External browser SSO - username may be optional depending on SSO setup
-		if (!config.username.empty()) {
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username", &error);
-		}
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_ext_browser", &error);
-		CheckError(status, "Failed to set external browser auth type", &error);
-		break;
-	case SnowflakeAuthType::OKTA:
-		if (!config.username.empty()) {
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username", &error);
-		}
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_okta", &error);
-		CheckError(status, "Failed to set Okta auth type", &error);
-		if (!config.okta_url.empty()) {
-			status =
-			    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_okta_url", config.okta_url.c_str(), &error);
-			CheckError(status, "Failed to set Okta URL", &error);
-		}
-		break;
-	case SnowflakeAuthType::MFA:
-		if (!config.username.empty()) {
-			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
-			CheckError(status, "Failed to set username", &error);
-		}
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_mfa", &error);
-		CheckError(status, "Failed to set MFA auth type", &error);
-		if (!config.password.empty()) {
-			status = AdbcDatabaseSetOption(&database, "password", config.password.c_str(), &error);
-			CheckError(status, "Failed to set password for MFA", &error);
+unique_ptr<SnowflakePreparedStatement> SnowflakeClient::TakePreparedStatement(const string &key) {
+	std::lock_guard<std::mutex> lock(statement_cache_lock);
+	for (auto entry = statement_cache.begin(); entry != statement_cache.end(); entry++) {
+		if (entry->first == key) {
+			auto result = std::move(entry->second);
+			statement_cache.erase(entry);
+			DPRINT("Reusing prepared statement for %s\n", key.c_str());
+			return result;
 		}
-		break;
 	}
+	return nullptr;
+}
 
-	// Set optional parameters
-	if (!config.warehouse.empty()) {
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.warehouse", config.warehouse.c_str(), &error);
-		CheckError(status, "Failed to set warehouse", &error);
+void SnowflakeClient::CachePreparedStatement(const string &key, unique_ptr<SnowflakePreparedStatement> statement) {
+	if (!statement || !connected) {
+		return;
 	}
-
-	if (!config.database.empty()) {
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.database", config.database.c_str(), &error);
-		CheckError(status, "Failed to set database", &error);
+	{
+		std::lock_guard<std::mutex> lock(session_lock);
+		if (statement->session != session) {
+			return;
+		}
 	}
-
-	if (!config.role.empty()) {
-		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.role", config.role.c_str(), &error);
-		CheckError(status, "Failed to set role", &error);
+	unique_ptr<SnowflakePreparedStatement> evicted;
+	std::lock_guard<std::mutex> lock(statement_cache_lock);
+	for (auto &entry : statement_cache) {
+		if (entry.first == key) {
+			// Another scan of the same query got there first
+			return;
+		}
 	}
+	statement_cache.emplace_front(key, std::move(statement));
+	if (statement_cache.size() > STATEMENT_CACHE_SIZE) {
+		evicted = std::move(statement_cache.back().second);
+		statement_cache.pop_back();
+	}
+}
 
-	// Set query timeout
-	std::string timeout_str = std::to_string(config.query_timeout);
-	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_session_keep_alive",
-	                               config.keep_alive ? "true" : "false", &error);
-	CheckError(status, "Failed to set keep alive", &error);
-
-	// Set high precision mode (when false, DECIMAL(p,0) converts to INT64)
-	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.use_high_precision",
-	                               config.use_high_precision ? "true" : "false", &error);
-	CheckError(status, "Failed to set high precision mode", &error);
-
-	// Initialize the database
-	status = AdbcDatabaseInit(&database, &error);
-	CheckError(status, "Failed to initialize database", &error);
+void SnowflakeClient::ClearPreparedStatements() {
+	std::lock_guard<std::mutex> lock(statement_cache_lock);
+	statement_cache.clear();
 }
 
-void SnowflakeClient::InitializeConnection() {
-	AdbcError error;
-	std::memset(&error, 0, sizeof(error));
-	AdbcStatusCode status = AdbcConnectionNew(&connection, &error);
-	CheckError(status, "Failed to create connection", &error);
+bool SnowflakeClient::IsConnected() const {
+	return connected;
+}
 
-	status = AdbcConnectionInit(&connection, &database, &error);
-	CheckError(status, "Failed to initialize connection", &error);
+const SnowflakeConfig &SnowflakeClient::GetConfig() const {
+	return config;
 }
 
 bool SnowflakeClient::TestConnection() {
+	try {
+		WaitForConnection();
+	} catch (...) {
+		return false;
+	}
 	if (!IsConnected()) {
 		return false;
 	}
@@ -355,7 +244,13 @@ bool SnowflakeClient::TestConnection() {
 	std::memset(&error_obj, 0, sizeof(error_obj));
 	std::memset(&statement, 0, sizeof(statement));
 
-	AdbcStatusCode status = AdbcStatementNew(&connection, &statement, &error_obj);
+	shared_ptr<SnowflakeSession> current_session;
+	try {
+		current_session = GetSession();
+	} catch (...) {
+		return false;
+	}
+	AdbcStatusCode status = AdbcStatementNew(&current_session->connection, &statement, &error_obj);
 	if (status != ADBC_STATUS_OK) {
 		if (error_obj.release) {
 			error_obj.release(&error_obj);
@@ -426,9 +321,9 @@ void SnowflakeClient::CheckError(const AdbcStatusCode status, const std::string
 	throw IOException(error_message);
 }
 
-vector<string> SnowflakeClient::ListSchemas(ClientContext &context) {
+vector<string> SnowflakeClient::ListSchemas() {
 	const string schema_query = "SELECT schema_name FROM " + config.database + ".INFORMATION_SCHEMA.SCHEMATA";
-	auto result = ExecuteAndGetStrings(context, schema_query, {"schema_name"});
+	auto result = ExecuteAndGetStrings(schema_query, {"schema_name"});
 	auto schemas = result[0];
 
 	// Preserve original case from Snowflake (typically UPPERCASE)
@@ -437,14 +332,14 @@ vector<string> SnowflakeClient::ListSchemas(ClientContext &context) {
 	return schemas;
 }
 
-vector<string> SnowflakeClient::ListTables(ClientContext &context, const string &schema = "") {
+vector<string> SnowflakeClient::ListTables(const string &schema) {
 	DPRINT("ListTables called for schema: %s in database: %s\n", schema.c_str(), config.database.c_str());
 	const string upper_schema = StringUtil::Upper(schema);
 	const string table_name_query = "SELECT table_name FROM " + config.database + ".information_schema.tables" +
 	                                (!schema.empty() ? " WHERE table_schema = '" + upper_schema + "'" : "");
 	DPRINT("Table query: %s\n", table_name_query.c_str());
 
-	auto result = ExecuteAndGetStrings(context, table_name_query, {"table_name"});
+	auto result = ExecuteAndGetStrings(table_name_query, {"table_name"});
 	auto table_names = result[0];
 
 	// Preserve original case from Snowflake (typically UPPERCASE)
@@ -462,14 +357,18 @@ vector<SnowflakeColumn> SnowflakeClient::GetTableInfo(ClientContext &context, co
 	const string upper_schema = StringUtil::Upper(schema);
 	const string upper_table = StringUtil::Upper(table_name);
 
-	const string table_info_query = "SELECT COLUMN_NAME, DATA_TYPE, IS_NULLABLE FROM " + config.database +
-	                                ".information_schema.columns WHERE table_schema = '" + upper_schema +
-	                                "' AND table_name = '" + upper_table + "' ORDER BY ORDINAL_POSITION";
+	// Precision and scale are cast to text: only string columns are read from metadata results
+	const string table_info_query =
+	    "SELECT COLUMN_NAME, DATA_TYPE, IS_NULLABLE, NUMERIC_PRECISION::VARCHAR AS NUMERIC_PRECISION, "
+	    "NUMERIC_SCALE::VARCHAR AS NUMERIC_SCALE, DATETIME_PRECISION::VARCHAR AS DATETIME_PRECISION FROM " +
+	    config.database + ".information_schema.columns WHERE table_schema = '" + upper_schema +
+	    "' AND table_name = '" + upper_table + "' ORDER BY ORDINAL_POSITION";
 
 	DPRINT("GetTableInfo query: %s\n", table_info_query.c_str());
-	const vector<string> expected_names = {"COLUMN_NAME", "DATA_TYPE", "IS_NULLABLE"};
+	const vector<string> expected_names = {"COLUMN_NAME",   "DATA_TYPE",     "IS_NULLABLE",
+	                                       "NUMERIC_PRECISION", "NUMERIC_SCALE", "DATETIME_PRECISION"};
 
-	auto result = ExecuteAndGetStrings(context, table_info_query, expected_names);
+	auto result = ExecuteAndGetStrings(table_info_query, expected_names);
 
 	if (result.empty() || result[0].empty()) {
 		throw CatalogException("Cannot retrieve column information for table '%s.%s'. "
@@ -485,9 +384,19 @@ vector<SnowflakeColumn> SnowflakeClient::GetTableInfo(ClientContext &context, co
 		string column_name = result[0][row_idx];
 		string data_type = result[1][row_idx];
 		string nullable = result[2][row_idx];
+		const string &numeric_precision = result[3][row_idx];
+		const string &numeric_scale = result[4][row_idx];
+		const string &datetime_precision = result[5][row_idx];
+
+		// DATA_TYPE carries no parameters - add them back from the precision columns
+		if (!numeric_precision.empty()) {
+			data_type += "(" + numeric_precision + "," + (numeric_scale.empty() ? "0" : numeric_scale) + ")";
+		} else if (!datetime_precision.empty() && StringUtil::StartsWith(StringUtil::Upper(data_type), "TIMESTAMP")) {
+			data_type += "(" + datetime_precision + ")";
+		}
 
 		bool is_nullable = (nullable == "YES");
-		LogicalType duckdb_type = SnowflakeTypeToLogicalType(data_type);
+		LogicalType duckdb_type = SnowflakeTypeToLogicalType(data_type, config.use_high_precision, config.timestamp_ns);
 
 		SnowflakeColumn new_col = {column_name, duckdb_type, is_nullable};
 		col_data.emplace_back(new_col);
@@ -496,8 +405,186 @@ vector<SnowflakeColumn> SnowflakeClient::GetTableInfo(ClientContext &context, co
 	return col_data;
 }
 
-vector<vector<string>> SnowflakeClient::ExecuteAndGetStrings(ClientContext &context, const string &query,
+vector<string> SnowflakeClient::GetPrimaryKeyColumns(const string &schema, const string &table_name) {
+	const string primary_key_query = "SHOW PRIMARY KEYS IN TABLE " + config.database + "." +
+	                                 KeywordHelper::WriteQuoted(schema, '"') + "." +
+	                                 KeywordHelper::WriteQuoted(table_name, '"');
+	DPRINT("GetPrimaryKeyColumns query: %s\n", primary_key_query.c_str());
+	// SHOW returns created_on, database_name, schema_name, table_name, column_name, key_sequence, ...
+	auto result = ExecuteAndGetStrings(primary_key_query, {});
+	const idx_t column_name_index = 4;
+	if (result.size() <= column_name_index) {
+		return vector<string>();
+	}
+	return result[column_name_index];
+}
+
+vector<std::pair<string, string>> SnowflakeClient::GetColumnRanges(const string &schema, const string &table_name,
+                                                                  const vector<string> &column_names) {
+	string select_list;
+	for (auto &column_name : column_names) {
+		auto column = KeywordHelper::WriteQuoted(column_name, '"');
+		select_list += (select_list.empty() ? "" : ", ") + string("MIN(") + column + ")::VARCHAR, MAX(" + column +
+		               ")::VARCHAR";
+	}
+	const string range_query = "SELECT " + select_list + " FROM " + config.database + "." +
+	                           KeywordHelper::WriteQuoted(schema, '"') + "." +
+	                           KeywordHelper::WriteQuoted(table_name, '"');
+	DPRINT("GetColumnRanges query: %s\n", range_query.c_str());
+	auto result = ExecuteAndGetStrings(range_query, {});
+	vector<std::pair<string, string>> ranges;
+	for (idx_t i = 0; i < column_names.size(); i++) {
+		if (result.size() <= 2 * i + 1 || result[2 * i].empty()) {
+			ranges.emplace_back();
+			continue;
+		}
+		ranges.emplace_back(result[2 * i][0], result[2 * i + 1][0]);
+	}
+	return ranges;
+}
+
+int64_t SnowflakeClient::GetTableBytes(const string &schema, const string &table_name) {
+	const string bytes_query = "SELECT BYTES::VARCHAR AS BYTES FROM " + config.database +
+	                           ".information_schema.tables WHERE table_schema = '" + StringUtil::Upper(schema) +
+	                           "' AND table_name = '" + StringUtil::Upper(table_name) + "'";
+	DPRINT("GetTableBytes query: %s\n", bytes_query.c_str());
+	auto result = ExecuteAndGetStrings(bytes_query, {"BYTES"});
+	if (result.empty() || result[0].empty() || result[0][0].empty()) {
+		return -1;
+	}
+	return std::stoll(result[0][0]);
+}
+
+std::pair<string, string> SnowflakeClient::GetExpressionRange(const string &relation, const string &expression) {
+	const string range_query = "SELECT MIN(" + expression + ")::VARCHAR, MAX(" + expression + ")::VARCHAR FROM " +
+	                           relation;
+	DPRINT("GetExpressionRange query: %s\n", range_query.c_str());
+	auto result = ExecuteAndGetStrings(range_query, {});
+	if (result.size() < 2 || result[0].empty() || result[1].empty()) {
+		return std::pair<string, string>();
+	}
+	return std::make_pair(result[0][0], result[1][0]);
+}
+
+vector<string> SnowflakeClient::FindDuplicateKey(const string &relation, const vector<string> &column_names) {
+	string select_list;
+	string group_list;
+	string not_null;
+	for (auto &column_name : column_names) {
+		auto column = KeywordHelper::WriteQuoted(column_name, '"');
+		select_list += (select_list.empty() ? "" : ", ") + column + "::VARCHAR";
+		group_list += (group_list.empty() ? "" : ", ") + column;
+		not_null += (not_null.empty() ? "" : " AND ") + column + " IS NOT NULL";
+	}
+	const string duplicate_query = "SELECT " + select_list + " FROM " + relation + " WHERE " + not_null +
+	                               " GROUP BY " + group_list + " HAVING COUNT(*) > 1 LIMIT 1";
+	DPRINT("FindDuplicateKey query: %s\n", duplicate_query.c_str());
+	auto result = ExecuteAndGetStrings(duplicate_query, {});
+	vector<string> key;
+	for (auto &column : result) {
+		if (column.empty()) {
+			return vector<string>();
+		}
+		key.push_back(column[0]);
+	}
+	return key;
+}
+
+vector<std::pair<string, string>> SnowflakeClient::GetVariantKeys(const string &schema, const string &table_name,
+                                                                 const string &column_name, idx_t sample_rows) {
+	auto column = KeywordHelper::WriteQuoted(column_name, '"');
+	const string keys_query = "SELECT F.KEY, LISTAGG(DISTINCT TYPEOF(F.VALUE), ',') FROM (SELECT " + column +
+	                          " AS V FROM " + config.database + "." + KeywordHelper::WriteQuoted(schema, '"') + "." +
+	                          KeywordHelper::WriteQuoted(table_name, '"') + " SAMPLE (" + to_string(sample_rows) +
+	                          " ROWS) WHERE IS_OBJECT(" + column + ")) S, LATERAL FLATTEN(INPUT => S.V) F" +
+	                          " GROUP BY F.KEY ORDER BY F.KEY";
+	DPRINT("GetVariantKeys query: %s\n", keys_query.c_str());
+	auto result = ExecuteAndGetStrings(keys_query, {});
+	vector<std::pair<string, string>> keys;
+	if (result.size() < 2) {
+		return keys;
+	}
+	for (idx_t row = 0; row < result[0].size(); row++) {
+		keys.emplace_back(result[0][row], row < result[1].size() ? result[1][row] : string());
+	}
+	return keys;
+}
+
+string SnowflakeClient::GetQueryIdByTag(const string &query_tag) {
+	// The tag may carry the user's own tag, which can contain quotes and backslashes
+	auto quoted_tag = "'" + StringUtil::Replace(StringUtil::Replace(query_tag, "\\", "\\\\"), "'", "''") + "'";
+	const string query_id_query = "SELECT QUERY_ID FROM TABLE(" + config.database +
+	                              ".INFORMATION_SCHEMA.QUERY_HISTORY_BY_USER(RESULT_LIMIT => 10000)) WHERE QUERY_TAG = " +
+	                              quoted_tag + " AND EXECUTION_STATUS = 'SUCCESS' ORDER BY START_TIME DESC LIMIT 1";
+	auto result = ExecuteAndGetStrings(query_id_query, {"QUERY_ID"});
+	if (result.empty() || result[0].empty() || result[0][0].empty()) {
+		throw IOException("Could not find the Snowflake query tagged '%s' in the query history", query_tag);
+	}
+	return result[0][0];
+}
+
+string SnowflakeClient::GetLastQueryId() {
+	auto result = ExecuteAndGetStrings("SELECT LAST_QUERY_ID() AS QUERY_ID", {"QUERY_ID"});
+	if (result.empty() || result[0].empty()) {
+		return string();
+	}
+	return result[0][0];
+}
+
+string SnowflakeClient::GetLastQueryIdOf(idx_t statement_number) {
+	auto query_id = GetLastQueryId();
+	// Only the LAST_QUERY_ID query itself may have started since
+	if (statement_count != statement_number + 1) {
+		DPRINT("GetLastQueryIdOf: another statement ran on the session, query ID unknown\n");
+		return string();
+	}
+	return query_id;
+}
+
+vector<string> SnowflakeClient::GetTableVersions(const vector<string> &table_names) {
+	string query = "SELECT ";
+	vector<string> column_names;
+	for (idx_t i = 0; i < table_names.size(); i++) {
+		column_names.push_back("V" + std::to_string(i));
+		query += i > 0 ? ", " : "";
+		query += "TO_VARCHAR(SYSTEM$LAST_CHANGE_COMMIT_TIME(" + KeywordHelper::WriteQuoted(table_names[i], '\'') +
+		         ")) AS " + column_names.back();
+	}
+	auto result = ExecuteAndGetStrings(query, column_names);
+	vector<string> versions;
+	for (auto &column : result) {
+		if (column.empty()) {
+			throw IOException("Failed to read the versions of Snowflake tables");
+		}
+		versions.push_back(column[0]);
+	}
+	return versions;
+}
+
+string SnowflakeClient::GetCurrentTimestamp() {
+	auto result = ExecuteAndGetStrings(
+	    "SELECT TO_VARCHAR(CURRENT_TIMESTAMP(), 'YYYY-MM-DD HH24:MI:SS.FF9 TZH:TZM') AS CURRENT_TS", {"CURRENT_TS"});
+	if (result.empty() || result[0].empty()) {
+		throw IOException("Failed to read the current timestamp from Snowflake");
+	}
+	return result[0][0];
+}
+
+vector<vector<string>> SnowflakeClient::ExecuteAndGetStrings(const string &query,
                                                              const vector<string> &expected_col_names) {
+	// Metadata queries are read-only, so they can always be retried
+	return RunWithRetry(
+	    config, "Snowflake metadata query", [&]() { return ExecuteAndGetStringsOnce(query, expected_col_names); },
+	    [&](SnowflakeErrorClass error_class) {
+		    if (error_class == SnowflakeErrorClass::SESSION_EXPIRED) {
+			    Reconnect();
+		    }
+	    });
+}
+
+vector<vector<string>> SnowflakeClient::ExecuteAndGetStringsOnce(const string &query,
+                                                                 const vector<string> &expected_col_names) {
+	WaitForConnection();
 	if (!connected) {
 		throw IOException("Connection must be created before ListTables is called");
 	}
@@ -510,7 +597,8 @@ vector<vector<string>> SnowflakeClient::ExecuteAndGetStrings(ClientContext &cont
 
 	DPRINT("ExecuteAndGetStrings: Query='%s'\n", query.c_str());
 	DPRINT("About to create statement...\n");
-	status = AdbcStatementNew(GetConnection(), &statement, &error);
+	auto statement_session = GetSession();
+	status = AdbcStatementNew(&statement_session->connection, &statement, &error);
 	CheckError(status, "Failed to create AdbcStatement", &error);
 	DPRINT("Statement created successfully\n");
 
@@ -610,10 +698,86 @@ vector<vector<string>> SnowflakeClient::ExecuteAndGetStrings(ClientContext &cont
 	return results;
 }
 
+int64_t SnowflakeClient::ExecuteUpdate(const string &query) {
+	if (!IsIdempotentQuery(query)) {
+		// A statement with side effects may have been applied before the error reached us
+		return ExecuteUpdateOnce(query);
+	}
+	return RunWithRetry(
+	    config, "Snowflake statement", [&]() { return ExecuteUpdateOnce(query); },
+	    [&](SnowflakeErrorClass error_class) {
+		    if (error_class == SnowflakeErrorClass::SESSION_EXPIRED) {
+			    Reconnect();
+		    }
+	    });
+}
+
+void SnowflakeClient::SetAutoCommit(bool enabled) {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	auto current_session = GetSession();
+	auto status = AdbcConnectionSetOption(&current_session->connection, ADBC_CONNECTION_OPTION_AUTOCOMMIT,
+	                                      enabled ? ADBC_OPTION_VALUE_ENABLED : ADBC_OPTION_VALUE_DISABLED, &error);
+	CheckError(status, enabled ? "Failed to enable auto-commit" : "Failed to disable auto-commit", &error);
+	current_session->in_transaction = !enabled;
+}
+
+void SnowflakeClient::Commit() {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	CheckError(AdbcConnectionCommit(&GetSession()->connection, &error), "Failed to commit Snowflake transaction",
+	           &error);
+}
+
+void SnowflakeClient::Rollback() {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	CheckError(AdbcConnectionRollback(&GetSession()->connection, &error), "Failed to roll back Snowflake transaction",
+	           &error);
+}
+
+int64_t SnowflakeClient::ExecuteUpdateOnce(const string &query) {
+	WaitForConnection();
+	if (!connected) {
+		throw IOException("Connection must be created before ExecuteUpdate is called");
+	}
+
+	AdbcStatement statement;
+	std::memset(&statement, 0, sizeof(statement));
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+
+	DPRINT("ExecuteUpdate: Query='%s'\n", query.c_str());
+	auto statement_session = GetSession();
+	auto status = AdbcStatementNew(&statement_session->connection, &statement, &error);
+	CheckError(status, "Failed to create AdbcStatement", &error);
+
+	int64_t rows_affected = -1;
+	try {
+		status = AdbcStatementSetSqlQuery(&statement, query.c_str(), &error);
+		CheckError(status, "Failed to set AdbcStatement with SQL query: " + query, &error);
+
+		// No output stream: the driver executes the statement as an update and reports the row count
+		status = AdbcStatementExecuteQuery(&statement, nullptr, &rows_affected, &error);
+		CheckError(status, "Failed to execute SQL statement: " + query, &error);
+	} catch (...) {
+		AdbcStatementRelease(&statement, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+		throw;
+	}
+
+	CheckError(AdbcStatementRelease(&statement, &error), "Failed to release AdbcStatement", &error);
+	DPRINT("ExecuteUpdate: %lld rows affected\n", static_cast<long long>(rows_affected));
+	return rows_affected;
+}
+
 unique_ptr<DataChunk> SnowflakeClient::ExecuteAndGetChunk(ClientContext &context, const string &query,
                                                           const vector<LogicalType> &expected_types,
                                                           const vector<string> &expected_names) {
 	DPRINT("ExecuteAndGetChunk called with query: %s\n", query.c_str());
+	WaitForConnection();
 	if (!connected) {
 		DPRINT("ExecuteAndGetChunk: Not connected!\n");
 		throw IOException("Connection must be created before ExecuteAndGetChunk is called");
@@ -625,7 +789,8 @@ unique_ptr<DataChunk> SnowflakeClient::ExecuteAndGetChunk(ClientContext &context
 	AdbcStatusCode status;
 
 	DPRINT("Creating ADBC statement...\n");
-	status = AdbcStatementNew(GetConnection(), &statement, &error);
+	auto statement_session = GetSession();
+	status = AdbcStatementNew(&statement_session->connection, &statement, &error);
 	CheckError(status, "Failed to create AdbcStatement", &error);
 	DPRINT("ADBC statement created successfully\n");
 
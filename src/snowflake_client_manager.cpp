@@ -1,4 +1,5 @@
 #include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
 
 namespace duckdb {
 namespace snowflake {
@@ -9,10 +10,29 @@ SnowflakeClientManager &SnowflakeClientManager::GetInstance() {
 }
 
 shared_ptr<SnowflakeClient> SnowflakeClientManager::GetConnection(const SnowflakeConfig &config) {
-	std::lock_guard<std::mutex> lock(connection_mutex);
+	shared_ptr<SnowflakeClient> existing;
+	{
+		std::lock_guard<std::mutex> lock(connection_mutex);
+		auto it = connections.find(config);
+		if (it != connections.end()) {
+			existing = it->second;
+		}
+	}
+	if (existing) {
+		// An ATTACH with async_connect may still be logging in - wait for it outside the lock
+		try {
+			existing->WaitForConnection();
+		} catch (const std::exception &e) {
+			DPRINT("Pending Snowflake connection failed, reconnecting: %s\n", e.what());
+		}
+		if (existing->IsConnected()) {
+			return existing;
+		}
+	}
 
+	std::lock_guard<std::mutex> lock(connection_mutex);
 	auto it = connections.find(config);
-	if (it != connections.end() && it->second->IsConnected()) {
+	if (it != connections.end() && it->second != existing && it->second->IsConnected()) {
 		return it->second;
 	}
 
@@ -24,10 +44,45 @@ shared_ptr<SnowflakeClient> SnowflakeClientManager::GetConnection(const Snowflak
 	return connection;
 }
 
+shared_ptr<SnowflakeClient> SnowflakeClientManager::GetConnectionAsync(const SnowflakeConfig &config) {
+	std::lock_guard<std::mutex> lock(connection_mutex);
+
+	auto it = connections.find(config);
+	if (it != connections.end() && (it->second->IsConnected() || it->second->IsConnecting())) {
+		// Connect failures of a pending client surface on its first use
+		return it->second;
+	}
+
+	auto connection = make_shared_ptr<SnowflakeClient>();
+	connection->ConnectAsync(config);
+
+	connections[config] = connection;
+	return connection;
+}
+
 void SnowflakeClientManager::ReleaseConnection(const SnowflakeConfig &config) {
 	std::lock_guard<std::mutex> lock(connection_mutex);
 	connections.erase(config);
 }
 
+shared_ptr<SnowflakeDatabase> SnowflakeClientManager::GetDatabase(const SnowflakeConfig &config) {
+	std::lock_guard<std::mutex> lock(database_mutex);
+
+	auto it = databases.find(config);
+	if (it != databases.end()) {
+		return it->second;
+	}
+
+	auto database = make_shared_ptr<SnowflakeDatabase>(config);
+	databases[config] = database;
+	return database;
+}
+
+shared_ptr<SnowflakeClient> SnowflakeClientManager::CreateConnection(const SnowflakeConfig &config) {
+	auto connection = make_shared_ptr<SnowflakeClient>();
+	connection->Connect(config);
+	return connection;
+}
+
 } // namespace snowflake
 } // namespace duckdb
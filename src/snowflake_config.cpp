@@ -8,6 +8,49 @@
 namespace duckdb {
 namespace snowflake {
 
+static int32_t ParsePositiveOption(const std::string &name, const std::string &value) {
+	int32_t result;
+	try {
+		result = std::stoi(value);
+	} catch (const std::exception &) {
+		throw InvalidInputException("Invalid value for %s: '%s'. Expected a positive integer.", name, value);
+	}
+	if (result <= 0) {
+		throw InvalidInputException("Invalid value for %s: '%s'. Expected a positive integer.", name, value);
+	}
+	return result;
+}
+
+void SnowflakeFetchOptions::SetPrefetchConcurrency(const std::string &value) {
+	if (StringUtil::CIEquals(value, "auto")) {
+		auto_prefetch_concurrency = true;
+		prefetch_concurrency = 0;
+		return;
+	}
+	auto_prefetch_concurrency = false;
+	prefetch_concurrency = ParsePositiveOption("prefetch_concurrency", value);
+}
+
+void SnowflakeFetchOptions::SetResultQueueSize(const std::string &value) {
+	result_queue_size = ParsePositiveOption("result_queue_size", value);
+}
+
+int32_t SnowflakeFetchOptions::GetPrefetchConcurrency(uint64_t thread_count) const {
+	if (!auto_prefetch_concurrency) {
+		return prefetch_concurrency;
+	}
+	// One download per thread keeps every scanning thread fed without flooding the
+	// result stage with requests on very large machines
+	static constexpr uint64_t MAX_AUTO_PREFETCH_CONCURRENCY = 64;
+	if (thread_count < 1) {
+		thread_count = 1;
+	}
+	if (thread_count > MAX_AUTO_PREFETCH_CONCURRENCY) {
+		thread_count = MAX_AUTO_PREFETCH_CONCURRENCY;
+	}
+	return static_cast<int32_t>(thread_count);
+}
+
 SnowflakeConfig SnowflakeConfig::ParseConnectionString(const std::string &connection_string) {
 	SnowflakeConfig config;
 
@@ -64,6 +107,19 @@ SnowflakeConfig SnowflakeConfig::ParseConnectionString(const std::string &connec
 			config.keep_alive = (StringUtil::CIEquals(value, "true") || value == "1");
 		} else if (key == "use_high_precision") {
 			config.use_high_precision = (StringUtil::CIEquals(value, "true") || value == "1");
+		} else if (key == "timestamp_ns") {
+			config.timestamp_ns = (StringUtil::CIEquals(value, "true") || value == "1");
+		} else if (key == "max_retries") {
+			config.max_retries = std::stoi(value);
+		} else if (key == "retry_backoff_ms") {
+			config.retry_backoff_ms = std::stoi(value);
+		} else if (key == "prefetch_concurrency") {
+			config.fetch_options.SetPrefetchConcurrency(value);
+		} else if (key == "result_queue_size") {
+			config.fetch_options.SetResultQueueSize(value);
+		} else if (StringUtil::StartsWith(key, "session.")) {
+			// e.g. session.TIMEZONE=UTC
+			config.session_parameters[key.substr(8)] = value;
 		}
 	}
 
@@ -109,6 +165,20 @@ std::string SnowflakeConfig::ToString() const {
 	oss << "query_timeout=" << query_timeout << ";";
 	oss << "keep_alive=" << (keep_alive ? "true" : "false") << ";";
 	oss << "use_high_precision=" << (use_high_precision ? "true" : "false") << ";";
+	oss << "timestamp_ns=" << (timestamp_ns ? "true" : "false") << ";";
+	oss << "max_retries=" << max_retries << ";";
+	oss << "retry_backoff_ms=" << retry_backoff_ms << ";";
+	if (fetch_options.auto_prefetch_concurrency) {
+		oss << "prefetch_concurrency=auto;";
+	} else if (fetch_options.prefetch_concurrency > 0) {
+		oss << "prefetch_concurrency=" << fetch_options.prefetch_concurrency << ";";
+	}
+	if (fetch_options.result_queue_size > 0) {
+		oss << "result_queue_size=" << fetch_options.result_queue_size << ";";
+	}
+	for (const auto &entry : session_parameters) {
+		oss << "session." << entry.first << "=" << entry.second << ";";
+	}
 	return oss.str();
 }
 
@@ -117,7 +187,10 @@ bool SnowflakeConfig::operator==(const SnowflakeConfig &other) const {
 	        warehouse == other.warehouse && database == other.database && role == other.role &&
 	        auth_type == other.auth_type && oauth_token == other.oauth_token && private_key == other.private_key &&
 	        private_key_passphrase == other.private_key_passphrase && okta_url == other.okta_url &&
-	        query_timeout == other.query_timeout && keep_alive == other.keep_alive);
+	        query_timeout == other.query_timeout && keep_alive == other.keep_alive &&
+	        use_high_precision == other.use_high_precision && timestamp_ns == other.timestamp_ns &&
+	        max_retries == other.max_retries && retry_backoff_ms == other.retry_backoff_ms &&
+	        session_parameters == other.session_parameters);
 }
 
 } // namespace snowflake
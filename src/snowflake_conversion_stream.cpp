@@ -0,0 +1,361 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_conversion_stream.hpp"
+#include "snowflake_number_mapping.hpp"
+#include "snowflake_timestamp_conversion.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+namespace duckdb {
+namespace snowflake {
+
+void ReplaceArrowColumnTypes(ArrowTableSchema &arrow_table,
+                             const unordered_map<idx_t, shared_ptr<ArrowType>> &replacements) {
+	if (replacements.empty()) {
+		return;
+	}
+	auto &columns = arrow_table.GetColumns();
+	auto names = arrow_table.GetNames();
+	ArrowTableSchema result;
+	for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+		auto entry = replacements.find(col_idx);
+		result.AddColumn(col_idx, entry == replacements.end() ? columns.at(col_idx) : entry->second, names[col_idx]);
+	}
+	arrow_table = std::move(result);
+}
+
+// Arrow field metadata: int32 pair count, then int32-length-prefixed keys and values
+string GetArrowFieldMetadata(const char *metadata, const string &key) {
+	if (!metadata) {
+		return string();
+	}
+	auto read_int32 = [&]() {
+		int32_t value;
+		std::memcpy(&value, metadata, sizeof(value));
+		metadata += sizeof(value);
+		return value;
+	};
+	auto pair_count = read_int32();
+	for (int32_t i = 0; i < pair_count; i++) {
+		auto key_length = read_int32();
+		string entry_key(metadata, static_cast<size_t>(key_length));
+		metadata += key_length;
+		auto value_length = read_int32();
+		string entry_value(metadata, static_cast<size_t>(value_length));
+		metadata += value_length;
+		if (StringUtil::CIEquals(entry_key, key)) {
+			return entry_value;
+		}
+	}
+	return string();
+}
+
+bool IsValidArrowRow(const ArrowArray &array, idx_t row) {
+	auto validity = static_cast<const uint8_t *>(array.buffers[0]);
+	return !validity || (validity[row >> 3] >> (row & 7)) & 1;
+}
+
+//! Owns the converted values and the original column, whose validity buffer is shared
+struct SnowflakeConvertedColumn {
+	ArrowArray original;
+	unsafe_unique_array<data_t> data;
+	const void *buffers[2];
+};
+
+static void ConvertedColumnRelease(ArrowArray *array) {
+	if (!array->release) {
+		return;
+	}
+	auto column = reinterpret_cast<SnowflakeConvertedColumn *>(array->private_data);
+	if (column->original.release) {
+		column->original.release(&column->original);
+	}
+	delete column;
+	array->release = nullptr;
+}
+
+void ReplaceColumnData(ArrowArray &array, const void *validity, unsafe_unique_array<data_t> data) {
+	auto column = make_uniq<SnowflakeConvertedColumn>();
+	column->original = array;
+	column->data = std::move(data);
+	column->buffers[0] = validity;
+	column->buffers[1] = column->data.get();
+	// Converted values keep their position, so offset, length and null count stay as they are
+	array.n_buffers = 2;
+	array.buffers = column->buffers;
+	array.n_children = 0;
+	array.children = nullptr;
+	array.dictionary = nullptr;
+	array.private_data = column.release();
+	array.release = ConvertedColumnRelease;
+}
+
+//===--------------------------------------------------------------------===//
+// STRUCT assembly
+//===--------------------------------------------------------------------===//
+//! A STRUCT column whose fields are columns of the original batch
+struct SnowflakeAssembledStruct {
+	ArrowArray array;
+	unsafe_unique_array<data_t> validity;
+	const void *buffers[1];
+	vector<ArrowArray *> children;
+};
+
+//! Owns the original batch (and with it every column) and the assembled STRUCT columns
+struct SnowflakeAssembledBatch {
+	ArrowArray original;
+	vector<ArrowArray *> children;
+	vector<unique_ptr<SnowflakeAssembledStruct>> structs;
+};
+
+static void AssembledStructRelease(ArrowArray *array) {
+	// Owned by the batch
+	array->release = nullptr;
+}
+
+static void AssembledBatchRelease(ArrowArray *array) {
+	if (!array->release) {
+		return;
+	}
+	auto batch = reinterpret_cast<SnowflakeAssembledBatch *>(array->private_data);
+	if (batch->original.release) {
+		batch->original.release(&batch->original);
+	}
+	delete batch;
+	array->release = nullptr;
+}
+
+// A STRUCT over `fields` that is valid where the BOOLEAN column `flag` is true
+static unique_ptr<SnowflakeAssembledStruct> AssembleStruct(const ArrowArray &flag, vector<ArrowArray *> fields) {
+	if (flag.n_buffers != 2 || !flag.buffers[1]) {
+		throw InvalidInputException("Unexpected Arrow layout for the validity of a STRUCT column");
+	}
+	auto result = make_uniq<SnowflakeAssembledStruct>();
+	auto length = static_cast<idx_t>(flag.length);
+	result->validity = make_unsafe_uniq_array<data_t>((length + 7) / 8);
+	auto validity = result->validity.get();
+	auto values = static_cast<const uint8_t *>(flag.buffers[1]);
+	auto start = static_cast<idx_t>(flag.offset);
+	int64_t null_count = 0;
+	for (idx_t row = 0; row < length; row++) {
+		auto source_row = start + row;
+		bool valid = IsValidArrowRow(flag, source_row) && ((values[source_row >> 3] >> (source_row & 7)) & 1);
+		validity[row >> 3] |= static_cast<uint8_t>(valid) << (row & 7);
+		null_count += !valid;
+	}
+	result->buffers[0] = validity;
+	result->children = std::move(fields);
+
+	auto &array = result->array;
+	std::memset(&array, 0, sizeof(array));
+	array.length = flag.length;
+	array.null_count = null_count;
+	array.offset = 0;
+	array.n_buffers = 1;
+	array.buffers = result->buffers;
+	array.n_children = static_cast<int64_t>(result->children.size());
+	array.children = result->children.data();
+	array.release = AssembledStructRelease;
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// Conversion stream
+//===--------------------------------------------------------------------===//
+struct SnowflakeConversionStream {
+	SnowflakeConversionStream(ArrowArrayStream &inner_p, vector<SnowflakeColumnConversion> conversions_p,
+	                          vector<SnowflakeStructAssembly> assemblies_p)
+	    : inner(inner_p), conversions(std::move(conversions_p)), assemblies(std::move(assemblies_p)) {
+		std::memset(&inner_p, 0, sizeof(inner_p));
+	}
+
+	~SnowflakeConversionStream() {
+		if (inner.release) {
+			inner.release(&inner);
+		}
+	}
+
+	ArrowArrayStream inner;
+	vector<SnowflakeColumnConversion> conversions;
+	vector<SnowflakeStructAssembly> assemblies;
+	//! Child index of every conversion in the record batches, resolved from the first schema
+	vector<idx_t> child_indexes;
+	//! Child index of the validity column and of each field column of every assembly
+	vector<idx_t> flag_indexes;
+	vector<vector<idx_t>> field_indexes;
+	bool child_indexes_resolved = false;
+	string last_error;
+
+	void ResolveChildIndexes() {
+		ArrowSchema schema;
+		std::memset(&schema, 0, sizeof(schema));
+		if (inner.get_schema(&inner, &schema) != 0) {
+			const char *message = inner.get_last_error ? inner.get_last_error(&inner) : nullptr;
+			throw IOException("Failed to read the result schema: %s", message ? message : "unknown error");
+		}
+		child_indexes.assign(conversions.size(), DConstants::INVALID_INDEX);
+		flag_indexes.assign(assemblies.size(), DConstants::INVALID_INDEX);
+		field_indexes.clear();
+		for (auto &assembly : assemblies) {
+			field_indexes.emplace_back(assembly.field_columns.size(), DConstants::INVALID_INDEX);
+		}
+		for (int64_t child_idx = 0; child_idx < schema.n_children; child_idx++) {
+			auto name = schema.children[child_idx]->name;
+			if (!name) {
+				continue;
+			}
+			for (idx_t i = 0; i < conversions.size(); i++) {
+				if (conversions[i].column_name == name) {
+					child_indexes[i] = static_cast<idx_t>(child_idx);
+				}
+			}
+			for (idx_t i = 0; i < assemblies.size(); i++) {
+				if (assemblies[i].column_name == name) {
+					flag_indexes[i] = static_cast<idx_t>(child_idx);
+				}
+				for (idx_t field_idx = 0; field_idx < assemblies[i].field_columns.size(); field_idx++) {
+					if (assemblies[i].field_columns[field_idx] == name) {
+						field_indexes[i][field_idx] = static_cast<idx_t>(child_idx);
+					}
+				}
+			}
+		}
+		schema.release(&schema);
+		child_indexes_resolved = true;
+	}
+
+	void Convert(ArrowArray &batch) {
+		if (!child_indexes_resolved) {
+			ResolveChildIndexes();
+		}
+		for (idx_t i = 0; i < conversions.size(); i++) {
+			auto child_idx = child_indexes[i];
+			if (child_idx == DConstants::INVALID_INDEX || static_cast<int64_t>(child_idx) >= batch.n_children) {
+				// Not projected
+				continue;
+			}
+			auto &conversion = conversions[i];
+			auto &column = *batch.children[child_idx];
+			switch (conversion.layout) {
+			case SnowflakeColumnLayout::DECIMAL128:
+				ConvertDecimal128Column(column, conversion);
+				break;
+			default:
+				ConvertTimestampColumn(column, conversion);
+				break;
+			}
+		}
+		if (!assemblies.empty()) {
+			AssembleStructs(batch);
+		}
+	}
+
+	//! Replace the validity and field columns of every assembly with one STRUCT column
+	void AssembleStructs(ArrowArray &batch) {
+		unordered_map<idx_t, idx_t> assembly_at;
+		unordered_set<idx_t> field_columns;
+		for (idx_t i = 0; i < assemblies.size(); i++) {
+			auto flag_idx = flag_indexes[i];
+			if (flag_idx == DConstants::INVALID_INDEX || static_cast<int64_t>(flag_idx) >= batch.n_children) {
+				// Not projected
+				continue;
+			}
+			for (auto field_idx : field_indexes[i]) {
+				if (field_idx == DConstants::INVALID_INDEX || static_cast<int64_t>(field_idx) >= batch.n_children) {
+					throw InvalidInputException("The result is missing fields of STRUCT column %s",
+					                            assemblies[i].column_name);
+				}
+				field_columns.insert(field_idx);
+			}
+			assembly_at[flag_idx] = i;
+		}
+		if (assembly_at.empty()) {
+			return;
+		}
+		auto result = make_uniq<SnowflakeAssembledBatch>();
+		for (int64_t child_idx = 0; child_idx < batch.n_children; child_idx++) {
+			auto col_idx = static_cast<idx_t>(child_idx);
+			auto entry = assembly_at.find(col_idx);
+			if (entry != assembly_at.end()) {
+				vector<ArrowArray *> fields;
+				for (auto field_idx : field_indexes[entry->second]) {
+					fields.push_back(batch.children[field_idx]);
+				}
+				result->structs.push_back(AssembleStruct(*batch.children[child_idx], std::move(fields)));
+				result->children.push_back(&result->structs.back()->array);
+			} else if (field_columns.find(col_idx) == field_columns.end()) {
+				result->children.push_back(batch.children[child_idx]);
+			}
+		}
+		result->original = batch;
+		// Rows keep their position, so length, offset and the (absent) batch validity stay as they are
+		batch.n_children = static_cast<int64_t>(result->children.size());
+		batch.children = result->children.data();
+		batch.dictionary = nullptr;
+		batch.private_data = result.release();
+		batch.release = AssembledBatchRelease;
+	}
+};
+
+static SnowflakeConversionStream &GetConversionState(ArrowArrayStream *stream) {
+	return *reinterpret_cast<SnowflakeConversionStream *>(stream->private_data);
+}
+
+static int ConversionGetSchema(ArrowArrayStream *stream, ArrowSchema *out) {
+	// The batches no longer match the source formats of this schema, but DuckDB reads them with
+	// the types bound at bind time and does not consult it again
+	auto &state = GetConversionState(stream);
+	return state.inner.get_schema(&state.inner, out);
+}
+
+static int ConversionGetNext(ArrowArrayStream *stream, ArrowArray *out) {
+	auto &state = GetConversionState(stream);
+	int result = state.inner.get_next(&state.inner, out);
+	if (result != 0) {
+		const char *message = state.inner.get_last_error ? state.inner.get_last_error(&state.inner) : nullptr;
+		state.last_error = message ? message : "ArrowArrayStream returned error code " + std::to_string(result);
+		return result;
+	}
+	if (!out->release) {
+		// End of stream
+		return 0;
+	}
+	try {
+		state.Convert(*out);
+	} catch (std::exception &ex) {
+		out->release(out);
+		state.last_error = ErrorData(ex).RawMessage();
+		return EIO;
+	}
+	return 0;
+}
+
+static const char *ConversionGetLastError(ArrowArrayStream *stream) {
+	auto &state = GetConversionState(stream);
+	return state.last_error.c_str();
+}
+
+static void ConversionRelease(ArrowArrayStream *stream) {
+	if (!stream->release) {
+		return;
+	}
+	delete reinterpret_cast<SnowflakeConversionStream *>(stream->private_data);
+	stream->private_data = nullptr;
+	stream->release = nullptr;
+}
+
+void WrapConversionStream(ArrowArrayStream &stream, vector<SnowflakeColumnConversion> conversions,
+                          vector<SnowflakeStructAssembly> assemblies) {
+	auto state = new SnowflakeConversionStream(stream, std::move(conversions), std::move(assemblies));
+	stream.private_data = state;
+	stream.get_schema = ConversionGetSchema;
+	stream.get_next = ConversionGetNext;
+	stream.get_last_error = ConversionGetLastError;
+	stream.release = ConversionRelease;
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,467 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_database.hpp"
+#include "snowflake_client.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#define access _access
+#else
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace duckdb {
+namespace snowflake {
+
+// Helper function to check if a file exists
+static bool FileExists(const std::string &path) {
+#ifdef _WIN32
+	return (access(path.c_str(), 0) == 0);
+#else
+	struct stat buffer;
+	return (stat(path.c_str(), &buffer) == 0);
+#endif
+}
+
+// Get the directory where the current extension is located
+static std::string GetExtensionDirectory() {
+#ifdef _WIN32
+	HMODULE hModule = NULL;
+	// Get handle to the module containing this function
+	if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+	                      reinterpret_cast<LPCTSTR>(&GetExtensionDirectory), &hModule)) {
+		char path[MAX_PATH];
+		if (GetModuleFileNameA(hModule, path, sizeof(path))) {
+			std::string full_path(path);
+			// Find the last directory separator
+			size_t last_sep = full_path.find_last_of("/\\");
+			std::string dir = (last_sep != std::string::npos) ? full_path.substr(0, last_sep) : ".";
+
+			DPRINT("GetExtensionDirectory: module path = %s\n", path);
+			DPRINT("GetExtensionDirectory: parent_path = %s\n", dir.c_str());
+
+			return dir;
+		}
+	}
+	// Fallback to current directory
+	return ".";
+#else
+	Dl_info info;
+	// Use a function from this library to get its path
+	if (dladdr(reinterpret_cast<void *>(&GetExtensionDirectory), &info)) {
+		std::string path(info.dli_fname);
+		// Find the last directory separator
+		size_t last_sep = path.find_last_of("/\\");
+		std::string dir = (last_sep != std::string::npos) ? path.substr(0, last_sep) : ".";
+
+		DPRINT("GetExtensionDirectory: dli_fname = %s\n", info.dli_fname);
+		DPRINT("GetExtensionDirectory: parent_path = %s\n", dir.c_str());
+
+		return dir;
+	}
+	// Fallback to current directory
+	return ".";
+#endif
+}
+
+const string &SnowflakeDatabase::GetDriverPath() {
+	// The search probes several paths; only do it once per process. A failed
+	// search is not cached so that installing the driver later still works.
+	static std::mutex driver_lock;
+	static string driver_path;
+
+	std::lock_guard<std::mutex> lock(driver_lock);
+	if (!driver_path.empty()) {
+		return driver_path;
+	}
+
+	// Use ADBC driver manager to load the Snowflake driver dynamically
+	// Try multiple locations for the driver
+	std::vector<std::string> search_paths;
+
+	// 1. Try the extension directory (for packaged extensions with driver)
+	std::string extension_dir = GetExtensionDirectory();
+	search_paths.push_back(extension_dir + "/" + SNOWFLAKE_ADBC_LIB);
+
+	// 2. Check environment variable (for custom locations)
+	const char *env_path = std::getenv("SNOWFLAKE_ADBC_DRIVER_PATH");
+	if (env_path) {
+		search_paths.push_back(env_path);
+	}
+
+	// 3. Try system paths
+#ifdef _WIN32
+	search_paths.push_back(std::string("C:\\Windows\\System32\\") + SNOWFLAKE_ADBC_LIB);
+	search_paths.push_back(std::string("C:\\Program Files\\Snowflake\\") + SNOWFLAKE_ADBC_LIB);
+#else
+	search_paths.push_back(std::string("/usr/local/lib/") + SNOWFLAKE_ADBC_LIB);
+	search_paths.push_back(std::string("/usr/lib/") + SNOWFLAKE_ADBC_LIB);
+#endif
+
+	// 4. Try just the filename - let the system search for it
+	search_paths.emplace_back(SNOWFLAKE_ADBC_LIB);
+
+	// Find the first existing driver
+	for (const auto &path : search_paths) {
+		DPRINT("Checking for driver at: %s\n", path.c_str());
+		if (FileExists(path)) {
+			driver_path = path;
+			DPRINT("Found driver at: %s\n", driver_path.c_str());
+			break;
+		}
+	}
+
+	if (driver_path.empty()) {
+		// Driver not found - provide helpful error message
+		std::string error_msg =
+		    std::string("ADBC Snowflake driver (") + SNOWFLAKE_ADBC_LIB + ") not found. Searched locations:\n";
+		for (const auto &path : search_paths) {
+			error_msg += "  - " + path + "\n";
+		}
+
+		throw IOException(error_msg);
+	}
+
+	LOG_INFO("Extension directory: %s\n", extension_dir.c_str());
+	LOG_INFO("Final adbc driver path: %s\n", driver_path.c_str());
+	return driver_path;
+}
+
+SnowflakeDatabase::SnowflakeDatabase(const SnowflakeConfig &config) : config(config) {
+	std::memset(&database, 0, sizeof(database));
+	InitializeDatabase();
+}
+
+SnowflakeDatabase::~SnowflakeDatabase() {
+	ClearIdleConnections();
+
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	if (AdbcDatabaseRelease(&database, &error) != ADBC_STATUS_OK && error.release) {
+		error.release(&error);
+	}
+}
+
+void SnowflakeDatabase::InitializeDatabase() {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+
+	AdbcStatusCode status = AdbcDatabaseNew(&database, &error);
+	SnowflakeClient::CheckError(status, "Failed to create ADBC database", &error);
+
+	const auto &driver_path = GetDriverPath();
+	status = AdbcDatabaseSetOption(&database, "driver", driver_path.c_str(), &error);
+	SnowflakeClient::CheckError(status, "Failed to set Snowflake driver path", &error);
+
+	// Set connection parameters
+	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.account", config.account.c_str(), &error);
+	SnowflakeClient::CheckError(status, "Failed to set account", &error);
+
+	// Set authentication based on type
+	switch (config.auth_type) {
+	case SnowflakeAuthType::PASSWORD:
+		// Default auth type, set username and password
+		if (!config.username.empty()) {
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username", &error);
+		}
+		if (!config.password.empty()) {
+			status = AdbcDatabaseSetOption(&database, "password", config.password.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set password", &error);
+		}
+		break;
+	case SnowflakeAuthType::OAUTH:
+		// For External OAuth - use auth_oauth and provide token
+		LOG_DEBUG("Configuring OAuth authentication\n");
+
+		// Set auth_type to 'auth_oauth' - this is the correct ADBC parameter
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_oauth", &error);
+		SnowflakeClient::CheckError(status, "Failed to set OAuth auth type", &error);
+		LOG_DEBUG("Set auth_type=auth_oauth\n");
+
+		// Set the OAuth token
+		if (!config.oauth_token.empty()) {
+			LOG_DEBUG("Setting token (length: %zu)\n", config.oauth_token.length());
+			status =
+			    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_token", config.oauth_token.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set OAuth token", &error);
+			LOG_DEBUG("Token set successfully\n");
+		}
+
+		// Username may still be needed for user mapping
+		if (!config.username.empty()) {
+			LOG_DEBUG("Setting username: %s\n", config.username.c_str());
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username for OAuth", &error);
+		}
+		break;
+	case SnowflakeAuthType::KEY_PAIR:
+		// Key pair authentication with JWT
+		if (!config.username.empty()) {
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username", &error);
+		}
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_jwt", &error);
+		SnowflakeClient::CheckError(status, "Failed to set key-pair auth type", &error);
+		if (!config.private_key.empty()) {
+			// Check if this is a file path by testing if the file exists
+			bool is_file_path = FileExists(config.private_key);
+
+			if (is_file_path) {
+				// Read the key file content
+				std::ifstream key_file(config.private_key);
+				if (!key_file.is_open()) {
+					throw IOException("Failed to open private key file: " + config.private_key);
+				}
+				std::string key_content((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
+				key_file.close();
+
+				// Use pkcs8_value for file content (supports both encrypted and unencrypted keys)
+				status =
+				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_value",
+				                          key_content.c_str(), &error);
+				SnowflakeClient::CheckError(status, "Failed to set private key content", &error);
+			} else {
+				// Assume it's the key content directly (PEM format)
+				status =
+				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_value",
+				                          config.private_key.c_str(), &error);
+				SnowflakeClient::CheckError(status, "Failed to set private key content", &error);
+			}
+
+			// Set passphrase if provided (for encrypted keys)
+			if (!config.private_key_passphrase.empty()) {
+				status =
+				    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.jwt_private_key_pkcs8_password",
+				                          config.private_key_passphrase.c_str(), &error);
+				SnowflakeClient::CheckError(status, "Failed to set private key passphrase", &error);
+			}
+		}
+		break;
+	case SnowflakeAuthType::EXT_BROWSER:
+		// External browser SSO - username may be optional depending on SSO setup
+		if (!config.username.empty()) {
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username", &error);
+		}
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_ext_browser", &error);
+		SnowflakeClient::CheckError(status, "Failed to set external browser auth type", &error);
+		break;
+	case SnowflakeAuthType::OKTA:
+		if (!config.username.empty()) {
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username", &error);
+		}
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_okta", &error);
+		SnowflakeClient::CheckError(status, "Failed to set Okta auth type", &error);
+		if (!config.okta_url.empty()) {
+			status =
+			    AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_okta_url", config.okta_url.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set Okta URL", &error);
+		}
+		break;
+	case SnowflakeAuthType::MFA:
+		if (!config.username.empty()) {
+			status = AdbcDatabaseSetOption(&database, "username", config.username.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set username", &error);
+		}
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.auth_type", "auth_mfa", &error);
+		SnowflakeClient::CheckError(status, "Failed to set MFA auth type", &error);
+		if (!config.password.empty()) {
+			status = AdbcDatabaseSetOption(&database, "password", config.password.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set password for MFA", &error);
+		}
+		break;
+	}
+
+	// Set optional parameters
+	if (!config.warehouse.empty()) {
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.warehouse", config.warehouse.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set warehouse", &error);
+	}
+
+	if (!config.database.empty()) {
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.database", config.database.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set database", &error);
+	}
+
+	if (!config.role.empty()) {
+		status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.role", config.role.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set role", &error);
+	}
+
+	// Set query timeout
+	std::string timeout_str = std::to_string(config.query_timeout);
+	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_session_keep_alive",
+	                               config.keep_alive ? "true" : "false", &error);
+	SnowflakeClient::CheckError(status, "Failed to set keep alive", &error);
+
+	// Set high precision mode (when false, DECIMAL(p,0) converts to INT64)
+	status = AdbcDatabaseSetOption(&database, "adbc.snowflake.sql.client_option.use_high_precision",
+	                               config.use_high_precision ? "true" : "false", &error);
+	SnowflakeClient::CheckError(status, "Failed to set high precision mode", &error);
+
+	// Initialize the database
+	status = AdbcDatabaseInit(&database, &error);
+	SnowflakeClient::CheckError(status, "Failed to initialize database", &error);
+}
+
+void SnowflakeDatabase::AcquireConnection(AdbcConnection &connection) {
+	{
+		std::lock_guard<std::mutex> lock(pool_lock);
+		if (!idle_connections.empty()) {
+			connection = idle_connections.back();
+			idle_connections.pop_back();
+			DPRINT("Reusing idle Snowflake connection (%zu idle left)\n", idle_connections.size());
+			return;
+		}
+	}
+
+	// No idle session available - open (and authenticate) a new one
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	std::memset(&connection, 0, sizeof(connection));
+	AdbcStatusCode status = AdbcConnectionNew(&connection, &error);
+	SnowflakeClient::CheckError(status, "Failed to create connection", &error);
+
+	status = AdbcConnectionInit(&connection, &database, &error);
+	if (status != ADBC_STATUS_OK) {
+		AdbcError release_error;
+		std::memset(&release_error, 0, sizeof(release_error));
+		AdbcConnectionRelease(&connection, &release_error);
+		if (release_error.release) {
+			release_error.release(&release_error);
+		}
+	}
+	SnowflakeClient::CheckError(status, "Failed to initialize connection", &error);
+
+	try {
+		ApplySessionParameters(connection);
+	} catch (...) {
+		AdbcConnectionRelease(&connection, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+		throw;
+	}
+}
+
+// Numbers and booleans are passed as-is, anything else as a string literal
+static string FormatSessionParameterValue(const string &value) {
+	if (StringUtil::CIEquals(value, "true") || StringUtil::CIEquals(value, "false")) {
+		return value;
+	}
+	bool is_number = !value.empty();
+	for (idx_t i = 0; i < value.size(); i++) {
+		if (!StringUtil::CharacterIsDigit(value[i]) && !(i == 0 && value[i] == '-') && value[i] != '.') {
+			is_number = false;
+			break;
+		}
+	}
+	if (is_number) {
+		return value;
+	}
+	return "'" + StringUtil::Replace(value, "'", "''") + "'";
+}
+
+void SnowflakeDatabase::ApplySessionParameters(AdbcConnection &connection) {
+	if (config.session_parameters.empty()) {
+		return;
+	}
+	vector<string> assignments;
+	for (const auto &entry : config.session_parameters) {
+		assignments.push_back(entry.first + " = " + FormatSessionParameterValue(entry.second));
+	}
+	auto query = "ALTER SESSION SET " + StringUtil::Join(assignments, ", ");
+	DPRINT("Applying session parameters: %s\n", query.c_str());
+
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	AdbcStatement statement;
+	std::memset(&statement, 0, sizeof(statement));
+	AdbcStatusCode status = AdbcStatementNew(&connection, &statement, &error);
+	SnowflakeClient::CheckError(status, "Failed to create statement for session parameters", &error);
+
+	status = AdbcStatementSetSqlQuery(&statement, query.c_str(), &error);
+	if (status == ADBC_STATUS_OK) {
+		int64_t rows_affected = -1;
+		status = AdbcStatementExecuteQuery(&statement, nullptr, &rows_affected, &error);
+	}
+	AdbcError release_error;
+	std::memset(&release_error, 0, sizeof(release_error));
+	AdbcStatementRelease(&statement, &release_error);
+	if (release_error.release) {
+		release_error.release(&release_error);
+	}
+	SnowflakeClient::CheckError(status, "Failed to set session parameters", &error);
+}
+
+void SnowflakeDatabase::ResetSession(AdbcConnection &connection, bool in_transaction) {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	if (in_transaction) {
+		SnowflakeClient::CheckError(AdbcConnectionRollback(&connection, &error),
+		                            "Failed to roll back the transaction of a released session", &error);
+		SnowflakeClient::CheckError(AdbcConnectionSetOption(&connection, ADBC_CONNECTION_OPTION_AUTOCOMMIT,
+		                                                    ADBC_OPTION_VALUE_ENABLED, &error),
+		                            "Failed to enable auto-commit on a released session", &error);
+	}
+	ApplySessionParameters(connection);
+}
+
+void SnowflakeDatabase::ReleaseConnection(AdbcConnection &connection, bool in_transaction) {
+	try {
+		ResetSession(connection, in_transaction);
+	} catch (const std::exception &e) {
+		DPRINT("Closing a Snowflake session that could not be reset: %s\n", e.what());
+		try {
+			DiscardConnection(connection);
+		} catch (const std::exception &release_error) {
+			DPRINT("Releasing the connection failed: %s\n", release_error.what());
+		}
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(pool_lock);
+		if (idle_connections.size() < MAX_IDLE_CONNECTIONS) {
+			idle_connections.push_back(connection);
+			std::memset(&connection, 0, sizeof(connection));
+			return;
+		}
+	}
+	DiscardConnection(connection);
+}
+
+void SnowflakeDatabase::DiscardConnection(AdbcConnection &connection) {
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	AdbcStatusCode status = AdbcConnectionRelease(&connection, &error);
+	std::memset(&connection, 0, sizeof(connection));
+	SnowflakeClient::CheckError(status, "Failed to release ADBC connection", &error);
+}
+
+void SnowflakeDatabase::ClearIdleConnections() {
+	vector<AdbcConnection> to_release;
+	{
+		std::lock_guard<std::mutex> lock(pool_lock);
+		std::swap(to_release, idle_connections);
+	}
+	for (auto &connection : to_release) {
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		if (AdbcConnectionRelease(&connection, &error) != ADBC_STATUS_OK && error.release) {
+			error.release(&error);
+		}
+	}
+}
+
+} // namespace snowflake
+} // namespace duckdb
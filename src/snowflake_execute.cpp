@@ -0,0 +1,253 @@
+#include "snowflake_execute.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_secrets.hpp"
+
+#include <thread>
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeStatementResult RunSnowflakeStatement(const SnowflakeConfig &config, const string &sql,
+                                               bool user_statement) {
+	// A session of its own: the statement runs outside the DuckDB transaction and its LAST_QUERY_ID
+	// cannot be taken by a query of another thread
+	auto connection = SnowflakeClientManager::GetInstance().CreateConnection(config);
+	if (user_statement) {
+		// Whatever the statement did to the session (USE, ALTER SESSION, BEGIN, temporary tables) stays
+		// with it: it is not handed to other work
+		connection->DiscardSessionOnRelease();
+	}
+	SnowflakeStatementResult result;
+	result.rows_affected = connection->ExecuteUpdate(sql);
+	result.query_id = connection->GetLastQueryId();
+	DPRINT("RunSnowflakeStatement: query %s, %lld rows affected\n", result.query_id.c_str(),
+	       static_cast<long long>(result.rows_affected));
+	return result;
+}
+
+//! Jobs the registry holds at most, running or finished and not yet waited for
+static constexpr idx_t MAX_SNOWFLAKE_JOBS = 1024;
+//! How long a finished job is kept for snowflake_wait
+static constexpr std::chrono::hours SNOWFLAKE_JOB_RETENTION(1);
+
+SnowflakeJobRegistry &SnowflakeJobRegistry::GetInstance() {
+	static SnowflakeJobRegistry instance;
+	return instance;
+}
+
+SnowflakeJobRegistry::SnowflakeJobRegistry() {
+	// The jobs use the client manager until they are joined in the destructor, so it is created first and
+	// destroyed after the registry
+	SnowflakeClientManager::GetInstance();
+}
+
+SnowflakeJobRegistry::~SnowflakeJobRegistry() {
+	std::unordered_map<string, shared_ptr<SnowflakeJob>> remaining;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		remaining = std::move(jobs);
+	}
+	for (auto &entry : remaining) {
+		DPRINT("SnowflakeJobRegistry: waiting for job %s\n", entry.first.c_str());
+		JoinJob(*entry.second);
+	}
+}
+
+void SnowflakeJobRegistry::JoinJob(SnowflakeJob &job) {
+	if (job.thread.joinable()) {
+		job.thread.join();
+	}
+}
+
+string SnowflakeJobRegistry::Submit(const SnowflakeConfig &config, const string &sql) {
+	auto job_id = UUID::ToString(UUID::GenerateRandomUUID());
+	auto job = make_shared_ptr<SnowflakeJob>();
+	std::lock_guard<std::mutex> guard(lock);
+	ExpireJobs();
+	if (jobs.size() >= MAX_SNOWFLAKE_JOBS) {
+		throw InvalidInputException("Cannot submit more than %llu Snowflake jobs at a time, collect the running "
+		                            "ones with snowflake_wait first",
+		                            static_cast<unsigned long long>(MAX_SNOWFLAKE_JOBS));
+	}
+	// Started under the registry lock, so the thread is set before anyone else can see the job
+	job->thread = std::thread([job, config, sql]() {
+		SnowflakeStatementResult result;
+		ErrorData error;
+		try {
+			result = RunSnowflakeStatement(config, sql, true);
+		} catch (std::exception &ex) {
+			error = ErrorData(ex);
+		}
+		std::lock_guard<std::mutex> job_guard(job->lock);
+		job->result = std::move(result);
+		job->error = std::move(error);
+		job->finished = true;
+		job->finished_at = std::chrono::steady_clock::now();
+		job->finished_cv.notify_all();
+	});
+	jobs.emplace(job_id, job);
+	DPRINT("SnowflakeJobRegistry: submitted job %s\n", job_id.c_str());
+	return job_id;
+}
+
+void SnowflakeJobRegistry::ExpireJobs() {
+	auto now = std::chrono::steady_clock::now();
+	bool full = jobs.size() >= MAX_SNOWFLAKE_JOBS;
+	for (auto entry = jobs.begin(); entry != jobs.end();) {
+		bool expired;
+		{
+			auto &job = *entry->second;
+			std::lock_guard<std::mutex> guard(job.lock);
+			expired = job.finished && (full || now - job.finished_at >= SNOWFLAKE_JOB_RETENTION);
+		}
+		if (expired) {
+			DPRINT("SnowflakeJobRegistry: forgetting job %s\n", entry->first.c_str());
+			// Finished, so the thread is about to return
+			JoinJob(*entry->second);
+			entry = jobs.erase(entry);
+		} else {
+			++entry;
+		}
+	}
+}
+
+SnowflakeStatementResult SnowflakeJobRegistry::Wait(const string &job_id) {
+	shared_ptr<SnowflakeJob> job;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		auto entry = jobs.find(job_id);
+		if (entry == jobs.end()) {
+			throw InvalidInputException("Unknown Snowflake job '%s' (it has already been waited for, finished more "
+			                            "than an hour ago, or was submitted by another process)",
+			                            job_id);
+		}
+		job = entry->second;
+	}
+	{
+		std::unique_lock<std::mutex> guard(job->lock);
+		job->finished_cv.wait(guard, [&]() { return job->finished; });
+	}
+	// Collected once, whether the statement succeeded or not
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		jobs.erase(job_id);
+	}
+	JoinJob(*job);
+	if (job->error.HasError()) {
+		job->error.Throw();
+	}
+	return job->result;
+}
+
+struct SnowflakeExecuteBindData : public TableFunctionData {
+	SnowflakeConfig config;
+	string sql;
+	bool async = false;
+	//! snowflake_wait
+	string job_id;
+};
+
+struct SnowflakeExecuteGlobalState : public GlobalTableFunctionState {
+	bool finished = false;
+};
+
+static void SetResultColumns(vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"job_id", "query_id", "rows_affected"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT};
+}
+
+static void SetResultRow(DataChunk &output, const string &job_id, const SnowflakeStatementResult *result) {
+	output.SetValue(0, 0, job_id.empty() ? Value(LogicalType::VARCHAR) : Value(job_id));
+	if (result && !result->query_id.empty()) {
+		output.SetValue(1, 0, Value(result->query_id));
+	} else {
+		output.SetValue(1, 0, Value(LogicalType::VARCHAR));
+	}
+	if (result && result->rows_affected >= 0) {
+		output.SetValue(2, 0, Value::BIGINT(result->rows_affected));
+	} else {
+		output.SetValue(2, 0, Value(LogicalType::BIGINT));
+	}
+	output.SetCardinality(1);
+}
+
+static unique_ptr<FunctionData> SnowflakeExecuteBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<SnowflakeExecuteBindData>();
+	bind_data->sql = input.inputs[0].GetValue<string>();
+	auto profile = input.inputs[1].GetValue<string>();
+	try {
+		bind_data->config = SnowflakeSecretsHelper::GetCredentials(context, profile);
+	} catch (const std::exception &e) {
+		throw BinderException("Failed to retrieve credentials for profile '%s': %s", profile.c_str(), e.what());
+	}
+	for (auto &kv : input.named_parameters) {
+		if (StringUtil::Lower(kv.first) == "async") {
+			bind_data->async = BooleanValue::Get(kv.second);
+		}
+	}
+	SetResultColumns(return_types, names);
+	return std::move(bind_data);
+}
+
+static unique_ptr<FunctionData> SnowflakeWaitBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<SnowflakeExecuteBindData>();
+	bind_data->job_id = input.inputs[0].GetValue<string>();
+	SetResultColumns(return_types, names);
+	return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> SnowflakeExecuteInitGlobal(ClientContext &context,
+                                                                       TableFunctionInitInput &input) {
+	return make_uniq<SnowflakeExecuteGlobalState>();
+}
+
+static void SnowflakeExecuteFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<SnowflakeExecuteGlobalState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+	auto &bind_data = data.bind_data->Cast<SnowflakeExecuteBindData>();
+	if (bind_data.async) {
+		auto job_id = SnowflakeJobRegistry::GetInstance().Submit(bind_data.config, bind_data.sql);
+		SetResultRow(output, job_id, nullptr);
+		return;
+	}
+	auto result = RunSnowflakeStatement(bind_data.config, bind_data.sql, true);
+	SetResultRow(output, string(), &result);
+}
+
+static void SnowflakeWaitFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<SnowflakeExecuteGlobalState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+	auto &bind_data = data.bind_data->Cast<SnowflakeExecuteBindData>();
+	auto result = SnowflakeJobRegistry::GetInstance().Wait(bind_data.job_id);
+	SetResultRow(output, bind_data.job_id, &result);
+}
+
+} // namespace snowflake
+
+TableFunction GetSnowflakeExecuteFunction() {
+	TableFunction snowflake_execute("snowflake_execute", {LogicalType::VARCHAR, LogicalType::VARCHAR},
+	                                snowflake::SnowflakeExecuteFunction, snowflake::SnowflakeExecuteBind,
+	                                snowflake::SnowflakeExecuteInitGlobal);
+	snowflake_execute.named_parameters["async"] = LogicalType::BOOLEAN;
+	return snowflake_execute;
+}
+
+TableFunction GetSnowflakeWaitFunction() {
+	return TableFunction("snowflake_wait", {LogicalType::VARCHAR}, snowflake::SnowflakeWaitFunction,
+	                     snowflake::SnowflakeWaitBind, snowflake::SnowflakeExecuteInitGlobal);
+}
+
+} // namespace duckdb
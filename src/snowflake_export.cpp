@@ -0,0 +1,271 @@
+#include "snowflake_export.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_query_builder.hpp"
+#include "snowflake_secrets.hpp"
+
+#include <atomic>
+#include <future>
+
+namespace duckdb {
+namespace snowflake {
+
+static constexpr idx_t DEFAULT_EXPORT_PARTITIONS = 8;
+static constexpr idx_t MAX_EXPORT_PARTITIONS = STANDARD_VECTOR_SIZE;
+
+struct SnowflakeExportBindData : public TableFunctionData {
+	string table_name;
+	string directory;
+	string profile;
+	SnowflakeConfig config;
+	idx_t partitions = DEFAULT_EXPORT_PARTITIONS;
+	//! Snowflake expression the table is split on (empty: a hash of the whole row)
+	string partition_by;
+	//! Read all partitions at the same point in time
+	bool consistent = true;
+};
+
+//! One partition of the export and the file it was written to
+struct SnowflakeExportPartition {
+	string query;
+	string file;
+	int64_t rows = 0;
+};
+
+struct SnowflakeExportGlobalState : public GlobalTableFunctionState {
+	bool finished = false;
+};
+
+static unique_ptr<FunctionData> SnowflakeExportBind(ClientContext &context, TableFunctionBindInput &input,
+                                                    vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<SnowflakeExportBindData>();
+	bind_data->table_name = input.inputs[0].GetValue<string>();
+	bind_data->directory = input.inputs[1].GetValue<string>();
+	bind_data->profile = input.inputs[2].GetValue<string>();
+	try {
+		bind_data->config = SnowflakeSecretsHelper::GetCredentials(context, bind_data->profile);
+	} catch (const std::exception &e) {
+		throw BinderException("Failed to retrieve credentials for profile '%s': %s", bind_data->profile.c_str(),
+		                      e.what());
+	}
+	for (auto &kv : input.named_parameters) {
+		auto loption = StringUtil::Lower(kv.first);
+		if (loption == "partitions") {
+			auto partitions = kv.second.GetValue<int64_t>();
+			if (partitions < 1 || partitions > NumericCast<int64_t>(MAX_EXPORT_PARTITIONS)) {
+				throw BinderException("snowflake_export partitions must be between 1 and %llu",
+				                      static_cast<unsigned long long>(MAX_EXPORT_PARTITIONS));
+			}
+			bind_data->partitions = NumericCast<idx_t>(partitions);
+		} else if (loption == "partition_by") {
+			bind_data->partition_by = kv.second.GetValue<string>();
+		} else if (loption == "consistent") {
+			bind_data->consistent = BooleanValue::Get(kv.second);
+		}
+	}
+	names = {"partition", "file", "rows"};
+	return_types = {LogicalType::BIGINT, LogicalType::VARCHAR, LogicalType::BIGINT};
+	return std::move(bind_data);
+}
+
+//! Predicates that split the table into `partitions` disjoint parts covering all of its rows: ranges of
+//! `partition_by` if its values are integers, buckets of its hash otherwise
+static vector<string> GetPartitionPredicates(ClientContext &context, SnowflakeClient &connection,
+                                             const SnowflakeExportBindData &bind_data) {
+	auto partitions = bind_data.partitions;
+	vector<string> predicates;
+	if (partitions == 1) {
+		predicates.emplace_back();
+		return predicates;
+	}
+	if (!bind_data.partition_by.empty()) {
+		auto range = connection.GetExpressionRange(bind_data.table_name, bind_data.partition_by);
+		if (range.first.empty() || range.second.empty()) {
+			// No rows, or only NULLs
+			predicates.emplace_back();
+			return predicates;
+		}
+		Value min_value;
+		Value max_value;
+		if (Value(range.first).TryCastAs(context, LogicalType::BIGINT, min_value) &&
+		    Value(range.second).TryCastAs(context, LogicalType::BIGINT, max_value)) {
+			auto min = Hugeint::Convert(min_value.GetValue<int64_t>());
+			auto span = Hugeint::Convert(max_value.GetValue<int64_t>()) - min + Hugeint::Convert(1);
+			if (span < Hugeint::Convert(NumericCast<int64_t>(partitions))) {
+				partitions = NumericCast<idx_t>(Hugeint::Cast<int64_t>(span));
+			}
+			if (partitions == 1) {
+				// A single value: one partition with all rows
+				predicates.emplace_back();
+				return predicates;
+			}
+			// The first and last ranges are open, so rows outside the range seen here are exported too
+			auto &expression = bind_data.partition_by;
+			string lower;
+			for (idx_t i = 0; i < partitions; i++) {
+				string upper;
+				if (i + 1 < partitions) {
+					auto bound = min + span * Hugeint::Convert(NumericCast<int64_t>(i + 1)) /
+					                       Hugeint::Convert(NumericCast<int64_t>(partitions));
+					upper = Hugeint::ToString(bound);
+				}
+				string predicate;
+				if (lower.empty()) {
+					predicate = "(" + expression + " < " + upper + " OR " + expression + " IS NULL)";
+				} else if (upper.empty()) {
+					predicate = expression + " >= " + lower;
+				} else {
+					predicate = expression + " >= " + lower + " AND " + expression + " < " + upper;
+				}
+				predicates.push_back(std::move(predicate));
+				lower = std::move(upper);
+			}
+			return predicates;
+		}
+	}
+	// HASH of NULL is not NULL, so every row lands in one bucket
+	auto hashed = bind_data.partition_by.empty() ? string("*") : bind_data.partition_by;
+	for (idx_t i = 0; i < partitions; i++) {
+		predicates.push_back("MOD(ABS(HASH(" + hashed + ")), " + to_string(partitions) + ") = " + to_string(i));
+	}
+	return predicates;
+}
+
+//! Write the rows of `query` to a Parquet file through a DuckDB connection and a Snowflake session of its own,
+//! returning the row count
+static int64_t ExportPartition(DatabaseInstance &db, const string &profile, const string &query, const string &file) {
+	Connection connection(db);
+	auto copy = "COPY (SELECT * FROM snowflake_query(" + KeywordHelper::WriteQuoted(query, '\'') + ", " +
+	            KeywordHelper::WriteQuoted(profile, '\'') + ", own_session := true)) TO " +
+	            KeywordHelper::WriteQuoted(file, '\'') + " (FORMAT parquet)";
+	DPRINT("snowflake_export: %s\n", copy.c_str());
+	auto result = connection.Query(copy);
+	if (result->HasError()) {
+		result->ThrowError();
+	}
+	return result->GetValue(0, 0).GetValue<int64_t>();
+}
+
+static vector<SnowflakeExportPartition> RunExport(ClientContext &context, const SnowflakeExportBindData &bind_data) {
+	auto connection = SnowflakeClientManager::GetInstance().GetConnection(bind_data.config);
+	SnowflakeTimeTravel time_travel;
+	if (bind_data.consistent) {
+		time_travel = SnowflakeTimeTravel::AtTimestamp(connection->GetCurrentTimestamp());
+	}
+	auto base_query = SnowflakeQueryBuilder::BuildQuery(bind_data.table_name, vector<string>(), nullptr,
+	                                                    vector<string>(), nullptr, &time_travel);
+	auto predicates = GetPartitionPredicates(context, *connection, bind_data);
+
+	auto &fs = FileSystem::GetFileSystem(context);
+	if (!fs.DirectoryExists(bind_data.directory)) {
+		fs.CreateDirectory(bind_data.directory);
+	}
+	vector<SnowflakeExportPartition> partitions;
+	for (idx_t i = 0; i < predicates.size(); i++) {
+		SnowflakeExportPartition partition;
+		partition.query = predicates[i].empty() ? base_query : base_query + " WHERE " + predicates[i];
+		partition.file = fs.JoinPath(bind_data.directory, "data_" + to_string(i) + ".parquet");
+		partitions.push_back(std::move(partition));
+	}
+
+	// A pool of up to one worker per DuckDB thread takes the partitions in order, each fetching and writing
+	// one at a time through its own stream on a pooled session of its own (snowflake_query's own_session), so
+	// the workers never share an ADBC connection. After a failure no further partition is started.
+	auto &db = DatabaseInstance::GetDatabase(context);
+	auto thread_count = TaskScheduler::GetScheduler(context).NumberOfThreads();
+	auto worker_count = MinValue<idx_t>(partitions.size(), NumericCast<idx_t>(MaxValue<int32_t>(thread_count, 1)));
+	std::atomic<idx_t> next_partition(0);
+	std::atomic<bool> failed(false);
+	vector<ErrorData> errors(partitions.size());
+	auto profile = bind_data.profile;
+	auto run_worker = [&]() {
+		while (!failed) {
+			auto i = next_partition++;
+			if (i >= partitions.size()) {
+				return;
+			}
+			try {
+				partitions[i].rows = ExportPartition(db, profile, partitions[i].query, partitions[i].file);
+			} catch (std::exception &ex) {
+				errors[i] = ErrorData(ex);
+				failed = true;
+			}
+		}
+	};
+	vector<std::future<void>> workers;
+	try {
+		for (idx_t i = 0; i < worker_count; i++) {
+			workers.push_back(std::async(std::launch::async, run_worker));
+		}
+	} catch (...) {
+		// The workers that did start use the state above
+		failed = true;
+		for (auto &worker : workers) {
+			worker.wait();
+		}
+		throw;
+	}
+	// Wait for all of them before reporting the first failure, so no file is still being written
+	for (auto &worker : workers) {
+		worker.get();
+	}
+	ErrorData error;
+	idx_t failed_partition = 0;
+	for (idx_t i = 0; i < errors.size(); i++) {
+		if (errors[i].HasError()) {
+			error = errors[i];
+			failed_partition = i;
+			break;
+		}
+	}
+	if (error.HasError()) {
+		error.Throw(StringUtil::Format("Partition %llu of snowflake_export failed: ",
+		                               static_cast<unsigned long long>(failed_partition)));
+	}
+	return partitions;
+}
+
+static unique_ptr<GlobalTableFunctionState> SnowflakeExportInitGlobal(ClientContext &context,
+                                                                      TableFunctionInitInput &input) {
+	return make_uniq<SnowflakeExportGlobalState>();
+}
+
+static void SnowflakeExportFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<SnowflakeExportGlobalState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+	auto &bind_data = data.bind_data->Cast<SnowflakeExportBindData>();
+	auto partitions = RunExport(context, bind_data);
+	for (idx_t i = 0; i < partitions.size(); i++) {
+		output.SetValue(0, i, Value::BIGINT(NumericCast<int64_t>(i)));
+		output.SetValue(1, i, Value(partitions[i].file));
+		output.SetValue(2, i, Value::BIGINT(partitions[i].rows));
+	}
+	output.SetCardinality(partitions.size());
+}
+
+} // namespace snowflake
+
+TableFunction GetSnowflakeExportFunction() {
+	TableFunction snowflake_export("snowflake_export",
+	                               {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR},
+	                               snowflake::SnowflakeExportFunction, snowflake::SnowflakeExportBind,
+	                               snowflake::SnowflakeExportInitGlobal);
+	snowflake_export.named_parameters["partitions"] = LogicalType::BIGINT;
+	snowflake_export.named_parameters["partition_by"] = LogicalType::VARCHAR;
+	snowflake_export.named_parameters["consistent"] = LogicalType::BOOLEAN;
+	return snowflake_export;
+}
+
+} // namespace duckdb
@@ -15,6 +15,12 @@
 #include "duckdb/catalog/catalog.hpp"
 #include "duckdb/catalog/catalog_transaction.hpp"
 #include "snowflake_secret_provider.hpp"
+#include "snowflake_path_pushdown.hpp"
+#include "snowflake_schema_cache.hpp"
+#include "snowflake_scan_prefetch.hpp"
+#include "snowflake_execute.hpp"
+#include "snowflake_query_batch.hpp"
+#include "snowflake_export.hpp"
 
 namespace duckdb {
 
@@ -43,10 +49,43 @@ static void LoadInternal(ExtensionLoader &loader) {
 	// available)
 	auto snowflake_scan_function = GetSnowflakeScanFunction();
 	loader.RegisterFunction(std::move(snowflake_scan_function));
+	loader.RegisterFunction(GetSnowflakeQueryBatchFunction());
+	// Statements that return no rows, optionally submitted in the background
+	loader.RegisterFunction(GetSnowflakeExecuteFunction());
+	loader.RegisterFunction(GetSnowflakeWaitFunction());
+	// Tables written to local Parquet files as concurrently fetched partitions
+	loader.RegisterFunction(GetSnowflakeExportFunction());
 
 	// Register storage extension (only available when ADBC is available)
 	auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
 	config.storage_extensions["snowflake"] = make_uniq<snowflake::SnowflakeStorageExtension>();
+	// Fetch JSON paths of semi-structured columns instead of whole documents
+	config.optimizer_extensions.push_back(snowflake::GetSnowflakePathPushdownExtension());
+	// Submit the queries of all Snowflake scans of a plan when the first one starts, once per distinct query
+	config.optimizer_extensions.push_back(snowflake::GetSnowflakeScanPrefetchExtension());
+	config.AddExtensionOption("snowflake_prefetch_scans",
+	                          "Submit the queries of all Snowflake scans of a query when the first of them starts, on "
+	                          "sessions of their own",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("snowflake_share_scans",
+	                          "Run a remote query that several Snowflake scans of a query run once, and let all of "
+	                          "them read its result",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("snowflake_reuse_results",
+	                          "Read the persisted result of an identical earlier scan of unchanged Snowflake tables "
+	                          "with RESULT_SCAN instead of running the query again",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("snowflake_schema_cache_ttl",
+	                          "Seconds snowflake_query reuses the result schema of a query it has bound before "
+	                          "(0 disables the cache)",
+	                          LogicalType::UBIGINT,
+	                          Value::UBIGINT(snowflake::SnowflakeSchemaCache::DEFAULT_TTL_SECONDS));
+#ifdef SNOWFLAKE_TEST_HOOKS
+	config.AddExtensionOption("snowflake_inject_stream_failure",
+	                          "Testing only: make the result stream of each resumable Snowflake scan fail once after "
+	                          "this many rows, so that it is resumed via RESULT_SCAN (0 disables)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+#endif
 #else
 	// ADBC not available - register a placeholder function that throws an error
 	auto snowflake_scan_function =
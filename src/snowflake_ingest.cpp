@@ -0,0 +1,170 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_ingest.hpp"
+
+#include "duckdb/common/arrow/arrow_converter.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeIngestWriter::SnowflakeIngestWriter(shared_ptr<SnowflakeClient> connection_p, SnowflakeIngestTarget target_p,
+                                             vector<LogicalType> types_p, vector<string> names_p,
+                                             ClientProperties properties_p)
+    : connection(std::move(connection_p)), target(std::move(target_p)), types(std::move(types_p)),
+      names(std::move(names_p)), properties(std::move(properties_p)) {
+	ingest_thread = std::thread([this]() { RunIngest(); });
+}
+
+SnowflakeIngestWriter::~SnowflakeIngestWriter() {
+	if (ingest_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			aborted = true;
+		}
+		batch_available.notify_all();
+		ingest_thread.join();
+	}
+	for (auto &batch : queue) {
+		if (batch.release) {
+			batch.release(&batch);
+		}
+	}
+}
+
+void SnowflakeIngestWriter::Write(ArrowArray &batch) {
+	std::unique_lock<std::mutex> guard(lock);
+	space_available.wait(guard, [&]() { return queue.size() < MAX_QUEUED_BATCHES || done; });
+	if (done) {
+		// The driver stopped reading before the end of the data
+		batch.release(&batch);
+		throw IOException("Failed to ingest into Snowflake table %s: %s", target.ToString(),
+		                  error_message.empty() ? "ingest statement ended early" : error_message);
+	}
+	queue.push_back(batch);
+	batch.release = nullptr;
+	batch_available.notify_one();
+}
+
+idx_t SnowflakeIngestWriter::Finish() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		finished = true;
+	}
+	batch_available.notify_all();
+	if (ingest_thread.joinable()) {
+		ingest_thread.join();
+	}
+	if (!error_message.empty()) {
+		throw IOException("Failed to ingest into Snowflake table %s: %s", target.ToString(), error_message);
+	}
+	DPRINT("Ingested %llu rows into %s\n", static_cast<unsigned long long>(rows_written), target.ToString().c_str());
+	return rows_written;
+}
+
+void SnowflakeIngestWriter::RunIngest() {
+	ArrowArrayStream stream;
+	std::memset(&stream, 0, sizeof(stream));
+	stream.private_data = this;
+	stream.get_schema = GetSchema;
+	stream.get_next = GetNext;
+	stream.get_last_error = GetLastError;
+	stream.release = Release;
+
+	AdbcStatement statement;
+	std::memset(&statement, 0, sizeof(statement));
+	bool statement_initialized = false;
+	AdbcError error;
+	std::memset(&error, 0, sizeof(error));
+	shared_ptr<SnowflakeSession> session;
+	try {
+		session = connection->GetSession();
+		auto status = AdbcStatementNew(&session->connection, &statement, &error);
+		SnowflakeClient::CheckError(status, "Failed to create ingest statement", &error);
+		statement_initialized = true;
+
+		status = AdbcStatementSetOption(&statement, "adbc.ingest.target_table", target.table.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set ingest target table", &error);
+		status = AdbcStatementSetOption(&statement, "adbc.ingest.target_db_schema", target.schema.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set ingest target schema", &error);
+		status = AdbcStatementSetOption(&statement, "adbc.ingest.target_catalog", target.database.c_str(), &error);
+		SnowflakeClient::CheckError(status, "Failed to set ingest target database", &error);
+		status = AdbcStatementSetOption(&statement, "adbc.ingest.mode", "adbc.ingest.mode.append", &error);
+		SnowflakeClient::CheckError(status, "Failed to set ingest mode", &error);
+
+		// The statement takes ownership of the stream and pulls batches from it while executing
+		status = AdbcStatementBindStream(&statement, &stream, &error);
+		SnowflakeClient::CheckError(status, "Failed to bind ingest stream", &error);
+
+		int64_t rows_affected = -1;
+		status = AdbcStatementExecuteQuery(&statement, nullptr, &rows_affected, &error);
+		SnowflakeClient::CheckError(status, "Failed to execute ingest", &error);
+	} catch (std::exception &ex) {
+		std::lock_guard<std::mutex> guard(lock);
+		error_message = ErrorData(ex).RawMessage();
+	}
+
+	if (stream.release) {
+		stream.release(&stream);
+	}
+	if (statement_initialized) {
+		AdbcStatementRelease(&statement, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		done = true;
+	}
+	space_available.notify_all();
+}
+
+int SnowflakeIngestWriter::GetSchema(ArrowArrayStream *stream, ArrowSchema *out) {
+	auto &writer = *reinterpret_cast<SnowflakeIngestWriter *>(stream->private_data);
+	try {
+		ArrowConverter::ToArrowSchema(out, writer.types, writer.names, writer.properties);
+	} catch (std::exception &ex) {
+		std::lock_guard<std::mutex> guard(writer.lock);
+		writer.error_message = ErrorData(ex).RawMessage();
+		return EIO;
+	}
+	return 0;
+}
+
+int SnowflakeIngestWriter::GetNext(ArrowArrayStream *stream, ArrowArray *out) {
+	auto &writer = *reinterpret_cast<SnowflakeIngestWriter *>(stream->private_data);
+	std::unique_lock<std::mutex> guard(writer.lock);
+	writer.batch_available.wait(guard,
+	                            [&]() { return !writer.queue.empty() || writer.finished || writer.aborted; });
+	if (writer.aborted) {
+		// Fail the statement so a partially written insert is not loaded
+		writer.error_message = "ingest was cancelled";
+		return EIO;
+	}
+	if (writer.queue.empty()) {
+		// End of stream
+		std::memset(out, 0, sizeof(*out));
+		return 0;
+	}
+	*out = writer.queue.front();
+	writer.queue.pop_front();
+	writer.rows_written += static_cast<idx_t>(out->length);
+	writer.space_available.notify_one();
+	return 0;
+}
+
+const char *SnowflakeIngestWriter::GetLastError(ArrowArrayStream *stream) {
+	auto &writer = *reinterpret_cast<SnowflakeIngestWriter *>(stream->private_data);
+	return writer.error_message.c_str();
+}
+
+void SnowflakeIngestWriter::Release(ArrowArrayStream *stream) {
+	// The writer outlives the stream; only mark it as released
+	stream->release = nullptr;
+}
+
+} // namespace snowflake
+} // namespace duckdb
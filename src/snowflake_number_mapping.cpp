@@ -0,0 +1,321 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_number_mapping.hpp"
+#include "snowflake_conversion_stream.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/decimal.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include "duckdb/function/table/arrow/arrow_type_info.hpp"
+
+#include <cmath>
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeNumberMapping ParseNumberMapping(const string &option, const string &value) {
+	if (StringUtil::CIEquals(value, "decimal")) {
+		return SnowflakeNumberMapping::DECIMAL;
+	}
+	if (StringUtil::CIEquals(value, "double")) {
+		return SnowflakeNumberMapping::DOUBLE;
+	}
+	if (StringUtil::CIEquals(value, "narrow")) {
+		return SnowflakeNumberMapping::NARROW;
+	}
+	if (StringUtil::CIEquals(value, "hugeint")) {
+		return SnowflakeNumberMapping::HUGEINT;
+	}
+	throw InvalidInputException("Invalid value for %s: '%s'. Expected 'decimal', 'double', 'narrow' or 'hugeint'.",
+	                            option, value);
+}
+
+string NumberMappingToString(SnowflakeNumberMapping mapping) {
+	switch (mapping) {
+	case SnowflakeNumberMapping::DOUBLE:
+		return "double";
+	case SnowflakeNumberMapping::NARROW:
+		return "narrow";
+	case SnowflakeNumberMapping::HUGEINT:
+		return "hugeint";
+	default:
+		return "decimal";
+	}
+}
+
+void SnowflakeNumberPolicy::ParseColumnMappings(const Value &value) {
+	if (value.IsNull()) {
+		return;
+	}
+	if (value.type().id() != LogicalTypeId::MAP) {
+		throw InvalidInputException(
+		    "number_column_mapping must be a MAP, e.g. MAP {'ORDERS.O_TOTALPRICE': 'double', 'QUANTITY': 'narrow'}");
+	}
+	for (auto &entry : MapValue::GetChildren(value)) {
+		auto &key_value = StructValue::GetChildren(entry);
+		column_mappings[key_value[0].ToString()] =
+		    ParseNumberMapping("number_column_mapping", key_value[1].ToString());
+	}
+}
+
+SnowflakeNumberMapping SnowflakeNumberPolicy::GetMapping(const string &table_name, const string &column_name) const {
+	auto entry = column_mappings.find(table_name + "." + column_name);
+	if (entry != column_mappings.end()) {
+		return entry->second;
+	}
+	entry = column_mappings.find(column_name);
+	if (entry != column_mappings.end()) {
+		return entry->second;
+	}
+	return default_mapping;
+}
+
+bool SnowflakeNumberPolicy::UsesNarrow() const {
+	if (default_mapping == SnowflakeNumberMapping::NARROW) {
+		return true;
+	}
+	for (auto &entry : column_mappings) {
+		if (entry.second == SnowflakeNumberMapping::NARROW) {
+			return true;
+		}
+	}
+	return false;
+}
+
+LogicalType GetNumberType(SnowflakeNumberMapping mapping, uint8_t width, uint8_t scale) {
+	width = MaxValue<uint8_t>(MaxValue<uint8_t>(width, scale), 1);
+	switch (mapping) {
+	case SnowflakeNumberMapping::DOUBLE:
+		return LogicalType::DOUBLE;
+	case SnowflakeNumberMapping::HUGEINT:
+		return scale == 0 ? LogicalType::HUGEINT : LogicalType::DECIMAL(width, scale);
+	case SnowflakeNumberMapping::NARROW:
+		if (scale == 0) {
+			if (width <= 2) {
+				return LogicalType::TINYINT;
+			}
+			if (width <= 4) {
+				return LogicalType::SMALLINT;
+			}
+			if (width <= 9) {
+				return LogicalType::INTEGER;
+			}
+			if (width <= 18) {
+				return LogicalType::BIGINT;
+			}
+			return LogicalType::HUGEINT;
+		}
+		// Round up to the widest precision of the DuckDB storage type, so small changes to the
+		// data do not overflow the type chosen at bind time
+		if (width <= 4) {
+			return LogicalType::DECIMAL(4, scale);
+		}
+		if (width <= 9) {
+			return LogicalType::DECIMAL(9, scale);
+		}
+		if (width <= 18) {
+			return LogicalType::DECIMAL(18, scale);
+		}
+		return LogicalType::DECIMAL(width, scale);
+	default:
+		return LogicalType::DECIMAL(width, scale);
+	}
+}
+
+uint8_t GetUnscaledWidth(const string &value, uint8_t scale) {
+	if (value.empty()) {
+		return 0;
+	}
+	// Significant digits before the decimal point, plus the scale digits of the unscaled value
+	idx_t integer_digits = 0;
+	bool leading = true;
+	for (auto c : value) {
+		if (c == '.' || c == 'e' || c == 'E') {
+			break;
+		}
+		if (!StringUtil::CharacterIsDigit(c) || (leading && c == '0')) {
+			continue;
+		}
+		leading = false;
+		integer_digits++;
+	}
+	return static_cast<uint8_t>(MinValue<idx_t>(integer_digits + scale, Decimal::MAX_WIDTH_DECIMAL));
+}
+
+bool IsDecimal128Column(const ArrowType &type) {
+	// Arrow decimals always carry an ArrowDecimalInfo
+	if (type.GetDuckType().id() != LogicalTypeId::DECIMAL) {
+		return false;
+	}
+	return type.GetTypeInfo<ArrowDecimalInfo>().GetBitWidth() == DecimalBitWidth::DECIMAL_128;
+}
+
+// The Arrow decimal width a DECIMAL target is delivered in: decimal32 up to 9 digits (DuckDB stores
+// DECIMAL(<= 4, s) as int16 when it reads it), decimal64 up to 18 digits, decimal128 beyond
+static DecimalBitWidth GetDecimalBitWidth(const LogicalType &target_type) {
+	auto width = DecimalType::GetWidth(target_type);
+	if (width <= Decimal::MAX_WIDTH_INT32) {
+		return DecimalBitWidth::DECIMAL_32;
+	}
+	if (width <= Decimal::MAX_WIDTH_INT64) {
+		return DecimalBitWidth::DECIMAL_64;
+	}
+	return DecimalBitWidth::DECIMAL_128;
+}
+
+static shared_ptr<ArrowType> GetTargetArrowType(const LogicalType &target_type) {
+	if (target_type.id() != LogicalTypeId::DECIMAL) {
+		return make_shared_ptr<ArrowType>(target_type);
+	}
+	return make_shared_ptr<ArrowType>(target_type, make_uniq<ArrowDecimalInfo>(GetDecimalBitWidth(target_type)));
+}
+
+vector<SnowflakeColumnConversion> ApplyNumberTypes(ArrowTableSchema &arrow_table,
+                                                   const unordered_map<idx_t, LogicalType> &target_types) {
+	vector<SnowflakeColumnConversion> conversions;
+	unordered_map<idx_t, shared_ptr<ArrowType>> replacements;
+	auto &columns = arrow_table.GetColumns();
+	auto &names = arrow_table.GetNames();
+	for (auto &entry : target_types) {
+		auto col_idx = entry.first;
+		auto &arrow_type = *columns.at(col_idx);
+		auto &target_type = entry.second;
+		if (!IsDecimal128Column(arrow_type) || target_type == arrow_type.GetDuckType()) {
+			continue;
+		}
+		DPRINT("Reading NUMBER column %s as %s\n", names[col_idx].c_str(), target_type.ToString().c_str());
+		replacements[col_idx] = GetTargetArrowType(target_type);
+		if (target_type.InternalType() == PhysicalType::INT128) {
+			// decimal128 and hugeint_t share their little-endian layout, the buffer is read as it is
+			continue;
+		}
+		auto scale = DecimalType::GetScale(arrow_type.GetDuckType());
+		conversions.push_back(
+		    SnowflakeColumnConversion {names[col_idx], SnowflakeColumnLayout::DECIMAL128, target_type, scale});
+	}
+	ReplaceArrowColumnTypes(arrow_table, replacements);
+	return conversions;
+}
+
+//===--------------------------------------------------------------------===//
+// Conversion kernels
+//===--------------------------------------------------------------------===//
+// Arrow decimal128 values are little-endian two's complement, the layout of hugeint_t
+static_assert(sizeof(hugeint_t) == 16, "decimal128 values are read as hugeint_t");
+
+// Narrow decimal128 values into T. The loop has no branches so the compiler can vectorize it;
+// values outside [min_value, max_value] are only searched for when the range check fails.
+template <class T>
+static bool NarrowDecimal128(const ArrowArray &array, const hugeint_t *source, T *target, int64_t min_value,
+                             int64_t max_value, idx_t &failed_row) {
+	auto start = static_cast<idx_t>(array.offset);
+	auto end = start + static_cast<idx_t>(array.length);
+	bool in_range = true;
+	for (idx_t row = start; row < end; row++) {
+		auto lower = static_cast<int64_t>(source[row].lower);
+		// The upper half of a value that fits in 64 bits only repeats the sign of the lower half
+		in_range &= (source[row].upper == (lower >> 63)) & (lower >= min_value) & (lower <= max_value);
+		target[row] = static_cast<T>(lower);
+	}
+	if (in_range) {
+		return true;
+	}
+	for (idx_t row = start; row < end; row++) {
+		auto lower = static_cast<int64_t>(source[row].lower);
+		if (source[row].upper == (lower >> 63) && lower >= min_value && lower <= max_value) {
+			continue;
+		}
+		if (IsValidArrowRow(array, row)) {
+			failed_row = row - start;
+			return false;
+		}
+	}
+	return true;
+}
+
+static void Decimal128ToDouble(const ArrowArray &array, const hugeint_t *source, double *target, uint8_t scale) {
+	auto divisor = std::pow(10.0, static_cast<double>(scale));
+	auto start = static_cast<idx_t>(array.offset);
+	auto end = start + static_cast<idx_t>(array.length);
+	for (idx_t row = start; row < end; row++) {
+		// Adding the halves as doubles cancels out negative values whose lower half rounds to 2^64
+		target[row] = Hugeint::Cast<double>(source[row]) / divisor;
+	}
+}
+
+template <class T>
+static bool NarrowToLimits(const ArrowArray &array, const hugeint_t *source, data_ptr_t target, idx_t &failed_row) {
+	return NarrowDecimal128<T>(array, source, reinterpret_cast<T *>(target), NumericLimits<T>::Minimum(),
+	                           NumericLimits<T>::Maximum(), failed_row);
+}
+
+template <class T>
+static bool NarrowToWidth(const ArrowArray &array, const hugeint_t *source, data_ptr_t target, uint8_t width,
+                          idx_t &failed_row) {
+	int64_t max_value = 1;
+	for (uint8_t i = 0; i < width; i++) {
+		max_value *= 10;
+	}
+	max_value--;
+	return NarrowDecimal128<T>(array, source, reinterpret_cast<T *>(target), -max_value, max_value, failed_row);
+}
+
+// Bytes per value of the Arrow array a column is converted into
+static idx_t GetTargetValueSize(const LogicalType &target_type) {
+	if (target_type.id() == LogicalTypeId::DECIMAL) {
+		return GetDecimalBitWidth(target_type) == DecimalBitWidth::DECIMAL_32 ? sizeof(int32_t) : sizeof(int64_t);
+	}
+	return GetTypeIdSize(target_type.InternalType());
+}
+
+void ConvertDecimal128Column(ArrowArray &array, const SnowflakeColumnConversion &conversion) {
+	if (array.n_buffers != 2 || !array.buffers[1]) {
+		throw InvalidInputException("Expected a decimal128 array for column %s", conversion.column_name);
+	}
+	auto &target_type = conversion.target_type;
+	auto source = static_cast<const hugeint_t *>(array.buffers[1]);
+	// Converted values keep their position, so the offset and the validity buffer stay valid
+	auto row_count = static_cast<idx_t>(array.offset + array.length);
+	auto buffer = make_unsafe_uniq_array_uninitialized<data_t>(row_count * GetTargetValueSize(target_type));
+	auto data = buffer.get();
+
+	bool success = true;
+	idx_t failed_row = 0;
+	switch (target_type.id()) {
+	case LogicalTypeId::TINYINT:
+		success = NarrowToLimits<int8_t>(array, source, data, failed_row);
+		break;
+	case LogicalTypeId::SMALLINT:
+		success = NarrowToLimits<int16_t>(array, source, data, failed_row);
+		break;
+	case LogicalTypeId::INTEGER:
+		success = NarrowToLimits<int32_t>(array, source, data, failed_row);
+		break;
+	case LogicalTypeId::BIGINT:
+		success = NarrowToLimits<int64_t>(array, source, data, failed_row);
+		break;
+	case LogicalTypeId::DECIMAL:
+		if (GetDecimalBitWidth(target_type) == DecimalBitWidth::DECIMAL_32) {
+			success = NarrowToWidth<int32_t>(array, source, data, DecimalType::GetWidth(target_type), failed_row);
+		} else {
+			success = NarrowToWidth<int64_t>(array, source, data, DecimalType::GetWidth(target_type), failed_row);
+		}
+		break;
+	case LogicalTypeId::DOUBLE:
+		Decimal128ToDouble(array, source, reinterpret_cast<double *>(data), conversion.scale);
+		break;
+	default:
+		throw InternalException("Unsupported NUMBER conversion target %s", target_type.ToString());
+	}
+	if (!success) {
+		throw ConversionException(
+		    "Value of Snowflake column %s in row %llu of a result batch does not fit in %s, the type chosen for it "
+		    "from the column's value range at bind time. Re-attach to read the new range, or read the column with "
+		    "number_mapping 'decimal'.",
+		    conversion.column_name, static_cast<unsigned long long>(failed_row), target_type.ToString());
+	}
+	ReplaceColumnData(array, array.buffers[0], std::move(buffer));
+}
+
+} // namespace snowflake
+} // namespace duckdb
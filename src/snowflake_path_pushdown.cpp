@@ -0,0 +1,424 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_path_pushdown.hpp"
+#include "snowflake_conversion_stream.hpp"
+#include "snowflake_scan.hpp"
+
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table/arrow/arrow_type_info.hpp"
+#include "duckdb/parser/expression/case_expression.hpp"
+#include "duckdb/parser/expression/cast_expression.hpp"
+#include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/planner/logical_operator_visitor.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+
+#include <cstring>
+
+namespace duckdb {
+namespace snowflake {
+
+//===--------------------------------------------------------------------===//
+// Paths
+//===--------------------------------------------------------------------===//
+bool ParseJSONPath(const Value &path, vector<Value> &steps) {
+	steps.clear();
+	if (path.IsNull()) {
+		return false;
+	}
+	if (path.type().IsIntegral()) {
+		auto index = path.GetValue<int64_t>();
+		if (index < 0) {
+			return false;
+		}
+		steps.push_back(Value::BIGINT(index));
+		return true;
+	}
+	if (path.type().id() != LogicalTypeId::VARCHAR) {
+		return false;
+	}
+	auto &text = StringValue::Get(path);
+	if (text.empty() || text[0] == '/') {
+		return false;
+	}
+	if (text[0] != '$') {
+		// A plain key, dots included
+		steps.push_back(Value(text));
+		return true;
+	}
+	idx_t pos = 1;
+	while (pos < text.size()) {
+		if (text[pos] == '.') {
+			pos++;
+			if (pos < text.size() && text[pos] == '"') {
+				auto end = text.find('"', pos + 1);
+				if (end == string::npos) {
+					return false;
+				}
+				steps.push_back(Value(text.substr(pos + 1, end - pos - 1)));
+				pos = end + 1;
+				continue;
+			}
+			auto end = MinValue<idx_t>(text.find_first_of(".[", pos), text.size());
+			auto key = text.substr(pos, end - pos);
+			if (key.empty() || key == "*") {
+				return false;
+			}
+			steps.push_back(Value(key));
+			pos = end;
+		} else if (text[pos] == '[') {
+			auto end = text.find(']', pos);
+			// [*], [#-1] and indexes beyond BIGINT are evaluated by DuckDB
+			if (end == string::npos || end == pos + 1 || end - pos - 1 > 18) {
+				return false;
+			}
+			int64_t index = 0;
+			for (idx_t i = pos + 1; i < end; i++) {
+				if (!StringUtil::CharacterIsDigit(text[i])) {
+					return false;
+				}
+				index = index * 10 + (text[i] - '0');
+			}
+			steps.push_back(Value::BIGINT(index));
+			pos = end + 1;
+		} else {
+			return false;
+		}
+	}
+	return !steps.empty();
+}
+
+static unique_ptr<ParsedExpression> MakeFunction(const string &name, unique_ptr<ParsedExpression> argument) {
+	vector<unique_ptr<ParsedExpression>> children;
+	children.push_back(std::move(argument));
+	return make_uniq<FunctionExpression>(name, std::move(children));
+}
+
+unique_ptr<ParsedExpression> BuildPathExpression(const string &column_name, const vector<Value> &steps,
+                                                 bool as_text) {
+	unique_ptr<ParsedExpression> value = make_uniq<ColumnRefExpression>(column_name);
+	for (auto &step : steps) {
+		// NULL where the value is not an object (for a key) or not an array (for an index)
+		bool is_key = step.type().id() == LogicalTypeId::VARCHAR;
+		vector<unique_ptr<ParsedExpression>> get_arguments;
+		get_arguments.push_back(MakeFunction(is_key ? "as_object" : "as_array", std::move(value)));
+		get_arguments.push_back(make_uniq<ConstantExpression>(step));
+		value = make_uniq<FunctionExpression>("get", std::move(get_arguments));
+	}
+	if (!as_text) {
+		return MakeFunction("to_json", std::move(value));
+	}
+	auto result = make_uniq<CaseExpression>();
+	CaseCheck string_check;
+	string_check.when_expr = MakeFunction("is_varchar", value->Copy());
+	string_check.then_expr = make_uniq<CastExpression>(LogicalType::VARCHAR, value->Copy());
+	result->case_checks.push_back(std::move(string_check));
+	CaseCheck null_check;
+	null_check.when_expr = MakeFunction("is_null_value", value->Copy());
+	null_check.then_expr = make_uniq<ConstantExpression>(Value());
+	result->case_checks.push_back(std::move(null_check));
+	result->else_expr = MakeFunction("to_json", std::move(value));
+	return std::move(result);
+}
+
+//===--------------------------------------------------------------------===//
+// Result schema
+//===--------------------------------------------------------------------===//
+//! A result schema with fields inserted into those of the original schema, which it owns
+struct SnowflakeAppendedSchema {
+	ArrowSchema original;
+	vector<ArrowSchema *> children;
+	vector<unique_ptr<ArrowSchema>> fields;
+	vector<unique_ptr<string>> names;
+};
+
+static void AppendedFieldRelease(ArrowSchema *schema) {
+	schema->release = nullptr;
+}
+
+static void AppendedSchemaRelease(ArrowSchema *schema) {
+	if (!schema->release) {
+		return;
+	}
+	auto appended = reinterpret_cast<SnowflakeAppendedSchema *>(schema->private_data);
+	if (appended->original.release) {
+		appended->original.release(&appended->original);
+	}
+	delete appended;
+	schema->release = nullptr;
+}
+
+// DuckDB's arrow scan names the projected columns by the schema child at their index, so every
+// column added to a bound scan needs a field at the column's index. Fields of shredded columns, which
+// follow the result columns (ApplyStructAssemblies), stay behind the new fields.
+static void InsertStringFields(ArrowSchema &schema, idx_t position, const vector<string> &names) {
+	auto appended = make_uniq<SnowflakeAppendedSchema>();
+	appended->original = schema;
+	for (idx_t child_idx = 0; child_idx < position; child_idx++) {
+		appended->children.push_back(schema.children[child_idx]);
+	}
+	for (auto &name : names) {
+		appended->names.push_back(make_uniq<string>(name));
+		auto field = make_uniq<ArrowSchema>();
+		std::memset(field.get(), 0, sizeof(ArrowSchema));
+		field->format = "u";
+		field->name = appended->names.back()->c_str();
+		field->flags = ARROW_FLAG_NULLABLE;
+		field->release = AppendedFieldRelease;
+		appended->children.push_back(field.get());
+		appended->fields.push_back(std::move(field));
+	}
+	for (auto child_idx = static_cast<int64_t>(position); child_idx < schema.n_children; child_idx++) {
+		appended->children.push_back(schema.children[child_idx]);
+	}
+	schema.n_children = static_cast<int64_t>(appended->children.size());
+	schema.children = appended->children.data();
+	schema.private_data = appended.release();
+	schema.release = AppendedSchemaRelease;
+}
+
+static bool IsSemiStructuredColumn(const ArrowSchema &field) {
+	auto logical_type = GetArrowFieldMetadata(field.metadata, "logicalType");
+	if (logical_type.empty()) {
+		logical_type = GetArrowFieldMetadata(field.metadata, "DATA_TYPE");
+	}
+	auto upper_type = StringUtil::Upper(logical_type);
+	return upper_type == "VARIANT" || upper_type == "OBJECT" || upper_type == "ARRAY";
+}
+
+//===--------------------------------------------------------------------===//
+// Plan rewrite
+//===--------------------------------------------------------------------===//
+//! Replaces path extractions over the columns of one scan by extra scan columns
+class SnowflakePathRewriter {
+public:
+	SnowflakePathRewriter(LogicalGet &get, SnowflakeScanBindData &bind_data) : get(get), bind_data(bind_data) {
+	}
+
+	void Rewrite(unique_ptr<Expression> &expr) {
+		if (TryRewrite(expr)) {
+			return;
+		}
+		ExpressionIterator::EnumerateChildren(*expr, [&](unique_ptr<Expression> &child) { Rewrite(child); });
+	}
+
+	bool HasPaths() const {
+		return !paths.empty();
+	}
+
+	//! Add the path columns to the scan; source columns not in `referenced` (output bindings) are
+	//! fetched as NULL
+	void Apply(const unordered_set<idx_t> &referenced) {
+		auto &factory = *bind_data.factory;
+		auto expansions = make_shared_ptr<column_expansion_map_t>();
+		if (factory.column_expansions) {
+			for (auto &entry : *factory.column_expansions) {
+				(*expansions)[entry.first] = entry.second.Copy();
+			}
+		}
+		vector<string> field_names;
+		for (auto &path : paths) {
+			path.expression->alias = path.name;
+			(*expansions)[path.name].select_list.push_back(std::move(path.expression));
+			field_names.push_back(path.name);
+		}
+		auto names = bind_data.arrow_table.GetNames();
+		for (auto binding_idx : source_bindings) {
+			auto col_idx = GetColumnIndex(binding_idx);
+			// Filters of a scan are keyed by table column
+			if (referenced.count(binding_idx) || get.table_filters.filters.count(col_idx)) {
+				continue;
+			}
+			DPRINT("Path pushdown: fetching %s as NULL\n", names[col_idx].c_str());
+			auto null_value = make_uniq<CastExpression>(LogicalType::VARCHAR, make_uniq<ConstantExpression>(Value()));
+			null_value->alias = names[col_idx];
+			(*expansions)[names[col_idx]].select_list.push_back(std::move(null_value));
+		}
+		factory.column_expansions = std::move(expansions);
+		auto first_path_column = bind_data.arrow_table.GetColumns().size() - paths.size();
+		InsertStringFields(bind_data.schema_root.arrow_schema, first_path_column, field_names);
+	}
+
+private:
+	struct PathColumn {
+		//! Source column, function and path
+		string key;
+		//! Result column name
+		string name;
+		unique_ptr<ParsedExpression> expression;
+		idx_t binding_idx;
+	};
+
+	idx_t GetColumnIndex(idx_t binding_idx) const {
+		auto column_pos = get.projection_ids.empty() ? binding_idx : get.projection_ids[binding_idx];
+		return get.GetColumnIds()[column_pos].GetPrimaryIndex();
+	}
+
+	bool TryRewrite(unique_ptr<Expression> &expr) {
+		if (expr->GetExpressionClass() != ExpressionClass::BOUND_FUNCTION) {
+			return false;
+		}
+		auto &function = expr->Cast<BoundFunctionExpression>();
+		// The JSON extension registers each function under its aliases
+		auto &function_name = function.function.name;
+		bool as_text;
+		if (function_name == "json_extract_string" || function_name == "json_extract_path_text" ||
+		    function_name == "->>") {
+			as_text = true;
+		} else if (function_name == "json_extract" || function_name == "json_extract_path" || function_name == "->") {
+			as_text = false;
+		} else {
+			return false;
+		}
+		if (function.children.size() != 2 ||
+		    function.children[0]->GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF ||
+		    function.children[1]->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+			return false;
+		}
+		auto &column_ref = function.children[0]->Cast<BoundColumnRefExpression>();
+		if (column_ref.binding.table_index != get.table_index) {
+			return false;
+		}
+		auto binding_idx = column_ref.binding.column_index;
+		auto column_pos = get.projection_ids.empty() ? binding_idx : get.projection_ids[binding_idx];
+		auto &column_id = get.GetColumnIds()[column_pos];
+		auto &schema = bind_data.schema_root.arrow_schema;
+		if (column_id.IsRowIdColumn() || column_id.GetPrimaryIndex() >= static_cast<idx_t>(schema.n_children) ||
+		    !IsSemiStructuredColumn(*schema.children[column_id.GetPrimaryIndex()])) {
+			return false;
+		}
+		auto &path = function.children[1]->Cast<BoundConstantExpression>().value;
+		vector<Value> steps;
+		if (!ParseJSONPath(path, steps)) {
+			return false;
+		}
+
+		auto column_name = bind_data.arrow_table.GetNames()[column_id.GetPrimaryIndex()];
+		auto key = column_name + (as_text ? "->>" : "->") + path.ToString();
+		idx_t path_binding = DConstants::INVALID_INDEX;
+		for (auto &existing : paths) {
+			if (existing.key == key) {
+				path_binding = existing.binding_idx;
+			}
+		}
+		if (path_binding == DConstants::INVALID_INDEX) {
+			path_binding = AddColumn(key, expr->return_type);
+			paths.push_back(PathColumn {key, get.names.back(), BuildPathExpression(column_name, steps, as_text),
+			                            path_binding});
+			DPRINT("Path pushdown: fetching %s\n", get.names.back().c_str());
+		}
+		source_bindings.insert(binding_idx);
+		expr = make_uniq<BoundColumnRefExpression>(expr->alias, expr->return_type,
+		                                           ColumnBinding(get.table_index, path_binding));
+		return true;
+	}
+
+	// Add a VARCHAR column to the scan, returning its output binding
+	idx_t AddColumn(const string &name, const LogicalType &type) {
+		auto &arrow_table = bind_data.arrow_table;
+		// Result columns are matched by name, which Snowflake compares ignoring case
+		case_insensitive_set_t existing_names;
+		for (auto &existing_name : arrow_table.GetNames()) {
+			existing_names.insert(existing_name);
+		}
+		auto column_name = name;
+		for (idx_t suffix = 1; existing_names.count(column_name); suffix++) {
+			column_name = name + "_" + to_string(suffix);
+		}
+
+		auto col_idx = static_cast<idx_t>(arrow_table.GetColumns().size());
+		arrow_table.AddColumn(
+		    col_idx, make_shared_ptr<ArrowType>(type, make_uniq<ArrowStringInfo>(ArrowVariableSizeType::NORMAL)),
+		    column_name);
+		bind_data.all_types.push_back(type);
+		get.names.push_back(column_name);
+		get.returned_types.push_back(type);
+		auto &column_ids = get.GetMutableColumnIds();
+		column_ids.emplace_back(col_idx);
+		if (get.projection_ids.empty()) {
+			return column_ids.size() - 1;
+		}
+		get.projection_ids.push_back(column_ids.size() - 1);
+		return get.projection_ids.size() - 1;
+	}
+
+	LogicalGet &get;
+	SnowflakeScanBindData &bind_data;
+	vector<PathColumn> paths;
+	//! Output bindings of the columns paths were extracted from
+	unordered_set<idx_t> source_bindings;
+};
+
+static void CollectReferences(Expression &expr, idx_t table_index, unordered_set<idx_t> &referenced) {
+	if (expr.GetExpressionClass() == ExpressionClass::BOUND_COLUMN_REF) {
+		auto &binding = expr.Cast<BoundColumnRefExpression>().binding;
+		if (binding.table_index == table_index) {
+			referenced.insert(binding.column_index);
+		}
+	}
+	ExpressionIterator::EnumerateChildren(
+	    expr, [&](Expression &child) { CollectReferences(child, table_index, referenced); });
+}
+
+static void PushdownPaths(unique_ptr<LogicalOperator> &op) {
+	for (auto &child : op->children) {
+		PushdownPaths(child);
+	}
+	if ((op->type != LogicalOperatorType::LOGICAL_PROJECTION &&
+	     op->type != LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY) ||
+	    op->children.size() != 1) {
+		return;
+	}
+	// The scan's columns are only visible to the operator directly above it, or through a filter
+	vector<reference<LogicalOperator>> consumers {*op};
+	auto child = op->children[0].get();
+	if (child->type == LogicalOperatorType::LOGICAL_FILTER && child->Cast<LogicalFilter>().projection_map.empty()) {
+		consumers.push_back(*child);
+		child = child->children[0].get();
+	}
+	if (child->type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &get = child->Cast<LogicalGet>();
+	if (get.function.name != "snowflake_table_scan" || !get.bind_data) {
+		return;
+	}
+	auto &bind_data = get.bind_data->Cast<SnowflakeScanBindData>();
+	if (!bind_data.factory->projection_pushdown_enabled) {
+		return;
+	}
+
+	SnowflakePathRewriter rewriter(get, bind_data);
+	for (auto &consumer : consumers) {
+		LogicalOperatorVisitor::EnumerateExpressions(consumer.get(),
+		                                             [&](unique_ptr<Expression> *expr) { rewriter.Rewrite(*expr); });
+	}
+	if (!rewriter.HasPaths()) {
+		return;
+	}
+	unordered_set<idx_t> referenced;
+	for (auto &consumer : consumers) {
+		LogicalOperatorVisitor::EnumerateExpressions(consumer.get(), [&](unique_ptr<Expression> *expr) {
+			CollectReferences(**expr, get.table_index, referenced);
+		});
+	}
+	rewriter.Apply(referenced);
+}
+
+static void SnowflakePathPushdown(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	PushdownPaths(plan);
+}
+
+OptimizerExtension GetSnowflakePathPushdownExtension() {
+	OptimizerExtension extension;
+	extension.optimize_function = SnowflakePathPushdown;
+	return extension;
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,455 @@
+#include "snowflake_query_batch.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/function/table/arrow.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "snowflake_arrow_utils.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_secrets.hpp"
+#include "snowflake_timestamp_conversion.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <thread>
+
+namespace duckdb {
+namespace snowflake {
+
+//! Queries of a batch that run at the same time unless max_concurrency says otherwise
+static constexpr idx_t DEFAULT_BATCH_CONCURRENCY = 8;
+//! Size of the fetched result of one query unless max_result_bytes says otherwise
+static constexpr idx_t DEFAULT_BATCH_RESULT_BYTES = 64ULL * 1024ULL * 1024ULL;
+
+struct SnowflakeQueryBatchBindData : public TableFunctionData {
+	SnowflakeConfig config;
+	vector<string> queries;
+	idx_t max_concurrency = DEFAULT_BATCH_CONCURRENCY;
+	//! Results are held in memory until they are returned, so each may take at most this many bytes
+	idx_t max_result_bytes = DEFAULT_BATCH_RESULT_BYTES;
+	//! Types of the result columns, combined over all queries as with UNION ALL. The results of the queries are
+	//! cast to them.
+	vector<LogicalType> column_types;
+};
+
+//! Result columns of one query of the batch, looked up at bind time
+struct SnowflakeBatchColumns {
+	vector<string> names;
+	vector<LogicalType> types;
+	//! Set if the lookup failed
+	ErrorData error;
+};
+
+//! The fetched result of one query of the batch
+struct SnowflakeBatchResult {
+	idx_t query_index;
+	ArrowSchemaWrapper schema;
+	ArrowTableSchema arrow_table;
+	vector<shared_ptr<ArrowArrayWrapper>> batches;
+};
+
+struct SnowflakeQueryBatchGlobalState : public GlobalTableFunctionState {
+	SnowflakeQueryBatchGlobalState(const SnowflakeQueryBatchBindData &bind_data, DBConfig &db_config)
+	    : bind_data(bind_data), db_config(db_config) {
+	}
+	~SnowflakeQueryBatchGlobalState() override {
+		Stop();
+	}
+
+	const SnowflakeQueryBatchBindData &bind_data;
+	DBConfig &db_config;
+
+	//! Next query a worker picks up
+	std::atomic<idx_t> next_query {0};
+	std::mutex lock;
+	//! Signalled when a result completes or is taken, and when a worker exits
+	std::condition_variable changed;
+	//! Results that have been fetched but not returned yet, in completion order
+	std::deque<unique_ptr<SnowflakeBatchResult>> completed;
+	idx_t running_workers = 0;
+	bool stopped = false;
+	//! First query that failed; the remaining queries are not started
+	bool failed = false;
+	idx_t failed_query = 0;
+	ErrorData error;
+	vector<std::thread> workers;
+
+	//! The result being returned, its current record batch and the batch converted to its own types
+	unique_ptr<SnowflakeBatchResult> current;
+	idx_t current_batch = 0;
+	unique_ptr<ArrowScanLocalState> batch_state;
+	DataChunk converted;
+
+	void Stop() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stopped = true;
+		}
+		changed.notify_all();
+		// A worker finishes the Snowflake query it is running first
+		for (auto &worker : workers) {
+			if (worker.joinable()) {
+				worker.join();
+			}
+		}
+		workers.clear();
+	}
+
+	//! Wait for the next completed result. Returns false once all queries have been returned.
+	bool NextResult(ClientContext &context);
+};
+
+//! Bytes of the values of `array` from its offset on, as laid out by its format. Types the batch queries do not
+//! return are only counted by their children.
+static idx_t GetArrowArrayBytes(const ArrowSchema &schema, const ArrowArray &array) {
+	auto length = NumericCast<idx_t>(array.length);
+	auto offset = NumericCast<idx_t>(array.offset);
+	string format(schema.format ? schema.format : "");
+	idx_t bytes = array.buffers && array.n_buffers > 0 && array.buffers[0] ? (length + 7) / 8 : 0;
+	idx_t width = 0;
+	if (format == "c" || format == "C") {
+		width = 1;
+	} else if (format == "s" || format == "S" || format == "e") {
+		width = 2;
+	} else if (format == "i" || format == "I" || format == "f" || format == "tdD" || format == "tts" ||
+	           format == "ttm") {
+		width = 4;
+	} else if (format == "l" || format == "L" || format == "g" || format == "tdm" || format == "ttu" ||
+	           format == "ttn" || StringUtil::StartsWith(format, "ts") || StringUtil::StartsWith(format, "tD")) {
+		width = 8;
+	} else if (StringUtil::StartsWith(format, "d:")) {
+		width = StringUtil::EndsWith(format, ",256") ? 32 : 16;
+	} else if (StringUtil::StartsWith(format, "w:")) {
+		width = std::stoull(format.substr(2));
+	} else if (format == "b") {
+		bytes += (length + 7) / 8;
+	} else if ((format == "u" || format == "z") && array.n_buffers >= 3 && array.buffers[1]) {
+		auto offsets = static_cast<const int32_t *>(array.buffers[1]);
+		bytes += (length + 1) * sizeof(int32_t) + NumericCast<idx_t>(offsets[offset + length] - offsets[offset]);
+	} else if ((format == "U" || format == "Z") && array.n_buffers >= 3 && array.buffers[1]) {
+		auto offsets = static_cast<const int64_t *>(array.buffers[1]);
+		bytes += (length + 1) * sizeof(int64_t) + NumericCast<idx_t>(offsets[offset + length] - offsets[offset]);
+	} else if (format == "+l" || format == "+m") {
+		bytes += (length + 1) * sizeof(int32_t);
+	} else if (format == "+L") {
+		bytes += (length + 1) * sizeof(int64_t);
+	}
+	bytes += width * length;
+	for (int64_t child_idx = 0; child_idx < array.n_children && child_idx < schema.n_children; child_idx++) {
+		bytes += GetArrowArrayBytes(*schema.children[child_idx], *array.children[child_idx]);
+	}
+	return bytes;
+}
+
+static unique_ptr<SnowflakeBatchResult> FetchBatchQuery(SnowflakeQueryBatchGlobalState &state,
+                                                        shared_ptr<SnowflakeClient> connection, idx_t query_idx) {
+	auto &bind_data = state.bind_data;
+	// Declared before the stream, so the statement outlives it
+	SnowflakeArrowStreamFactory factory(std::move(connection), bind_data.queries[query_idx]);
+	factory.SetFetchOptions(bind_data.config.fetch_options, 1);
+	ArrowStreamParameters parameters;
+	auto stream = SnowflakeProduceArrowScan(reinterpret_cast<uintptr_t>(&factory), parameters);
+
+	auto result = make_uniq<SnowflakeBatchResult>();
+	result->query_index = query_idx;
+	stream->GetSchema(result->schema);
+	ArrowTableFunction::PopulateArrowTableSchema(state.db_config, result->arrow_table, result->schema.arrow_schema);
+	auto conversions =
+	    ApplyTimestampTypes(result->schema.arrow_schema, result->arrow_table, bind_data.config.timestamp_ns);
+	if (!conversions.empty()) {
+		WrapConversionStream(stream->arrow_array_stream, std::move(conversions));
+	}
+	// The result is held until it is returned, so its size is bounded
+	idx_t result_bytes = 0;
+	while (true) {
+		shared_ptr<ArrowArrayWrapper> batch = stream->GetNextChunk();
+		if (!batch || !batch->arrow_array.release) {
+			break;
+		}
+		if (batch->arrow_array.length > 0) {
+			result_bytes += GetArrowArrayBytes(result->schema.arrow_schema, batch->arrow_array);
+			if (result_bytes > bind_data.max_result_bytes) {
+				throw InvalidInputException(
+				    "The result of the query is larger than max_result_bytes (%llu bytes): snowflake_query_batch "
+				    "holds each result in memory until it is returned, run large queries with snowflake_query "
+				    "instead or raise max_result_bytes",
+				    static_cast<unsigned long long>(bind_data.max_result_bytes));
+			}
+			result->batches.push_back(std::move(batch));
+		}
+	}
+	DPRINT("snowflake_query_batch: query %llu returned %llu batches\n", query_idx + 1, result->batches.size());
+	return result;
+}
+
+static void RunBatchWorker(SnowflakeQueryBatchGlobalState &state) {
+	auto &bind_data = state.bind_data;
+	// One pooled session per worker, reused for all queries it picks up
+	shared_ptr<SnowflakeClient> connection;
+	while (true) {
+		idx_t query_idx = state.next_query++;
+		if (query_idx >= bind_data.queries.size()) {
+			break;
+		}
+		{
+			std::lock_guard<std::mutex> guard(state.lock);
+			if (state.stopped || state.failed) {
+				break;
+			}
+		}
+		try {
+			if (!connection) {
+				connection = SnowflakeClientManager::GetInstance().CreateConnection(bind_data.config);
+			}
+			auto result = FetchBatchQuery(state, connection, query_idx);
+			std::unique_lock<std::mutex> guard(state.lock);
+			// Hold back while enough results wait to be returned
+			state.changed.wait(guard, [&]() {
+				return state.stopped || state.completed.size() < bind_data.max_concurrency;
+			});
+			if (state.stopped) {
+				break;
+			}
+			state.completed.push_back(std::move(result));
+			state.changed.notify_all();
+		} catch (std::exception &ex) {
+			std::lock_guard<std::mutex> guard(state.lock);
+			if (!state.failed) {
+				state.failed = true;
+				state.failed_query = query_idx;
+				state.error = ErrorData(ex);
+			}
+			break;
+		}
+	}
+	std::lock_guard<std::mutex> guard(state.lock);
+	state.running_workers--;
+	state.changed.notify_all();
+}
+
+bool SnowflakeQueryBatchGlobalState::NextResult(ClientContext &context) {
+	std::unique_lock<std::mutex> guard(lock);
+	changed.wait(guard, [&]() { return failed || !completed.empty() || running_workers == 0; });
+	if (failed) {
+		error.Throw(StringUtil::Format("Query %llu of snowflake_query_batch failed: ", failed_query + 1));
+	}
+	if (completed.empty()) {
+		return false;
+	}
+	current = std::move(completed.front());
+	completed.pop_front();
+	changed.notify_all();
+	guard.unlock();
+
+	auto result_types = current->arrow_table.GetTypes();
+	if (result_types.size() != bind_data.column_types.size()) {
+		throw InvalidInputException("Query %llu of snowflake_query_batch returns %llu columns, but the first query "
+		                            "returns %llu",
+		                            current->query_index + 1, result_types.size(), bind_data.column_types.size());
+	}
+	current_batch = 0;
+	batch_state.reset();
+	converted.Destroy();
+	converted.Initialize(context, result_types);
+	return true;
+}
+
+//! Look up the result columns of every query of the batch, up to max_concurrency at a time on pooled sessions
+static vector<SnowflakeBatchColumns> GetBatchColumns(ClientContext &context,
+                                                     const SnowflakeQueryBatchBindData &bind_data) {
+	vector<SnowflakeBatchColumns> columns(bind_data.queries.size());
+	auto &db_config = DBConfig::GetConfig(context);
+	std::atomic<idx_t> next_query(0);
+	auto run_lookups = [&]() {
+		shared_ptr<SnowflakeClient> connection;
+		while (true) {
+			idx_t query_idx = next_query++;
+			if (query_idx >= bind_data.queries.size()) {
+				return;
+			}
+			auto &result = columns[query_idx];
+			try {
+				if (!connection) {
+					connection = SnowflakeClientManager::GetInstance().CreateConnection(bind_data.config);
+				}
+				SnowflakeArrowStreamFactory factory(connection, bind_data.queries[query_idx]);
+				ArrowSchemaWrapper schema;
+				SnowflakeGetArrowSchema(reinterpret_cast<ArrowArrayStream *>(&factory), schema.arrow_schema);
+				ArrowTableSchema arrow_table;
+				ArrowTableFunction::PopulateArrowTableSchema(db_config, arrow_table, schema.arrow_schema);
+				ApplyTimestampTypes(schema.arrow_schema, arrow_table, bind_data.config.timestamp_ns);
+				result.names = arrow_table.GetNames();
+				result.types = arrow_table.GetTypes();
+			} catch (std::exception &ex) {
+				result.error = ErrorData(ex);
+			}
+		}
+	};
+	auto worker_count = MinValue<idx_t>(bind_data.max_concurrency, bind_data.queries.size());
+	{
+		// The futures wait for their lookups when they go out of scope, also if starting one of them failed
+		vector<std::future<void>> workers;
+		for (idx_t worker_idx = 1; worker_idx < worker_count; worker_idx++) {
+			workers.push_back(std::async(std::launch::async, run_lookups));
+		}
+		run_lookups();
+	}
+	return columns;
+}
+
+static unique_ptr<FunctionData> SnowflakeQueryBatchBind(ClientContext &context, TableFunctionBindInput &input,
+                                                        vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<SnowflakeQueryBatchBindData>();
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("snowflake_query_batch requires a list of queries");
+	}
+	for (auto &query : ListValue::GetChildren(input.inputs[0])) {
+		if (query.IsNull()) {
+			throw BinderException("snowflake_query_batch: the list of queries contains NULL");
+		}
+		bind_data->queries.push_back(query.GetValue<string>());
+	}
+	if (bind_data->queries.empty()) {
+		throw BinderException("snowflake_query_batch requires at least one query");
+	}
+	auto profile = input.inputs[1].GetValue<string>();
+	try {
+		bind_data->config = SnowflakeSecretsHelper::GetCredentials(context, profile);
+	} catch (const std::exception &e) {
+		throw BinderException("Failed to retrieve credentials for profile '%s': %s", profile.c_str(), e.what());
+	}
+	for (auto &kv : input.named_parameters) {
+		if (StringUtil::Lower(kv.first) == "max_concurrency") {
+			auto max_concurrency = kv.second.GetValue<int64_t>();
+			if (max_concurrency < 1) {
+				throw BinderException("snowflake_query_batch: max_concurrency must be at least 1");
+			}
+			bind_data->max_concurrency = NumericCast<idx_t>(max_concurrency);
+		} else if (StringUtil::Lower(kv.first) == "max_result_bytes") {
+			auto max_result_bytes = kv.second.GetValue<int64_t>();
+			if (max_result_bytes < 1) {
+				throw BinderException("snowflake_query_batch: max_result_bytes must be at least 1");
+			}
+			bind_data->max_result_bytes = NumericCast<idx_t>(max_result_bytes);
+		}
+	}
+
+	// The result columns are named after the first query. Every query must return the same columns, whose
+	// types are combined as with UNION ALL.
+	auto columns = GetBatchColumns(context, *bind_data);
+	for (idx_t query_idx = 0; query_idx < columns.size(); query_idx++) {
+		if (columns[query_idx].error.HasError()) {
+			columns[query_idx].error.Throw(
+			    StringUtil::Format("Query %llu of snowflake_query_batch failed: ", query_idx + 1));
+		}
+	}
+	auto &first = columns[0];
+	bind_data->column_types = first.types;
+	for (idx_t query_idx = 1; query_idx < columns.size(); query_idx++) {
+		auto &query_columns = columns[query_idx];
+		if (query_columns.types.size() != first.types.size()) {
+			throw BinderException("Query %llu of snowflake_query_batch returns %llu columns, but the first query "
+			                      "returns %llu",
+			                      query_idx + 1, query_columns.types.size(), first.types.size());
+		}
+		for (idx_t col_idx = 0; col_idx < first.types.size(); col_idx++) {
+			if (!StringUtil::CIEquals(query_columns.names[col_idx], first.names[col_idx])) {
+				throw BinderException("Column %llu of query %llu of snowflake_query_batch is named \"%s\", but the "
+				                      "first query names it \"%s\"",
+				                      col_idx + 1, query_idx + 1, query_columns.names[col_idx],
+				                      first.names[col_idx]);
+			}
+			auto &column_type = bind_data->column_types[col_idx];
+			LogicalType combined;
+			if (!LogicalType::TryGetMaxLogicalType(context, column_type, query_columns.types[col_idx], combined)) {
+				throw BinderException("Column \"%s\" of query %llu of snowflake_query_batch is %s, which cannot be "
+				                      "combined with %s of the queries before it",
+				                      first.names[col_idx], query_idx + 1, query_columns.types[col_idx].ToString(),
+				                      column_type.ToString());
+			}
+			column_type = combined;
+		}
+	}
+
+	names.push_back("query_index");
+	return_types.push_back(LogicalType::BIGINT);
+	for (auto &name : first.names) {
+		names.push_back(name);
+	}
+	for (auto &type : bind_data->column_types) {
+		return_types.push_back(type);
+	}
+	return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> SnowflakeQueryBatchInitGlobal(ClientContext &context,
+                                                                          TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<SnowflakeQueryBatchBindData>();
+	auto state = make_uniq<SnowflakeQueryBatchGlobalState>(bind_data, DBConfig::GetConfig(context));
+	auto worker_count = MinValue<idx_t>(bind_data.max_concurrency, bind_data.queries.size());
+	state->running_workers = worker_count;
+	for (idx_t worker_idx = 0; worker_idx < worker_count; worker_idx++) {
+		state->workers.emplace_back(RunBatchWorker, std::ref(*state));
+	}
+	return std::move(state);
+}
+
+static void SnowflakeQueryBatchFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<SnowflakeQueryBatchGlobalState>();
+	while (true) {
+		if (state.batch_state) {
+			auto &local = *state.batch_state;
+			auto length = NumericCast<idx_t>(local.chunk->arrow_array.length);
+			if (local.chunk_offset < length) {
+				auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, length - local.chunk_offset);
+				state.converted.Reset();
+				state.converted.SetCardinality(count);
+				ArrowTableFunction::ArrowToDuckDB(local, state.current->arrow_table.GetColumns(), state.converted,
+				                                  local.chunk_offset);
+				local.chunk_offset += count;
+
+				output.SetCardinality(count);
+				output.data[0].Reference(Value::BIGINT(NumericCast<int64_t>(state.current->query_index + 1)));
+				for (idx_t col_idx = 0; col_idx < state.converted.ColumnCount(); col_idx++) {
+					auto &source = state.converted.data[col_idx];
+					auto &target = output.data[col_idx + 1];
+					if (source.GetType() == target.GetType()) {
+						target.Reference(source);
+					} else {
+						VectorOperations::Cast(context, source, target, count);
+					}
+				}
+				return;
+			}
+			state.batch_state.reset();
+			state.current_batch++;
+		}
+		if (state.current && state.current_batch < state.current->batches.size()) {
+			state.batch_state =
+			    make_uniq<ArrowScanLocalState>(state.current->batches[state.current_batch], context);
+			continue;
+		}
+		state.current.reset();
+		if (!state.NextResult(context)) {
+			return;
+		}
+	}
+}
+
+} // namespace snowflake
+
+TableFunction GetSnowflakeQueryBatchFunction() {
+	TableFunction snowflake_query_batch("snowflake_query_batch",
+	                                    {LogicalType::LIST(LogicalType::VARCHAR), LogicalType::VARCHAR},
+	                                    snowflake::SnowflakeQueryBatchFunction, snowflake::SnowflakeQueryBatchBind,
+	                                    snowflake::SnowflakeQueryBatchInitGlobal);
+	snowflake_query_batch.named_parameters["max_concurrency"] = LogicalType::BIGINT;
+	snowflake_query_batch.named_parameters["max_result_bytes"] = LogicalType::BIGINT;
+	return snowflake_query_batch;
+}
+
+} // namespace duckdb
@@ -2,6 +2,7 @@
 #include "snowflake_debug.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/parser/statement/select_statement.hpp"
 #include "duckdb/parser/query_node/select_node.hpp"
 #include "duckdb/parser/tableref/basetableref.hpp"
@@ -10,16 +11,94 @@
 #include "duckdb/parser/expression/comparison_expression.hpp"
 #include "duckdb/parser/expression/conjunction_expression.hpp"
 #include "duckdb/parser/expression/operator_expression.hpp"
+#include "duckdb/parser/expression/between_expression.hpp"
+#include "duckdb/parser/expression/case_expression.hpp"
+#include "duckdb/parser/expression/cast_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/planner/expression/list.hpp"
 #include "duckdb/planner/filter/conjunction_filter.hpp"
 #include "duckdb/planner/filter/optional_filter.hpp"
 #include "duckdb/planner/filter/in_filter.hpp"
 #include "duckdb/planner/filter/dynamic_filter.hpp"
+#include "duckdb/planner/filter/struct_filter.hpp"
 
 namespace duckdb {
 namespace snowflake {
 
+SnowflakeColumnExpansion SnowflakeColumnExpansion::Copy() const {
+	SnowflakeColumnExpansion result;
+	for (auto &item : select_list) {
+		result.select_list.push_back(item->Copy());
+	}
+	for (auto &field : fields) {
+		result.fields[field.first] = field.second->Copy();
+	}
+	return result;
+}
+
+SnowflakeTimeTravel SnowflakeTimeTravel::FromAtClause(const string &unit, const Value &value) {
+	SnowflakeTimeTravel result;
+	result.unit = StringUtil::Upper(unit);
+	if (value.IsNull()) {
+		throw BinderException("The value of AT (%s => ...) cannot be NULL", result.unit);
+	}
+	if (result.unit == "TIMESTAMP") {
+		// As UTC text, which Snowflake parses with its time zone offset
+		auto timestamp = value.DefaultCastAs(LogicalType::TIMESTAMP_TZ).GetValue<timestamp_tz_t>();
+		result.value = Value(Timestamp::ToString(timestamp_t(timestamp.value)) + " +00:00");
+	} else if (result.unit == "OFFSET") {
+		result.value = value.DefaultCastAs(LogicalType::BIGINT);
+	} else if (result.unit == "STATEMENT") {
+		result.value = value.DefaultCastAs(LogicalType::VARCHAR);
+	} else {
+		throw BinderException("Snowflake tables support AT (TIMESTAMP => ...), AT (OFFSET => ...) and AT (STATEMENT "
+		                      "=> ...), not AT (%s => ...)",
+		                      result.unit);
+	}
+	return result;
+}
+
+SnowflakeTimeTravel SnowflakeTimeTravel::AtTimestamp(const string &timestamp) {
+	SnowflakeTimeTravel result;
+	result.unit = "TIMESTAMP";
+	result.value = Value(timestamp);
+	return result;
+}
+
+string SnowflakeTimeTravel::ToString() const {
+	return unit + " => " + value.ToString();
+}
+
+// Backslash starts an escape sequence in Snowflake string literals
+static string EscapeBackslashes(const string &str) {
+	return StringUtil::Replace(str, "\\", "\\\\");
+}
+
+// A constant of a generated query. ConstantExpression is written with Value::ToSQLString, which doubles
+// quotes but leaves backslashes alone, so they are escaped in the value itself.
+static unique_ptr<ParsedExpression> MakeConstant(const Value &value) {
+	if (value.type().id() == LogicalTypeId::VARCHAR && !value.IsNull()) {
+		return make_uniq<ConstantExpression>(Value(EscapeBackslashes(StringValue::Get(value))));
+	}
+	return make_uniq<ConstantExpression>(value);
+}
+
+static unique_ptr<AtClause> BuildAtClause(const SnowflakeTimeTravel &time_travel) {
+	unique_ptr<ParsedExpression> expr;
+	if (time_travel.unit == "TIMESTAMP") {
+		vector<unique_ptr<ParsedExpression>> children;
+		children.push_back(MakeConstant(time_travel.value));
+		expr = make_uniq<FunctionExpression>("to_timestamp_tz", std::move(children));
+	} else {
+		expr = MakeConstant(time_travel.value);
+	}
+	return make_uniq<AtClause>(time_travel.unit, std::move(expr));
+}
+
 string SnowflakeQueryBuilder::BuildQuery(const string &table_name, const vector<string> &projection_columns,
-                                         TableFilterSet *filter_set, const vector<string> &column_names) {
+                                         TableFilterSet *filter_set, const vector<string> &column_names,
+                                         const column_expansion_map_t *expansions,
+                                         const SnowflakeTimeTravel *time_travel) {
 	// Create a SelectStatement AST
 	auto select_stmt = make_uniq<SelectStatement>();
 	auto select_node = make_uniq<SelectNode>();
@@ -41,18 +120,21 @@ string SnowflakeQueryBuilder::BuildQuery(const string &table_name, const vector<
 	if (n >= 3) {
 		table_ref->catalog_name = table_parts[n - 3];
 	}
+	if (time_travel && time_travel->IsSet()) {
+		table_ref->at_clause = BuildAtClause(*time_travel);
+	}
 
 	select_node->from_table = std::move(table_ref);
 
 	// 2. Build the SELECT clause (projection list)
-	auto projection_list = BuildProjectionList(projection_columns);
+	auto projection_list = BuildProjectionList(projection_columns, expansions);
 	if (!projection_list.empty()) {
 		select_node->select_list = std::move(projection_list);
 	}
 	// If empty, SelectNode defaults to SELECT *
 
 	// 3. Build the WHERE clause (filters)
-	auto where_expr = BuildWhereExpression(filter_set, column_names);
+	auto where_expr = BuildWhereExpression(filter_set, column_names, expansions);
 	if (where_expr) {
 		select_node->where_clause = std::move(where_expr);
 	}
@@ -65,7 +147,8 @@ string SnowflakeQueryBuilder::BuildQuery(const string &table_name, const vector<
 }
 
 unique_ptr<ParsedExpression> SnowflakeQueryBuilder::BuildWhereExpression(TableFilterSet *filter_set,
-                                                                         const vector<string> &column_names) {
+                                                                         const vector<string> &column_names,
+                                                                         const column_expansion_map_t *expansions) {
 	if (!filter_set || filter_set->filters.empty()) {
 		return nullptr;
 	}
@@ -83,7 +166,14 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::BuildWhereExpression(TableFi
 		}
 
 		string column_name = column_names[column_idx];
-		auto condition = TransformFilter(*filter, column_name);
+		const SnowflakeColumnExpansion *expansion = nullptr;
+		if (expansions) {
+			auto entry = expansions->find(column_name);
+			if (entry != expansions->end()) {
+				expansion = &entry->second;
+			}
+		}
+		auto condition = TransformFilter(*filter, ColumnRefExpression(column_name), expansion);
 		// Note: TransformFilter returns nullptr for filters that should be skipped
 		// (e.g., uninitialized DYNAMIC_FILTER) These filters will be applied by
 		// DuckDB locally after fetching data
@@ -109,9 +199,10 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::BuildWhereExpression(TableFi
 }
 
 unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableFilter &filter,
-                                                                    const string &column_name) {
-	// Create column reference
-	auto column_ref = make_uniq<ColumnRefExpression>(column_name);
+                                                                    const ParsedExpression &column,
+                                                                    const SnowflakeColumnExpansion *expansion) {
+	// Used in messages
+	auto column_name = column.ToString();
 
 	switch (filter.filter_type) {
 	case TableFilterType::CONSTANT_COMPARISON: {
@@ -134,20 +225,20 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		}
 
 		// Create constant value expression
-		auto constant = make_uniq<ConstantExpression>(const_filter.constant);
+		auto constant = MakeConstant(const_filter.constant);
 
 		// Create comparison expression
-		return make_uniq<ComparisonExpression>(comparison_type, std::move(column_ref), std::move(constant));
+		return make_uniq<ComparisonExpression>(comparison_type, column.Copy(), std::move(constant));
 	}
 
 	case TableFilterType::IS_NULL: {
 		// column IS NULL
-		return make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NULL, std::move(column_ref));
+		return make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NULL, column.Copy());
 	}
 
 	case TableFilterType::IS_NOT_NULL: {
 		// column IS NOT NULL
-		return make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, std::move(column_ref));
+		return make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, column.Copy());
 	}
 
 	case TableFilterType::CONJUNCTION_AND: {
@@ -163,7 +254,7 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		// Push whatever we can, let DuckDB handle the rest
 		vector<unique_ptr<ParsedExpression>> conditions;
 		for (const auto &child : conj_filter.child_filters) {
-			auto condition = TransformFilter(*child, column_name);
+			auto condition = TransformFilter(*child, column, expansion);
 			if (condition) {
 				// This filter can be pushed
 				conditions.push_back(std::move(condition));
@@ -202,7 +293,7 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		if (!opt_filter.child_filter) {
 			throw InternalException("OPTIONAL_FILTER has no child filter for column '%s'", column_name.c_str());
 		}
-		auto result = TransformFilter(*opt_filter.child_filter, column_name);
+		auto result = TransformFilter(*opt_filter.child_filter, column, expansion);
 		// Optional filters can return nullptr (e.g., uninitialized DYNAMIC_FILTER)
 		// This is acceptable - DuckDB will apply the filter locally if needed
 		return result;
@@ -219,10 +310,9 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		// Build as: (column = val1) OR (column = val2) OR ...
 		vector<unique_ptr<ParsedExpression>> conditions;
 		for (const auto &value : in_filter.values) {
-			auto col_ref = make_uniq<ColumnRefExpression>(column_name);
-			auto constant = make_uniq<ConstantExpression>(value);
+			auto constant = MakeConstant(value);
 			auto comparison =
-			    make_uniq<ComparisonExpression>(ExpressionType::COMPARE_EQUAL, std::move(col_ref), std::move(constant));
+			    make_uniq<ComparisonExpression>(ExpressionType::COMPARE_EQUAL, column.Copy(), std::move(constant));
 			conditions.push_back(std::move(comparison));
 		}
 
@@ -248,7 +338,7 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		// So we only push if ALL filters in the OR can be pushed
 		vector<unique_ptr<ParsedExpression>> conditions;
 		for (const auto &child : conj_filter.child_filters) {
-			auto condition = TransformFilter(*child, column_name);
+			auto condition = TransformFilter(*child, column, expansion);
 			if (!condition) {
 				// For OR, if any child can't be pushed, we skip the entire OR
 				// This preserves correctness - partial OR pushdown could change
@@ -287,7 +377,7 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 			DPRINT("DYNAMIC_FILTER initialized for column '%s', unwrapping to "
 			       "ConstantFilter\n",
 			       column_name.c_str());
-			return TransformFilter(*dyn_filter.filter_data->filter, column_name);
+			return TransformFilter(*dyn_filter.filter_data->filter, column, expansion);
 		}
 
 		// If not initialized yet, skip this filter - DuckDB will apply it locally
@@ -299,6 +389,20 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 		return nullptr;
 	}
 
+	case TableFilterType::STRUCT_EXTRACT: {
+		// A field of a column that is fetched as separate expressions (a shredded VARIANT column):
+		// filter on the expression of the field
+		auto &struct_filter = filter.Cast<StructFilter>();
+		if (expansion) {
+			auto field = expansion->fields.find(struct_filter.child_name);
+			if (field != expansion->fields.end()) {
+				return TransformFilter(*struct_filter.child_filter, *field->second, nullptr);
+			}
+		}
+		throw NotImplementedException("Filter on field '%s' of column '%s' is not supported for Snowflake pushdown",
+		                              struct_filter.child_name, column_name);
+	}
+
 	default:
 		throw NotImplementedException("Filter type %d on column '%s' is not supported for Snowflake "
 		                              "pushdown. "
@@ -312,7 +416,8 @@ unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformFilter(const TableF
 }
 
 vector<unique_ptr<ParsedExpression>>
-SnowflakeQueryBuilder::BuildProjectionList(const vector<string> &projection_columns) {
+SnowflakeQueryBuilder::BuildProjectionList(const vector<string> &projection_columns,
+                                           const column_expansion_map_t *expansions) {
 	vector<unique_ptr<ParsedExpression>> result;
 
 	if (projection_columns.empty()) {
@@ -320,13 +425,289 @@ SnowflakeQueryBuilder::BuildProjectionList(const vector<string> &projection_colu
 		return result;
 	}
 
-	// Create ColumnRefExpression for each projected column
+	// Create ColumnRefExpression for each projected column, or the expressions it is fetched as
 	for (const auto &col : projection_columns) {
+		if (expansions) {
+			auto entry = expansions->find(col);
+			if (entry != expansions->end()) {
+				for (auto &item : entry->second.select_list) {
+					result.push_back(item->Copy());
+				}
+				continue;
+			}
+		}
 		result.push_back(make_uniq<ColumnRefExpression>(col));
 	}
 
 	return result;
 }
 
+// Types whose DuckDB name is also understood by Snowflake in a CAST
+static bool IsSnowflakeCastType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	case LogicalTypeId::DECIMAL:
+	case LogicalTypeId::VARCHAR:
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Constants are written with Value::ToSQLString, which Snowflake parses for these types
+static bool IsSnowflakeConstantType(const LogicalType &type) {
+	return type.id() == LogicalTypeId::SQLNULL || IsSnowflakeCastType(type);
+}
+
+static bool TransformChildren(const vector<unique_ptr<Expression>> &children,
+                              const SnowflakeQueryBuilder::column_resolver_t &column_resolver,
+                              vector<unique_ptr<ParsedExpression>> &result) {
+	for (auto &child : children) {
+		auto transformed = SnowflakeQueryBuilder::TransformExpression(*child, column_resolver);
+		if (!transformed) {
+			return false;
+		}
+		result.push_back(std::move(transformed));
+	}
+	return true;
+}
+
+unique_ptr<ParsedExpression> SnowflakeQueryBuilder::TransformExpression(const Expression &expr,
+                                                                        const column_resolver_t &column_resolver) {
+	switch (expr.GetExpressionClass()) {
+	case ExpressionClass::BOUND_REF:
+		return column_resolver(expr.Cast<BoundReferenceExpression>().index);
+	case ExpressionClass::BOUND_CONSTANT: {
+		auto &value = expr.Cast<BoundConstantExpression>().value;
+		if (!IsSnowflakeConstantType(value.type())) {
+			return nullptr;
+		}
+		return MakeConstant(value);
+	}
+	case ExpressionClass::BOUND_CAST: {
+		auto &cast = expr.Cast<BoundCastExpression>();
+		if (cast.try_cast || !IsSnowflakeCastType(cast.return_type)) {
+			return nullptr;
+		}
+		auto child = TransformExpression(*cast.child, column_resolver);
+		if (!child) {
+			return nullptr;
+		}
+		return make_uniq<CastExpression>(cast.return_type, std::move(child));
+	}
+	case ExpressionClass::BOUND_COMPARISON: {
+		auto &comparison = expr.Cast<BoundComparisonExpression>();
+		auto left = TransformExpression(*comparison.left, column_resolver);
+		auto right = TransformExpression(*comparison.right, column_resolver);
+		if (!left || !right) {
+			return nullptr;
+		}
+		return make_uniq<ComparisonExpression>(comparison.GetExpressionType(), std::move(left), std::move(right));
+	}
+	case ExpressionClass::BOUND_CONJUNCTION: {
+		auto &conjunction = expr.Cast<BoundConjunctionExpression>();
+		vector<unique_ptr<ParsedExpression>> children;
+		if (!TransformChildren(conjunction.children, column_resolver, children)) {
+			return nullptr;
+		}
+		return make_uniq<ConjunctionExpression>(conjunction.GetExpressionType(), std::move(children));
+	}
+	case ExpressionClass::BOUND_OPERATOR: {
+		auto &op = expr.Cast<BoundOperatorExpression>();
+		switch (op.GetExpressionType()) {
+		case ExpressionType::OPERATOR_IS_NULL:
+		case ExpressionType::OPERATOR_IS_NOT_NULL:
+		case ExpressionType::OPERATOR_NOT:
+		case ExpressionType::COMPARE_IN:
+		case ExpressionType::COMPARE_NOT_IN:
+			break;
+		default:
+			return nullptr;
+		}
+		vector<unique_ptr<ParsedExpression>> children;
+		if (!TransformChildren(op.children, column_resolver, children)) {
+			return nullptr;
+		}
+		return make_uniq<OperatorExpression>(op.GetExpressionType(), std::move(children));
+	}
+	case ExpressionClass::BOUND_BETWEEN: {
+		auto &between = expr.Cast<BoundBetweenExpression>();
+		auto input = TransformExpression(*between.input, column_resolver);
+		auto lower = TransformExpression(*between.lower, column_resolver);
+		auto upper = TransformExpression(*between.upper, column_resolver);
+		if (!input || !lower || !upper) {
+			return nullptr;
+		}
+		if (between.lower_inclusive && between.upper_inclusive) {
+			return make_uniq<BetweenExpression>(std::move(input), std::move(lower), std::move(upper));
+		}
+		auto lower_comparison = make_uniq<ComparisonExpression>(
+		    between.lower_inclusive ? ExpressionType::COMPARE_GREATERTHANOREQUALTO : ExpressionType::COMPARE_GREATERTHAN,
+		    input->Copy(), std::move(lower));
+		auto upper_comparison = make_uniq<ComparisonExpression>(
+		    between.upper_inclusive ? ExpressionType::COMPARE_LESSTHANOREQUALTO : ExpressionType::COMPARE_LESSTHAN,
+		    std::move(input), std::move(upper));
+		return make_uniq<ConjunctionExpression>(ExpressionType::CONJUNCTION_AND, std::move(lower_comparison),
+		                                        std::move(upper_comparison));
+	}
+	case ExpressionClass::BOUND_CASE: {
+		auto &bound_case = expr.Cast<BoundCaseExpression>();
+		auto result = make_uniq<CaseExpression>();
+		for (auto &check : bound_case.case_checks) {
+			CaseCheck case_check;
+			case_check.when_expr = TransformExpression(*check.when_expr, column_resolver);
+			case_check.then_expr = TransformExpression(*check.then_expr, column_resolver);
+			if (!case_check.when_expr || !case_check.then_expr) {
+				return nullptr;
+			}
+			result->case_checks.push_back(std::move(case_check));
+		}
+		result->else_expr = TransformExpression(*bound_case.else_expr, column_resolver);
+		if (!result->else_expr) {
+			return nullptr;
+		}
+		return std::move(result);
+	}
+	case ExpressionClass::BOUND_FUNCTION: {
+		auto &function = expr.Cast<BoundFunctionExpression>();
+		auto &name = function.function.name;
+		if (function.children.empty() && (name == "get_current_timestamp" || name == "now" ||
+		                                  name == "current_timestamp" || name == "transaction_timestamp")) {
+			// Snowflake's time of the statement rather than DuckDB's start of the transaction
+			return make_uniq<FunctionExpression>("CURRENT_TIMESTAMP", vector<unique_ptr<ParsedExpression>>());
+		}
+		bool is_operator = name == "+" || name == "-" || name == "*" || name == "/" || name == "%" || name == "||";
+		bool is_function = name == "lower" || name == "upper" || name == "length" || name == "abs" ||
+		                   name == "trim" || name == "ltrim" || name == "rtrim" || name == "round";
+		if (!is_operator && !is_function) {
+			return nullptr;
+		}
+		if (!IsSnowflakeConstantType(function.return_type)) {
+			// e.g. date arithmetic with intervals
+			return nullptr;
+		}
+		vector<unique_ptr<ParsedExpression>> children;
+		if (!TransformChildren(function.children, column_resolver, children)) {
+			return nullptr;
+		}
+		return make_uniq<FunctionExpression>(name, std::move(children), nullptr, nullptr, false, is_operator);
+	}
+	default:
+		return nullptr;
+	}
+}
+
+string SnowflakeQueryBuilder::NormalizeIdentifier(const string &name) {
+	bool plain = !name.empty() && !StringUtil::CharacterIsDigit(name[0]) && name[0] != '$';
+	for (auto c : name) {
+		if (!StringUtil::CharacterIsAlpha(c) && !StringUtil::CharacterIsDigit(c) && c != '_' && c != '$') {
+			plain = false;
+			break;
+		}
+	}
+	return plain ? StringUtil::Upper(name) : name;
+}
+
+string SnowflakeQueryBuilder::WriteIdentifier(const string &name) {
+	return "\"" + StringUtil::Replace(NormalizeIdentifier(name), "\"", "\"\"") + "\"";
+}
+
+static string WriteStringLiteral(const string &str) {
+	return "'" + StringUtil::Replace(EscapeBackslashes(str), "'", "''") + "'";
+}
+
+string SnowflakeQueryBuilder::WriteLiteral(const Value &value) {
+	if (value.IsNull()) {
+		return "NULL";
+	}
+	auto &type = value.type();
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+		return BooleanValue::Get(value) ? "TRUE" : "FALSE";
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::DECIMAL:
+		return value.ToString();
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE: {
+		auto number = value.GetValue<double>();
+		if (!Value::IsFinite(number)) {
+			return WriteStringLiteral(value.ToString()) + "::DOUBLE";
+		}
+		return value.ToString();
+	}
+	case LogicalTypeId::BLOB: {
+		static constexpr const char *HEX_DIGITS = "0123456789ABCDEF";
+		auto &blob = StringValue::Get(value);
+		string hex;
+		hex.reserve(blob.size() * 2);
+		for (auto byte : blob) {
+			hex += HEX_DIGITS[(static_cast<uint8_t>(byte) >> 4) & 0x0F];
+			hex += HEX_DIGITS[static_cast<uint8_t>(byte) & 0x0F];
+		}
+		return "TO_BINARY('" + hex + "', 'HEX')";
+	}
+	case LogicalTypeId::DATE:
+		return WriteStringLiteral(value.ToString()) + "::DATE";
+	case LogicalTypeId::TIME:
+		return WriteStringLiteral(value.ToString()) + "::TIME";
+	// Timestamps are written as epoch counts so no format or time zone parsing is involved
+	case LogicalTypeId::TIMESTAMP_SEC:
+		return "TO_TIMESTAMP_NTZ(" + to_string(value.GetValueUnsafe<int64_t>()) + ", 0)";
+	case LogicalTypeId::TIMESTAMP_MS:
+		return "TO_TIMESTAMP_NTZ(" + to_string(value.GetValueUnsafe<int64_t>()) + ", 3)";
+	case LogicalTypeId::TIMESTAMP:
+		return "TO_TIMESTAMP_NTZ(" + to_string(value.GetValueUnsafe<int64_t>()) + ", 6)";
+	case LogicalTypeId::TIMESTAMP_NS:
+		return "TO_TIMESTAMP_NTZ(" + to_string(value.GetValueUnsafe<int64_t>()) + ", 9)";
+	case LogicalTypeId::TIMESTAMP_TZ:
+		return "TO_TIMESTAMP_TZ(" + to_string(value.GetValueUnsafe<int64_t>()) + ", 6)";
+	default:
+		return WriteStringLiteral(value.ToString());
+	}
+}
+
+vector<string> SnowflakeQueryBuilder::BuildValuesLists(ColumnDataCollection &rows) {
+	// Snowflake accepts at most 16384 rows in a VALUES clause and 1 MB of statement text
+	static constexpr idx_t MAX_VALUES_ROWS = 16384;
+	static constexpr idx_t MAX_VALUES_BYTES = 1000000;
+
+	vector<string> result;
+	string values_list;
+	idx_t row_count = 0;
+	for (auto &chunk : rows.Chunks()) {
+		for (idx_t row = 0; row < chunk.size(); row++) {
+			string row_values = "(";
+			for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+				row_values += (col > 0 ? ", " : "") + WriteLiteral(chunk.GetValue(col, row));
+			}
+			row_values += ")";
+			if (row_count > 0 &&
+			    (row_count >= MAX_VALUES_ROWS || values_list.size() + row_values.size() + 2 > MAX_VALUES_BYTES)) {
+				result.push_back(std::move(values_list));
+				values_list.clear();
+				row_count = 0;
+			}
+			values_list += (row_count > 0 ? ", " : "") + row_values;
+			row_count++;
+		}
+	}
+	if (row_count > 0) {
+		result.push_back(std::move(values_list));
+	}
+	return result;
+}
+
 } // namespace snowflake
 } // namespace duckdb
@@ -0,0 +1,84 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_result_cache.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeResultCache &SnowflakeResultCache::GetInstance() {
+	static SnowflakeResultCache instance;
+	return instance;
+}
+
+static size_t HashKey(const SnowflakeConfig &config, const string &query) {
+	return SnowflakeConfigHash()(config) ^ (std::hash<string>()(query) << 1);
+}
+
+std::list<SnowflakeResultCache::Entry>::iterator SnowflakeResultCache::Find(const SnowflakeConfig &config,
+                                                                            const string &query) {
+	auto range = index.equal_range(HashKey(config, query));
+	for (auto it = range.first; it != range.second; it++) {
+		auto &entry = *it->second;
+		if (entry.query == query && entry.config == config) {
+			return it->second;
+		}
+	}
+	return entries.end();
+}
+
+void SnowflakeResultCache::Erase(std::list<Entry>::iterator entry) {
+	auto range = index.equal_range(HashKey(entry->config, entry->query));
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second == entry) {
+			index.erase(it);
+			break;
+		}
+	}
+	entries.erase(entry);
+}
+
+shared_ptr<const SnowflakePersistedResult> SnowflakeResultCache::Get(const SnowflakeConfig &config,
+                                                                     const string &query) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry == entries.end()) {
+		return nullptr;
+	}
+	auto age = std::chrono::steady_clock::now() - entry->recorded_at;
+	if (age >= std::chrono::seconds(RETENTION_SECONDS)) {
+		Erase(entry);
+		return nullptr;
+	}
+	entries.splice(entries.begin(), entries, entry);
+	return entry->result;
+}
+
+void SnowflakeResultCache::Put(const SnowflakeConfig &config, const string &query,
+                               shared_ptr<const SnowflakePersistedResult> result) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry != entries.end()) {
+		entry->result = std::move(result);
+		entry->recorded_at = std::chrono::steady_clock::now();
+		entries.splice(entries.begin(), entries, entry);
+		return;
+	}
+	DPRINT("Recording Snowflake query %s for %s\n", result->query_id.c_str(), query.c_str());
+	entries.push_front(Entry {config, query, std::move(result), std::chrono::steady_clock::now()});
+	index.emplace(HashKey(config, query), entries.begin());
+	if (entries.size() > CAPACITY) {
+		Erase(std::prev(entries.end()));
+	}
+}
+
+void SnowflakeResultCache::Invalidate(const SnowflakeConfig &config, const string &query) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry == entries.end()) {
+		return;
+	}
+	DPRINT("Dropping the recorded result of %s\n", query.c_str());
+	Erase(entry);
+}
+
+} // namespace snowflake
+} // namespace duckdb
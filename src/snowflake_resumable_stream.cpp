@@ -0,0 +1,287 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_resumable_stream.hpp"
+#include "snowflake_retry.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/main/client_context.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+namespace duckdb {
+namespace snowflake {
+
+string GenerateScanQueryTag(const SnowflakeConfig &config) {
+	auto scan_tag = "duckdb_scan_" + UUID::ToString(UUID::GenerateRandomUUID());
+	// The statement tag replaces the session's, so a tag the user set through the session parameters is kept
+	// in front of the scan's
+	for (auto &entry : config.session_parameters) {
+		if (StringUtil::CIEquals(entry.first, "QUERY_TAG") && !entry.second.empty()) {
+			return entry.second + " " + scan_tag;
+		}
+	}
+	return scan_tag;
+}
+
+idx_t GetInjectedStreamFailure(ClientContext &context) {
+#ifdef SNOWFLAKE_TEST_HOOKS
+	Value value;
+	if (context.TryGetCurrentSetting("snowflake_inject_stream_failure", value) && !value.IsNull()) {
+		return UBigIntValue::Get(value);
+	}
+#endif
+	return 0;
+}
+
+// Drop the first `offset` rows of a record batch by moving the column offsets
+static void SliceRecordBatch(ArrowArray &batch, int64_t offset) {
+	batch.length -= offset;
+	for (int64_t col_idx = 0; col_idx < batch.n_children; col_idx++) {
+		auto &child = *batch.children[col_idx];
+		child.offset += offset;
+		child.length -= offset;
+		// Unknown after slicing - consumers recompute it from the validity buffer
+		child.null_count = -1;
+	}
+}
+
+// Keep only the first `length` rows of a record batch
+static void TruncateRecordBatch(ArrowArray &batch, int64_t length) {
+	batch.length = length;
+	for (int64_t col_idx = 0; col_idx < batch.n_children; col_idx++) {
+		auto &child = *batch.children[col_idx];
+		child.length = length;
+		child.null_count = -1;
+	}
+}
+
+struct SnowflakeResumableStream {
+	SnowflakeResumableStream(ArrowArrayStream &inner_p, shared_ptr<SnowflakeClient> connection_p,
+	                         const string &query_tag_p, idx_t inject_failure_after_p)
+	    : inner(inner_p), connection(std::move(connection_p)), query_tag(query_tag_p),
+	      inject_failure_after(inject_failure_after_p) {
+		std::memset(&inner_p, 0, sizeof(inner_p));
+		std::memset(&resume_statement, 0, sizeof(resume_statement));
+		std::memset(&pending_batch, 0, sizeof(pending_batch));
+	}
+
+	~SnowflakeResumableStream() {
+		if (pending_batch.release) {
+			pending_batch.release(&pending_batch);
+		}
+		if (inner.release) {
+			inner.release(&inner);
+		}
+		ReleaseResumeStatement(resume_statement, resume_statement_initialized);
+	}
+
+	//! The stream currently being read - the original result or a RESULT_SCAN of it
+	ArrowArrayStream inner;
+	shared_ptr<SnowflakeClient> connection;
+	string query_tag;
+	//! Looked up from the query tag on the first failure
+	string query_id;
+	//! Rows handed to the consumer so far
+	idx_t rows_delivered = 0;
+	idx_t resume_attempts = 0;
+	//! Statement owning the RESULT_SCAN stream after a resume
+	AdbcStatement resume_statement;
+	bool resume_statement_initialized = false;
+	//! Session of resume_statement
+	shared_ptr<SnowflakeSession> resume_session;
+	//! Remainder of a batch that was partially skipped while resuming
+	ArrowArray pending_batch;
+	string last_error;
+	//! Row after which the stream fails once (0: never), see snowflake_inject_stream_failure
+	idx_t inject_failure_after;
+	//! The rows up to the injected failure were handed out, the next batch fails
+	bool inject_failure_pending = false;
+
+	static void ReleaseResumeStatement(AdbcStatement &statement, bool &initialized) {
+		if (!initialized) {
+			return;
+		}
+		AdbcError error;
+		std::memset(&error, 0, sizeof(error));
+		AdbcStatementRelease(&statement, &error);
+		if (error.release) {
+			error.release(&error);
+		}
+		initialized = false;
+	}
+
+	void Resume() {
+		auto &config = connection->GetConfig();
+		auto backoff_ms = SnowflakeRetryBackoffMs(config, resume_attempts);
+		resume_attempts++;
+		LOG_WARN("Snowflake result stream failed after %llu rows, resuming via RESULT_SCAN in %llu ms: %s\n",
+		         static_cast<unsigned long long>(rows_delivered), static_cast<unsigned long long>(backoff_ms),
+		         last_error.c_str());
+		std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+
+		if (ClassifySnowflakeError(ErrorData(ExceptionType::IO, last_error)) == SnowflakeErrorClass::SESSION_EXPIRED) {
+			connection->Reconnect();
+		}
+		if (query_id.empty()) {
+			query_id = connection->GetQueryIdByTag(query_tag);
+		}
+
+		// Re-open the persisted result; this reads the result files, the query is not run again
+		AdbcStatement statement;
+		std::memset(&statement, 0, sizeof(statement));
+		bool statement_initialized = false;
+		ArrowArrayStream stream;
+		std::memset(&stream, 0, sizeof(stream));
+		shared_ptr<SnowflakeSession> session;
+		try {
+			AdbcError error;
+			std::memset(&error, 0, sizeof(error));
+			session = connection->GetSession();
+			auto status = AdbcStatementNew(&session->connection, &statement, &error);
+			SnowflakeClient::CheckError(status, "Failed to create RESULT_SCAN statement", &error);
+			statement_initialized = true;
+
+			auto result_scan_query = "SELECT * FROM TABLE(RESULT_SCAN('" + query_id + "'))";
+			status = AdbcStatementSetSqlQuery(&statement, result_scan_query.c_str(), &error);
+			SnowflakeClient::CheckError(status, "Failed to set RESULT_SCAN query", &error);
+
+			int64_t rows_affected = -1;
+			status = AdbcStatementExecuteQuery(&statement, &stream, &rows_affected, &error);
+			SnowflakeClient::CheckError(status, "Failed to execute RESULT_SCAN query", &error);
+
+			SkipDeliveredRows(stream);
+		} catch (...) {
+			if (stream.release) {
+				stream.release(&stream);
+			}
+			ReleaseResumeStatement(statement, statement_initialized);
+			throw;
+		}
+
+		// Swap in the new stream and the statement that owns it
+		if (inner.release) {
+			inner.release(&inner);
+		}
+		inner = stream;
+		ReleaseResumeStatement(resume_statement, resume_statement_initialized);
+		resume_statement = statement;
+		resume_statement_initialized = true;
+		resume_session = std::move(session);
+		DPRINT("Resumed Snowflake query %s at row %llu\n", query_id.c_str(),
+		       static_cast<unsigned long long>(rows_delivered));
+	}
+
+	void SkipDeliveredRows(ArrowArrayStream &stream) {
+		auto remaining = static_cast<int64_t>(rows_delivered);
+		while (remaining > 0) {
+			ArrowArray batch;
+			std::memset(&batch, 0, sizeof(batch));
+			if (stream.get_next(&stream, &batch) != 0) {
+				const char *message = stream.get_last_error ? stream.get_last_error(&stream) : nullptr;
+				throw IOException("Failed to read RESULT_SCAN stream: %s", message ? message : "unknown error");
+			}
+			if (!batch.release) {
+				throw IOException("RESULT_SCAN of query %s returned fewer rows than were already read", query_id);
+			}
+			if (batch.length <= remaining) {
+				remaining -= batch.length;
+				batch.release(&batch);
+				continue;
+			}
+			SliceRecordBatch(batch, remaining);
+			pending_batch = batch;
+			remaining = 0;
+		}
+	}
+};
+
+static SnowflakeResumableStream &GetResumableState(ArrowArrayStream *stream) {
+	return *reinterpret_cast<SnowflakeResumableStream *>(stream->private_data);
+}
+
+static int ResumableGetSchema(ArrowArrayStream *stream, ArrowSchema *out) {
+	auto &state = GetResumableState(stream);
+	return state.inner.get_schema(&state.inner, out);
+}
+
+static int ResumableGetNext(ArrowArrayStream *stream, ArrowArray *out) {
+	auto &state = GetResumableState(stream);
+	if (state.pending_batch.release) {
+		*out = state.pending_batch;
+		std::memset(&state.pending_batch, 0, sizeof(state.pending_batch));
+		state.rows_delivered += static_cast<idx_t>(out->length);
+		return 0;
+	}
+	while (true) {
+		int result = state.inject_failure_pending ? EIO : state.inner.get_next(&state.inner, out);
+		if (result == 0 && out->release && state.inject_failure_after > 0 &&
+		    state.rows_delivered + static_cast<idx_t>(out->length) > state.inject_failure_after) {
+			// Hand out the rows up to the injection point, the next batch fails
+			auto keep = static_cast<int64_t>(state.inject_failure_after - state.rows_delivered);
+			state.inject_failure_after = 0;
+			state.inject_failure_pending = true;
+			if (keep == 0) {
+				out->release(out);
+				result = EIO;
+			} else {
+				TruncateRecordBatch(*out, keep);
+			}
+		}
+		if (result == 0) {
+			if (out->release) {
+				state.rows_delivered += static_cast<idx_t>(out->length);
+			}
+			return 0;
+		}
+
+		if (state.inject_failure_pending) {
+			state.inject_failure_pending = false;
+			state.last_error = "Injected result stream failure after " + std::to_string(state.rows_delivered) + " rows";
+		} else {
+			const char *message = state.inner.get_last_error ? state.inner.get_last_error(&state.inner) : nullptr;
+			state.last_error = message ? message : "ArrowArrayStream returned error code " + std::to_string(result);
+		}
+		auto max_attempts = state.connection->GetConfig().max_retries;
+		if (max_attempts <= 0 || state.resume_attempts >= static_cast<idx_t>(max_attempts)) {
+			return result;
+		}
+		try {
+			state.Resume();
+		} catch (std::exception &ex) {
+			state.last_error += "\nResuming the result via RESULT_SCAN failed: " + ErrorData(ex).RawMessage();
+			return result;
+		}
+		if (state.pending_batch.release) {
+			return ResumableGetNext(stream, out);
+		}
+	}
+}
+
+static const char *ResumableGetLastError(ArrowArrayStream *stream) {
+	auto &state = GetResumableState(stream);
+	return state.last_error.c_str();
+}
+
+static void ResumableRelease(ArrowArrayStream *stream) {
+	if (!stream->release) {
+		return;
+	}
+	delete reinterpret_cast<SnowflakeResumableStream *>(stream->private_data);
+	stream->private_data = nullptr;
+	stream->release = nullptr;
+}
+
+void WrapResumableStream(ArrowArrayStream &stream, shared_ptr<SnowflakeClient> connection, const string &query_tag,
+                         idx_t inject_failure_after) {
+	auto state = new SnowflakeResumableStream(stream, std::move(connection), query_tag, inject_failure_after);
+	stream.private_data = state;
+	stream.get_schema = ResumableGetSchema;
+	stream.get_next = ResumableGetNext;
+	stream.get_last_error = ResumableGetLastError;
+	stream.release = ResumableRelease;
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,203 @@
+#include "snowflake_retry.hpp"
+
+#include "duckdb/common/string_util.hpp"
+
+#include <random>
+
+namespace duckdb {
+namespace snowflake {
+
+static bool ContainsAny(const string &haystack, const vector<string> &needles) {
+	for (const auto &needle : needles) {
+		if (haystack.find(needle) != string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+SnowflakeErrorClass ClassifySnowflakeError(const ErrorData &error) {
+	// Only driver/network failures are worth another attempt; binder, catalog,
+	// conversion errors and user interrupts are raised before or after talking to Snowflake
+	switch (error.Type()) {
+	case ExceptionType::IO:
+	case ExceptionType::CONNECTION:
+	case ExceptionType::NETWORK:
+	case ExceptionType::HTTP:
+		break;
+	default:
+		return SnowflakeErrorClass::PERMANENT;
+	}
+
+	auto message = StringUtil::Lower(error.RawMessage());
+
+	// 390111/390112: session no longer exists / expired, 390114: auth token expired
+	if (ContainsAny(message, {"390111", "390112", "390114", "session has expired", "session no longer exists",
+	                          "token has expired", "token is expired"})) {
+		return SnowflakeErrorClass::SESSION_EXPIRED;
+	}
+	// 000630: statement or warehouse timeout - running it again would hit the same limit
+	if (ContainsAny(message, {"000630", "statement reached its statement or warehouse timeout"})) {
+		return SnowflakeErrorClass::PERMANENT;
+	}
+	if (ContainsAny(message, {"too many requests", "status: 429", "status code 429", "throttl", "rate limit"})) {
+		return SnowflakeErrorClass::THROTTLED;
+	}
+	if (ContainsAny(message, {"connection reset", "connection refused", "connection closed", "broken pipe",
+	                          "i/o timeout", "timed out", "deadline exceeded", "unexpected eof", ": eof",
+	                          "tls handshake", "temporary failure", "no such host", "network is unreachable",
+	                          "service unavailable", "bad gateway", "gateway timeout", "status: 502", "status: 503",
+	                          "status: 504"})) {
+		return SnowflakeErrorClass::TRANSIENT;
+	}
+	return SnowflakeErrorClass::PERMANENT;
+}
+
+idx_t SnowflakeRetryBackoffMs(const SnowflakeConfig &config, idx_t attempt) {
+	idx_t base_ms = config.retry_backoff_ms > 0 ? static_cast<idx_t>(config.retry_backoff_ms) : 1;
+	idx_t ceiling_ms = base_ms;
+	for (idx_t i = 0; i < attempt && ceiling_ms < MAX_RETRY_BACKOFF_MS; i++) {
+		ceiling_ms *= 2;
+	}
+	ceiling_ms = MinValue<idx_t>(ceiling_ms, MAX_RETRY_BACKOFF_MS);
+
+	// Jitter keeps parallel scans that failed together from retrying in lockstep
+	static thread_local std::mt19937_64 generator(std::random_device {}());
+	std::uniform_int_distribution<idx_t> distribution(ceiling_ms / 2, ceiling_ms);
+	return distribution(generator);
+}
+
+static void SkipSpaces(const string &query, idx_t &pos) {
+	while (pos < query.size() && StringUtil::CharacterIsSpace(query[pos])) {
+		pos++;
+	}
+}
+
+static string ReadKeyword(const string &query, idx_t &pos) {
+	auto start = pos;
+	while (pos < query.size() && StringUtil::CharacterIsAlpha(query[pos])) {
+		pos++;
+	}
+	return StringUtil::Upper(query.substr(start, pos - start));
+}
+
+//! Skip an identifier, plain or double-quoted. Returns false if there is none at `pos`.
+static bool SkipIdentifier(const string &query, idx_t &pos) {
+	if (pos < query.size() && query[pos] == '"') {
+		for (pos++; pos < query.size(); pos++) {
+			if (query[pos] == '"') {
+				if (pos + 1 < query.size() && query[pos + 1] == '"') {
+					pos++;
+					continue;
+				}
+				pos++;
+				return true;
+			}
+		}
+		return false;
+	}
+	auto start = pos;
+	while (pos < query.size() && (StringUtil::CharacterIsAlphaNumeric(query[pos]) || query[pos] == '_' ||
+	                              query[pos] == '$')) {
+		pos++;
+	}
+	return pos > start;
+}
+
+//! Skip a parenthesized list starting at `pos`, including the string literals and quoted identifiers in it.
+//! Returns false if the parentheses are not balanced.
+static bool SkipParentheses(const string &query, idx_t &pos) {
+	idx_t depth = 0;
+	while (pos < query.size()) {
+		auto c = query[pos];
+		if (c == '\'' || c == '"') {
+			// Quotes are escaped by doubling them, and backslash escapes within string literals
+			for (pos++; pos < query.size(); pos++) {
+				if (c == '\'' && query[pos] == '\\') {
+					pos++;
+				} else if (query[pos] == c) {
+					if (pos + 1 < query.size() && query[pos + 1] == c) {
+						pos++;
+					} else {
+						break;
+					}
+				}
+			}
+		} else if (c == '(') {
+			depth++;
+		} else if (c == ')') {
+			if (depth == 0) {
+				return false;
+			}
+			depth--;
+			if (depth == 0) {
+				pos++;
+				return true;
+			}
+		}
+		pos++;
+	}
+	return false;
+}
+
+//! The keyword of the statement a WITH clause starting at `pos` (after WITH) belongs to, empty if the common
+//! table expressions cannot be followed to their end
+static string GetStatementAfterWith(const string &query, idx_t pos) {
+	SkipSpaces(query, pos);
+	auto recursive_pos = pos;
+	if (ReadKeyword(query, recursive_pos) == "RECURSIVE") {
+		pos = recursive_pos;
+	}
+	while (true) {
+		// name [(columns)] AS (query)
+		SkipSpaces(query, pos);
+		if (!SkipIdentifier(query, pos)) {
+			return string();
+		}
+		SkipSpaces(query, pos);
+		if (pos < query.size() && query[pos] == '(' && !SkipParentheses(query, pos)) {
+			return string();
+		}
+		SkipSpaces(query, pos);
+		if (ReadKeyword(query, pos) != "AS") {
+			return string();
+		}
+		SkipSpaces(query, pos);
+		if (pos >= query.size() || query[pos] != '(' || !SkipParentheses(query, pos)) {
+			// Not a subquery, e.g. an anonymous procedure (WITH name AS PROCEDURE ...)
+			return string();
+		}
+		SkipSpaces(query, pos);
+		if (pos < query.size() && query[pos] == ',') {
+			pos++;
+			continue;
+		}
+		break;
+	}
+	while (pos < query.size() && query[pos] == '(') {
+		pos++;
+		SkipSpaces(query, pos);
+	}
+	return ReadKeyword(query, pos);
+}
+
+bool IsIdempotentQuery(const string &query) {
+	auto trimmed = query;
+	StringUtil::Trim(trimmed);
+	// Skip leading parentheses, e.g. "(SELECT ...) UNION (...)"
+	idx_t start = 0;
+	while (start < trimmed.size() && (trimmed[start] == '(' || StringUtil::CharacterIsSpace(trimmed[start]))) {
+		start++;
+	}
+	idx_t end = start;
+	auto keyword = ReadKeyword(trimmed, end);
+	if (keyword == "WITH") {
+		// Common table expressions may also precede INSERT, MERGE or a procedure call
+		return GetStatementAfterWith(trimmed, end) == "SELECT";
+	}
+	return keyword == "SELECT" || keyword == "SHOW" || keyword == "DESCRIBE" || keyword == "DESC" ||
+	       keyword == "EXPLAIN" || keyword == "LIST" || keyword == "LS";
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -5,11 +5,17 @@
 #include "duckdb/common/string_util.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "duckdb/function/table/arrow.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "snowflake_client_manager.hpp"
 #include "snowflake_arrow_utils.hpp"
 #include "snowflake_config.hpp"
 #include "snowflake_secrets.hpp"
 #include "snowflake_debug.hpp"
+#include "snowflake_number_mapping.hpp"
+#include "snowflake_resumable_stream.hpp"
+#include "snowflake_scan_prefetch.hpp"
+#include "snowflake_schema_cache.hpp"
+#include "snowflake_timestamp_conversion.hpp"
 
 namespace duckdb {
 namespace snowflake {
@@ -34,12 +40,35 @@ static unique_ptr<FunctionData> SnowflakeScanBind(ClientContext &context, TableF
 		throw BinderException("Failed to retrieve credentials for profile '%s': %s", profile.c_str(), e.what());
 	}
 
+	// Named parameters override the fetch tuning and session parameters of the profile
+	auto number_mapping = SnowflakeNumberMapping::DECIMAL;
+	bool own_session = false;
+	for (auto &kv : input.named_parameters) {
+		auto loption = StringUtil::Lower(kv.first);
+		if (loption == "prefetch_concurrency") {
+			config.fetch_options.SetPrefetchConcurrency(kv.second.ToString());
+		} else if (loption == "result_queue_size") {
+			config.fetch_options.SetResultQueueSize(kv.second.ToString());
+		} else if (loption == "session_parameters") {
+			SnowflakeSecretsHelper::ParseSessionParameters(kv.second, config.session_parameters);
+		} else if (loption == "number_mapping") {
+			number_mapping = ParseNumberMapping("number_mapping", kv.second.ToString());
+			if (number_mapping == SnowflakeNumberMapping::NARROW) {
+				// The value ranges would have to be computed by running the query an extra time
+				throw BinderException("number_mapping 'narrow' is only supported for attached tables");
+			}
+		} else if (loption == "own_session") {
+			own_session = BooleanValue::Get(kv.second);
+		}
+	}
+
 	// Get client manager
 	auto &client_manager = SnowflakeClientManager::GetInstance();
 
 	shared_ptr<SnowflakeClient> connection;
 	try {
-		connection = client_manager.GetConnection(config);
+		// A pooled session of its own is released when the scan is done, the shared one is kept for the profile
+		connection = own_session ? client_manager.CreateConnection(config) : client_manager.GetConnection(config);
 	} catch (const std::exception &e) {
 		throw BinderException("Unexpected error connecting to Snowflake with profile '%s': %s", profile.c_str(),
 		                      e.what());
@@ -48,6 +77,13 @@ static unique_ptr<FunctionData> SnowflakeScanBind(ClientContext &context, TableF
 	// Create the factory that will manage the ADBC connection and statement
 	// This factory will be kept alive throughout the scan operation
 	auto factory = make_uniq<SnowflakeArrowStreamFactory>(connection, query);
+	factory->SetFetchOptions(config.fetch_options, TaskScheduler::GetScheduler(context).NumberOfThreads());
+	factory->inject_stream_failure = snowflake::GetInjectedStreamFailure(context);
+	if (input.inputs.size() > 2) {
+		// Arguments after the profile are bound to the ? markers of the query
+		vector<Value> parameters(input.inputs.begin() + 2, input.inputs.end());
+		factory->SetParameters(std::move(parameters), context.GetClientProperties());
+	}
 
 	// Create the bind data that inherits from ArrowScanFunctionData
 	// This allows us to use DuckDB's native Arrow scan implementation
@@ -57,15 +93,58 @@ static unique_ptr<FunctionData> SnowflakeScanBind(ClientContext &context, TableF
 	bind_data->factory->filter_pushdown_enabled = false;
 	bind_data->factory->projection_pushdown_enabled = false;
 
-	// Get the schema from Snowflake using ADBC's ExecuteSchema
-	// This executes the query with schema-only mode to get column information
-	SnowflakeGetArrowSchema(reinterpret_cast<ArrowArrayStream *>(bind_data->factory.get()),
-	                        bind_data->schema_root.arrow_schema);
-
-	// Use DuckDB's Arrow integration to populate the table type information
-	// This converts Arrow schema to DuckDB types and handles all type mappings
-	ArrowTableFunction::PopulateArrowTableSchema(DBConfig::GetConfig(context), bind_data->arrow_table,
-	                                             bind_data->schema_root.arrow_schema);
+	// Parameterized queries are cached with their prepared statement (SetParameters)
+	idx_t schema_cache_ttl = 0;
+	Value ttl_value;
+	if (input.inputs.size() == 2 && context.TryGetCurrentSetting("snowflake_schema_cache_ttl", ttl_value) &&
+	    !ttl_value.IsNull()) {
+		schema_cache_ttl = ttl_value.GetValue<uint64_t>();
+	}
+	auto &schema_cache = SnowflakeSchemaCache::GetInstance();
+	auto &factory_ref = *bind_data->factory;
+	shared_ptr<const SnowflakeCachedSchema> cached_schema;
+	if (schema_cache_ttl > 0) {
+		cached_schema = schema_cache.Get(connection->GetConfig(), query, schema_cache_ttl);
+	}
+	if (cached_schema) {
+		factory_ref.result_schema = cached_schema->schema;
+		factory_ref.result_schema_cached = true;
+		ShareArrowSchema(cached_schema->schema, bind_data->schema_root.arrow_schema);
+		bind_data->arrow_table = cached_schema->arrow_table;
+	} else {
+		// Get the schema from Snowflake using ADBC's ExecuteSchema
+		// This executes the query with schema-only mode to get column information
+		auto result_schema = make_shared_ptr<ArrowSchemaWrapper>();
+		SnowflakeGetArrowSchema(reinterpret_cast<ArrowArrayStream *>(&factory_ref), result_schema->arrow_schema);
+		ShareArrowSchema(result_schema, bind_data->schema_root.arrow_schema);
+
+		// Use DuckDB's Arrow integration to populate the table type information
+		// This converts Arrow schema to DuckDB types and handles all type mappings
+		ArrowTableFunction::PopulateArrowTableSchema(DBConfig::GetConfig(context), bind_data->arrow_table,
+		                                             bind_data->schema_root.arrow_schema);
+		if (schema_cache_ttl > 0) {
+			auto entry = make_shared_ptr<SnowflakeCachedSchema>();
+			entry->schema = std::move(result_schema);
+			entry->arrow_table = bind_data->arrow_table;
+			schema_cache.Put(connection->GetConfig(), query, std::move(entry));
+		}
+	}
+	auto &conversions = bind_data->factory->column_conversions;
+	conversions =
+	    ApplyTimestampTypes(bind_data->schema_root.arrow_schema, bind_data->arrow_table, config.timestamp_ns);
+	if (number_mapping != SnowflakeNumberMapping::DECIMAL) {
+		unordered_map<idx_t, LogicalType> target_types;
+		auto &arrow_columns = bind_data->arrow_table.GetColumns();
+		for (auto &entry : arrow_columns) {
+			if (IsDecimal128Column(*entry.second)) {
+				auto decimal_type = entry.second->GetDuckType();
+				target_types[entry.first] = GetNumberType(number_mapping, DecimalType::GetWidth(decimal_type),
+				                                          DecimalType::GetScale(decimal_type));
+			}
+		}
+		auto number_conversions = ApplyNumberTypes(bind_data->arrow_table, target_types);
+		conversions.insert(conversions.end(), number_conversions.begin(), number_conversions.end());
+	}
 	names = bind_data->arrow_table.GetNames();
 	return_types = bind_data->arrow_table.GetTypes();
 	bind_data->all_types = return_types;
@@ -74,19 +153,52 @@ static unique_ptr<FunctionData> SnowflakeScanBind(ClientContext &context, TableF
 	return std::move(bind_data);
 }
 
+// EXPLAIN shows whether the optimizer grouped the scan with the other scans of the plan
+static InsertionOrderPreservingMap<string> SnowflakeScanToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	result["Function"] = StringUtil::Upper(input.table_function.name);
+	if (!input.bind_data) {
+		return result;
+	}
+	auto &factory = *input.bind_data->Cast<SnowflakeScanBindData>().factory;
+	if (!factory.scan_group) {
+		return result;
+	}
+	if (factory.scan_group->IsPrefetched(factory)) {
+		result["Prefetched"] = "true";
+	}
+	if (factory.scan_group->IsShared(factory)) {
+		result["Shared Result"] = "true";
+	}
+	return result;
+}
+
 } // namespace snowflake
 
 TableFunction GetSnowflakeScanFunction() {
 	// Create a table function that uses DuckDB's native Arrow scan implementation
 	// We only provide our own bind function to set up the Snowflake connection
 	// All other operations (init_global, init_local, scan) use DuckDB's
-	// implementation Parameters: query (VARCHAR), profile (VARCHAR)
+	// implementation Parameters: query (VARCHAR), profile (VARCHAR), values of ? markers (ANY...)
 	TableFunction snowflake_query("snowflake_query", {LogicalType::VARCHAR, LogicalType::VARCHAR},
 	                              ArrowTableFunction::ArrowScanFunction,   // Use DuckDB's scan
 	                              snowflake::SnowflakeScanBind,            // Our bind function
 	                              ArrowTableFunction::ArrowScanInitGlobal, // Use DuckDB's init
 	                              ArrowTableFunction::ArrowScanInitLocal); // Use DuckDB's init
 
+	// Fetch tuning and session parameters (override the profile's settings)
+	snowflake_query.named_parameters["prefetch_concurrency"] = LogicalType::VARCHAR;
+	snowflake_query.named_parameters["result_queue_size"] = LogicalType::INTEGER;
+	snowflake_query.named_parameters["session_parameters"] =
+	    LogicalType::MAP(LogicalType::VARCHAR, LogicalType::VARCHAR);
+	// DuckDB type of NUMBER columns: 'decimal' (default), 'double' or 'hugeint'
+	snowflake_query.named_parameters["number_mapping"] = LogicalType::VARCHAR;
+	// Run on a pooled session of its own rather than the session shared by the scans of the profile
+	snowflake_query.named_parameters["own_session"] = LogicalType::BOOLEAN;
+	// Values for the ? markers of the query, e.g. snowflake_query('... WHERE id = ?', 'profile', 42)
+	snowflake_query.varargs = LogicalType::ANY;
+	snowflake_query.to_string = snowflake::SnowflakeScanToString;
+
 	// Disable pushdown for snowflake_query - user provides the query explicitly
 	snowflake_query.projection_pushdown = false;
 	snowflake_query.filter_pushdown = false;
@@ -112,6 +224,7 @@ TableFunction GetSnowflakeTableScanFunction(bool enable_pushdown) {
 	// Set pushdown flags based on the enable_pushdown parameter
 	table_scan.projection_pushdown = enable_pushdown;
 	table_scan.filter_pushdown = enable_pushdown;
+	table_scan.to_string = snowflake::SnowflakeScanToString;
 
 	return table_scan;
 }
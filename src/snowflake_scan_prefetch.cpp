@@ -0,0 +1,536 @@
+#include "snowflake_scan_prefetch.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_retry.hpp"
+#include "snowflake_scan.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/table_filter.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+
+namespace duckdb {
+namespace snowflake {
+
+//! The stream of a query submitted ahead of its scan, which keeps the statement it reads from alive
+class SnowflakePrefetchedStream : public ArrowArrayStreamWrapper {
+public:
+	SnowflakePrefetchedStream(unique_ptr<ArrowArrayStreamWrapper> stream,
+	                          unique_ptr<SnowflakeArrowStreamFactory> factory_p)
+	    : factory(std::move(factory_p)) {
+		arrow_array_stream = stream->arrow_array_stream;
+		number_of_rows = stream->number_of_rows;
+		stream->arrow_array_stream.release = nullptr;
+	}
+
+	~SnowflakePrefetchedStream() override {
+		// Before the statement is released with the factory
+		if (arrow_array_stream.release) {
+			arrow_array_stream.release(&arrow_array_stream);
+			arrow_array_stream.release = nullptr;
+		}
+	}
+
+private:
+	unique_ptr<SnowflakeArrowStreamFactory> factory;
+};
+
+//! Run `query` for the scan of `factory` on a pooled session of its own
+static std::future<unique_ptr<ArrowArrayStreamWrapper>> SubmitScanQuery(const SnowflakeArrowStreamFactory &factory,
+                                                                        const string &query) {
+	auto config = factory.connection->GetConfig();
+	auto base_query = factory.query;
+	auto conversions = factory.column_conversions;
+	auto assemblies = factory.struct_assemblies;
+	auto prefetch_concurrency = factory.prefetch_concurrency;
+	auto result_queue_size = factory.result_queue_size;
+	auto result_schema = factory.result_schema;
+	auto result_schema_cached = factory.result_schema_cached;
+	auto result_tables = factory.result_tables;
+	auto inject_stream_failure = factory.inject_stream_failure;
+	return std::async(std::launch::async, [=]() -> unique_ptr<ArrowArrayStreamWrapper> {
+		auto connection = SnowflakeClientManager::GetInstance().CreateConnection(config);
+		// The query already has the pushdown of the scan applied
+		auto prefetch = make_uniq<SnowflakeArrowStreamFactory>(std::move(connection), base_query);
+		prefetch->modified_query = query;
+		prefetch->column_conversions = conversions;
+		prefetch->struct_assemblies = assemblies;
+		prefetch->prefetch_concurrency = prefetch_concurrency;
+		prefetch->result_queue_size = result_queue_size;
+		prefetch->result_schema = result_schema;
+		prefetch->result_schema_cached = result_schema_cached;
+		prefetch->result_tables = result_tables;
+		prefetch->inject_stream_failure = inject_stream_failure;
+		ArrowStreamParameters parameters;
+		auto stream = SnowflakeProduceArrowScan(reinterpret_cast<uintptr_t>(prefetch.get()), parameters);
+		DPRINT("SnowflakeScanGroup: submitted %s\n", query.c_str());
+		return make_uniq<SnowflakePrefetchedStream>(std::move(stream), std::move(prefetch));
+	});
+}
+
+//! The result of a query that several scans of a plan read. Each record batch is fetched once by
+//! whichever reader gets to it first and kept until every reader has passed it.
+struct SnowflakeScanSpool {
+	SnowflakeScanSpool(std::future<unique_ptr<ArrowArrayStreamWrapper>> pending_p, idx_t reader_count)
+	    : pending(std::move(pending_p)), reader_positions(reader_count, 0) {
+	}
+
+	std::mutex lock;
+	//! The submitted query, until the first reader waits for it
+	std::future<unique_ptr<ArrowArrayStreamWrapper>> pending;
+	unique_ptr<ArrowArrayStreamWrapper> source;
+	shared_ptr<ArrowSchemaWrapper> schema;
+	//! The batches some reader has yet to read; the first is batch number first_batch of the result
+	std::deque<shared_ptr<ArrowArrayWrapper>> batches;
+	idx_t first_batch = 0;
+	bool exhausted = false;
+	//! Number of the next batch of each scan reading the result (DConstants::INVALID_INDEX once the
+	//! scan is done). Scans that have not started yet are at 0.
+	vector<idx_t> reader_positions;
+	idx_t readers_started = 0;
+	//! Failure of the query or its stream, reported to every reader
+	string error;
+
+	//! Wait for the query if no reader has yet (lock held)
+	bool Open() {
+		if (!error.empty()) {
+			return false;
+		}
+		if (!source) {
+			try {
+				source = pending.get();
+			} catch (std::exception &ex) {
+				error = ErrorData(ex).RawMessage();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//! Fetch the next batch of the result (lock held)
+	bool FetchBatch() {
+		auto &stream = source->arrow_array_stream;
+		auto batch = make_shared_ptr<ArrowArrayWrapper>();
+		if (stream.get_next(&stream, &batch->arrow_array) != 0) {
+			const char *message = stream.get_last_error ? stream.get_last_error(&stream) : nullptr;
+			error = message ? message : "Failed to read the shared Snowflake result";
+			return false;
+		}
+		if (!batch->arrow_array.release) {
+			exhausted = true;
+			return true;
+		}
+		batches.push_back(std::move(batch));
+		return true;
+	}
+
+	//! Drop the batches every reader has passed (lock held). A reader keeps the batch it was handed
+	//! until it releases it.
+	void ReleaseReadBatches() {
+		auto min_position = DConstants::INVALID_INDEX;
+		for (auto position : reader_positions) {
+			min_position = MinValue(min_position, position);
+		}
+		while (!batches.empty() && first_batch < min_position) {
+			batches.pop_front();
+			first_batch++;
+		}
+	}
+};
+
+//! A reader of a spooled result, the private data of its ArrowArrayStream
+struct SnowflakeSpoolReader {
+	shared_ptr<SnowflakeScanSpool> spool;
+	//! Index of the reader in spool->reader_positions
+	idx_t reader_idx;
+};
+
+static SnowflakeSpoolReader &GetSpoolReader(ArrowArrayStream *stream) {
+	return *reinterpret_cast<SnowflakeSpoolReader *>(stream->private_data);
+}
+
+static int SpoolGetSchema(ArrowArrayStream *stream, ArrowSchema *out) {
+	auto &spool = *GetSpoolReader(stream).spool;
+	std::lock_guard<std::mutex> guard(spool.lock);
+	if (!spool.Open()) {
+		return EIO;
+	}
+	if (!spool.schema) {
+		auto schema = make_shared_ptr<ArrowSchemaWrapper>();
+		auto &source = spool.source->arrow_array_stream;
+		if (source.get_schema(&source, &schema->arrow_schema) != 0) {
+			const char *message = source.get_last_error ? source.get_last_error(&source) : nullptr;
+			spool.error = message ? message : "Failed to read the schema of the shared Snowflake result";
+			return EIO;
+		}
+		spool.schema = std::move(schema);
+	}
+	ShareArrowSchema(spool.schema, *out);
+	return 0;
+}
+
+//! A batch handed to a reader: the arrays of the spooled batch, kept alive until the reader releases it
+static void SpoolBatchRelease(ArrowArray *array) {
+	delete reinterpret_cast<shared_ptr<ArrowArrayWrapper> *>(array->private_data);
+	array->release = nullptr;
+}
+
+static int SpoolGetNext(ArrowArrayStream *stream, ArrowArray *out) {
+	auto &reader = GetSpoolReader(stream);
+	auto &spool = *reader.spool;
+	std::lock_guard<std::mutex> guard(spool.lock);
+	if (!spool.Open()) {
+		return EIO;
+	}
+	auto &position = spool.reader_positions[reader.reader_idx];
+	while (position >= spool.first_batch + spool.batches.size()) {
+		if (spool.exhausted) {
+			std::memset(out, 0, sizeof(*out));
+			return 0;
+		}
+		if (!spool.FetchBatch()) {
+			return EIO;
+		}
+	}
+	auto batch = spool.batches[position - spool.first_batch];
+	position++;
+	*out = batch->arrow_array;
+	out->private_data = new shared_ptr<ArrowArrayWrapper>(std::move(batch));
+	out->release = SpoolBatchRelease;
+	spool.ReleaseReadBatches();
+	return 0;
+}
+
+static const char *SpoolGetLastError(ArrowArrayStream *stream) {
+	auto &spool = *GetSpoolReader(stream).spool;
+	std::lock_guard<std::mutex> guard(spool.lock);
+	return spool.error.empty() ? nullptr : spool.error.c_str();
+}
+
+static void SpoolRelease(ArrowArrayStream *stream) {
+	auto &reader = GetSpoolReader(stream);
+	{
+		// A scan that stops early (LIMIT) no longer holds back the batches it did not read
+		auto &spool = *reader.spool;
+		std::lock_guard<std::mutex> guard(spool.lock);
+		spool.reader_positions[reader.reader_idx] = DConstants::INVALID_INDEX;
+		spool.ReleaseReadBatches();
+	}
+	delete &reader;
+	stream->release = nullptr;
+}
+
+//! A reader of `spool`, or nullptr if all the scans it was planned for have started
+static unique_ptr<ArrowArrayStreamWrapper> CreateSpoolReader(shared_ptr<SnowflakeScanSpool> spool) {
+	idx_t reader_idx;
+	{
+		std::lock_guard<std::mutex> guard(spool->lock);
+		if (spool->readers_started >= spool->reader_positions.size()) {
+			// Batches may already have been dropped, the scan runs its query itself
+			return nullptr;
+		}
+		reader_idx = spool->readers_started++;
+	}
+	auto reader = make_uniq<SnowflakeSpoolReader>();
+	reader->spool = std::move(spool);
+	reader->reader_idx = reader_idx;
+	auto wrapper = make_uniq<ArrowArrayStreamWrapper>();
+	auto &stream = wrapper->arrow_array_stream;
+	stream.get_schema = SpoolGetSchema;
+	stream.get_next = SpoolGetNext;
+	stream.get_last_error = SpoolGetLastError;
+	stream.release = SpoolRelease;
+	stream.private_data = reader.release();
+	return wrapper;
+}
+
+//! Whether two scans running the same query produce the same batches, i.e. fetch through the same
+//! credentials and rewrite the same columns while fetching
+static bool SameScanResult(const SnowflakeArrowStreamFactory &left, const SnowflakeArrowStreamFactory &right) {
+	if (!(left.connection->GetConfig() == right.connection->GetConfig()) ||
+	    left.column_conversions.size() != right.column_conversions.size() ||
+	    left.struct_assemblies.size() != right.struct_assemblies.size()) {
+		return false;
+	}
+	for (idx_t i = 0; i < left.column_conversions.size(); i++) {
+		auto &left_conversion = left.column_conversions[i];
+		auto &right_conversion = right.column_conversions[i];
+		if (left_conversion.column_name != right_conversion.column_name ||
+		    left_conversion.layout != right_conversion.layout ||
+		    left_conversion.target_type != right_conversion.target_type ||
+		    left_conversion.scale != right_conversion.scale) {
+			return false;
+		}
+	}
+	for (idx_t i = 0; i < left.struct_assemblies.size(); i++) {
+		auto &left_assembly = left.struct_assemblies[i];
+		auto &right_assembly = right.struct_assemblies[i];
+		if (left_assembly.column_name != right_assembly.column_name ||
+		    left_assembly.field_names != right_assembly.field_names ||
+		    left_assembly.field_columns != right_assembly.field_columns) {
+			return false;
+		}
+	}
+	return true;
+}
+
+SnowflakeScanGroup::~SnowflakeScanGroup() {
+	// The futures wait for queries still being submitted
+	members.clear();
+	abandoned.clear();
+}
+
+void SnowflakeScanGroup::AddScan(const SnowflakeArrowStreamFactory &factory, vector<string> projection,
+                                 string query) {
+	ScanMember member;
+	member.factory = &factory;
+	member.projection = std::move(projection);
+	member.query = std::move(query);
+	member.source = members.size();
+	if (share) {
+		for (idx_t i = 0; i < members.size(); i++) {
+			auto &other = members[i];
+			if (other.source == i && other.query == member.query && SameScanResult(*other.factory, factory)) {
+				member.source = i;
+				other.shared = true;
+				break;
+			}
+		}
+	}
+	members.push_back(std::move(member));
+}
+
+bool SnowflakeScanGroup::HasWork() const {
+	if (prefetch && members.size() > 1) {
+		return true;
+	}
+	for (auto &member : members) {
+		if (member.shared) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const SnowflakeScanGroup::ScanMember *SnowflakeScanGroup::FindMember(const SnowflakeArrowStreamFactory &factory) const {
+	for (auto &member : members) {
+		if (member.factory == &factory) {
+			return &member;
+		}
+	}
+	return nullptr;
+}
+
+bool SnowflakeScanGroup::IsPrefetched(const SnowflakeArrowStreamFactory &factory) const {
+	return prefetch && members.size() > 1 && FindMember(factory);
+}
+
+bool SnowflakeScanGroup::IsShared(const SnowflakeArrowStreamFactory &factory) const {
+	auto member = FindMember(factory);
+	return member && members[member->source].shared;
+}
+
+unique_ptr<ArrowArrayStreamWrapper> SnowflakeScanGroup::StartScan(const SnowflakeArrowStreamFactory &factory,
+                                                                  const vector<string> &projection) {
+	std::future<unique_ptr<ArrowArrayStreamWrapper>> prefetched;
+	shared_ptr<SnowflakeScanSpool> spool;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		ScanMember *member = nullptr;
+		for (auto &entry : members) {
+			if (entry.factory == &factory) {
+				member = &entry;
+				break;
+			}
+		}
+		if (!member) {
+			return nullptr;
+		}
+		if (member->started) {
+			// The plan runs again (a prepared statement): results submitted for scans that did not
+			// run last time are stale
+			for (auto &entry : members) {
+				entry.started = false;
+				if (entry.prefetched.valid()) {
+					abandoned.push_back(std::move(entry.prefetched));
+				}
+				entry.spool.reset();
+			}
+		}
+		bool first_scan = true;
+		for (auto &entry : members) {
+			first_scan = first_scan && !entry.started;
+		}
+		member->started = true;
+		auto &source = members[member->source];
+		if (first_scan && prefetch) {
+			// One query per result, except the one this scan is about to run
+			for (idx_t i = 0; i < members.size(); i++) {
+				auto &entry = members[i];
+				if (entry.source != i || &entry == &source) {
+					continue;
+				}
+				try {
+					entry.prefetched = SubmitScanQuery(*entry.factory, entry.query);
+				} catch (std::exception &ex) {
+					// No thread for it: the scan runs its query when it starts
+					DPRINT("SnowflakeScanGroup: failed to submit %s: %s\n", entry.query.c_str(), ex.what());
+				}
+			}
+		}
+		if (member->projection != projection) {
+			return nullptr;
+		}
+		if (source.shared) {
+			if (!source.spool) {
+				auto pending = std::move(source.prefetched);
+				if (!pending.valid()) {
+					try {
+						pending = SubmitScanQuery(*source.factory, source.query);
+					} catch (std::exception &ex) {
+						DPRINT("SnowflakeScanGroup: failed to submit %s: %s\n", source.query.c_str(), ex.what());
+						return nullptr;
+					}
+				}
+				idx_t reader_count = 0;
+				for (auto &entry : members) {
+					if (entry.source == member->source) {
+						reader_count++;
+					}
+				}
+				source.spool = make_shared_ptr<SnowflakeScanSpool>(std::move(pending), reader_count);
+				DPRINT("SnowflakeScanGroup: sharing the result of %s\n", source.query.c_str());
+			}
+			spool = source.spool;
+		} else {
+			if (!source.prefetched.valid()) {
+				return nullptr;
+			}
+			prefetched = std::move(source.prefetched);
+		}
+	}
+	if (spool) {
+		return CreateSpoolReader(std::move(spool));
+	}
+	// Rethrows the error of the query, as running it here would have
+	return prefetched.get();
+}
+
+//! The columns the scan of `get` reads and the query it runs with the pushdown of the plan, or false
+//! if the scan cannot be submitted ahead of time
+static bool GetPlannedScanQuery(LogicalGet &get, SnowflakeScanBindData &bind_data, vector<string> &projection,
+                                string &query) {
+	auto &factory = *bind_data.factory;
+	if (factory.session_bound || !factory.parameters.empty()) {
+		return false;
+	}
+	// Like the arrow scan, which only passes the names of table columns
+	auto &schema = bind_data.schema_root.arrow_schema;
+	auto &column_ids = get.GetColumnIds();
+	for (auto &column_id : column_ids) {
+		auto col_idx = column_id.GetPrimaryIndex();
+		if (col_idx == COLUMN_IDENTIFIER_ROW_ID) {
+			continue;
+		}
+		if (col_idx >= NumericCast<idx_t>(schema.n_children)) {
+			return false;
+		}
+		projection.emplace_back(schema.children[col_idx]->name);
+	}
+	if (!factory.filter_pushdown_enabled && !factory.projection_pushdown_enabled) {
+		query = factory.modified_query;
+		return IsIdempotentQuery(query);
+	}
+	// The plan keys table filters by table column, the scan receives them by position in its columns.
+	// Filters DuckDB adds while the query runs (join and Top-N bounds) are not known yet; the
+	// operators above the scan apply them.
+	TableFilterSet filters;
+	for (auto &entry : get.table_filters.filters) {
+		optional_idx position;
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			if (column_ids[i].GetPrimaryIndex() == entry.first) {
+				position = i;
+				break;
+			}
+		}
+		if (!position.IsValid()) {
+			return false;
+		}
+		filters.filters[position.GetIndex()] = entry.second->Copy();
+	}
+	try {
+		query = factory.BuildPushdownQuery(projection, filters.filters.empty() ? nullptr : &filters);
+	} catch (std::exception &) {
+		// The scan fails with this error itself
+		return false;
+	}
+	return IsIdempotentQuery(query);
+}
+
+static void CollectSnowflakeScans(LogicalOperator &op, vector<reference<LogicalGet>> &scans) {
+	for (auto &child : op.children) {
+		CollectSnowflakeScans(*child, scans);
+	}
+	if (op.type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &get = op.Cast<LogicalGet>();
+	if ((get.function.name == "snowflake_table_scan" || get.function.name == "snowflake_query") && get.bind_data) {
+		scans.push_back(get);
+	}
+}
+
+static bool GetBooleanSetting(ClientContext &context, const string &name) {
+	Value value;
+	if (context.TryGetCurrentSetting(name, value) && !value.IsNull()) {
+		return BooleanValue::Get(value);
+	}
+	return false;
+}
+
+static void SnowflakeScanPrefetch(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	auto prefetch = GetBooleanSetting(input.context, "snowflake_prefetch_scans");
+	auto share = GetBooleanSetting(input.context, "snowflake_share_scans");
+	if (!prefetch && !share) {
+		return;
+	}
+	vector<reference<LogicalGet>> scans;
+	CollectSnowflakeScans(*plan, scans);
+	if (scans.size() < 2) {
+		return;
+	}
+	auto group = make_shared_ptr<SnowflakeScanGroup>(prefetch, share);
+	vector<reference<SnowflakeArrowStreamFactory>> grouped;
+	for (auto &get : scans) {
+		auto &bind_data = get.get().bind_data->Cast<SnowflakeScanBindData>();
+		auto &factory = *bind_data.factory;
+		bool seen = false;
+		for (auto &entry : grouped) {
+			seen = seen || &entry.get() == &factory;
+		}
+		vector<string> projection;
+		string query;
+		if (seen || !GetPlannedScanQuery(get.get(), bind_data, projection, query)) {
+			continue;
+		}
+		group->AddScan(factory, std::move(projection), std::move(query));
+		grouped.push_back(factory);
+	}
+	if (!group->HasWork()) {
+		return;
+	}
+	DPRINT("SnowflakeScanPrefetch: grouping %llu scans\n", grouped.size());
+	for (auto &factory : grouped) {
+		factory.get().scan_group = group;
+	}
+}
+
+OptimizerExtension GetSnowflakeScanPrefetchExtension() {
+	OptimizerExtension extension;
+	extension.optimize_function = SnowflakeScanPrefetch;
+	return extension;
+}
+
+} // namespace snowflake
+} // namespace duckdb
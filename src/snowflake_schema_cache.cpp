@@ -0,0 +1,87 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_schema_cache.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeSchemaCache &SnowflakeSchemaCache::GetInstance() {
+	static SnowflakeSchemaCache instance;
+	return instance;
+}
+
+static size_t HashKey(const SnowflakeConfig &config, const string &query) {
+	return SnowflakeConfigHash()(config) ^ (std::hash<string>()(query) << 1);
+}
+
+std::list<SnowflakeSchemaCache::Entry>::iterator SnowflakeSchemaCache::Find(const SnowflakeConfig &config,
+                                                                            const string &query) {
+	auto range = index.equal_range(HashKey(config, query));
+	for (auto it = range.first; it != range.second; it++) {
+		auto &entry = *it->second;
+		if (entry.query == query && entry.config == config) {
+			return it->second;
+		}
+	}
+	return entries.end();
+}
+
+shared_ptr<const SnowflakeCachedSchema> SnowflakeSchemaCache::Get(const SnowflakeConfig &config, const string &query,
+                                                                  idx_t ttl_seconds) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry == entries.end()) {
+		return nullptr;
+	}
+	auto age = std::chrono::steady_clock::now() - entry->cached_at;
+	if (age >= std::chrono::seconds(ttl_seconds)) {
+		return nullptr;
+	}
+	DPRINT("Reusing the cached result schema of %s\n", query.c_str());
+	entries.splice(entries.begin(), entries, entry);
+	return entry->schema;
+}
+
+void SnowflakeSchemaCache::Put(const SnowflakeConfig &config, const string &query,
+                               shared_ptr<const SnowflakeCachedSchema> schema) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry != entries.end()) {
+		entry->schema = std::move(schema);
+		entry->cached_at = std::chrono::steady_clock::now();
+		entries.splice(entries.begin(), entries, entry);
+		return;
+	}
+	entries.push_front(Entry {config, query, std::move(schema), std::chrono::steady_clock::now()});
+	index.emplace(HashKey(config, query), entries.begin());
+	if (entries.size() > CAPACITY) {
+		auto &oldest = entries.back();
+		auto range = index.equal_range(HashKey(oldest.config, oldest.query));
+		for (auto it = range.first; it != range.second; it++) {
+			if (&*it->second == &oldest) {
+				index.erase(it);
+				break;
+			}
+		}
+		entries.pop_back();
+	}
+}
+
+void SnowflakeSchemaCache::Invalidate(const SnowflakeConfig &config, const string &query) {
+	std::lock_guard<std::mutex> guard(lock);
+	auto entry = Find(config, query);
+	if (entry == entries.end()) {
+		return;
+	}
+	DPRINT("Dropping the cached result schema of %s\n", query.c_str());
+	auto range = index.equal_range(HashKey(config, query));
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second == entry) {
+			index.erase(it);
+			break;
+		}
+	}
+	entries.erase(entry);
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -1,4 +1,5 @@
 #include "snowflake_secret_provider.hpp"
+#include "snowflake_secrets.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/serializer/deserializer.hpp"
 #include "duckdb/common/serializer/serializer.hpp"
@@ -102,6 +103,55 @@ string SnowflakeSecret::GetPrivateKeyPassphrase() const {
 	return "";
 }
 
+string SnowflakeSecret::GetMaxRetries() const {
+	Value value;
+	if (TryGetValue("max_retries", value)) {
+		return value.ToString();
+	}
+	return "";
+}
+
+string SnowflakeSecret::GetRetryBackoffMs() const {
+	Value value;
+	if (TryGetValue("retry_backoff_ms", value)) {
+		return value.ToString();
+	}
+	return "";
+}
+
+string SnowflakeSecret::GetPrefetchConcurrency() const {
+	Value value;
+	if (TryGetValue("prefetch_concurrency", value)) {
+		return value.ToString();
+	}
+	return "";
+}
+
+string SnowflakeSecret::GetResultQueueSize() const {
+	Value value;
+	if (TryGetValue("result_queue_size", value)) {
+		return value.ToString();
+	}
+	return "";
+}
+
+bool SnowflakeSecret::GetTimestampNs() const {
+	Value value;
+	if (TryGetValue("timestamp_ns", value) && !value.IsNull()) {
+		return BooleanValue::Get(value.DefaultCastAs(LogicalType::BOOLEAN));
+	}
+	return false;
+}
+
+std::map<string, string> SnowflakeSecret::GetSessionParameters() const {
+	std::map<string, string> result;
+	Value value;
+	if (TryGetValue("session_parameters", value)) {
+		SnowflakeSecretsHelper::ParseSessionParameters(value, result);
+	}
+	return result;
+}
+
 //! Validate that all required fields are present
 void SnowflakeSecret::Validate() const {
 	vector<string> required_fields = {"user", "password", "account", "database"};
@@ -161,9 +211,22 @@ unique_ptr<BaseSecret> CreateSnowflakeSecret(ClientContext &context, CreateSecre
 	vector<string> required_fields = {"account", "database"};
 
 	// All possible optional fields
-	vector<string> optional_fields = {"user",        "password", "warehouse", "schema",
-	                                  "auth_type",   "token",    "okta_url",  "private_key_passphrase",
-	                                  "private_key", "role"};
+	vector<string> optional_fields = {"user",
+	                                  "password",
+	                                  "warehouse",
+	                                  "schema",
+	                                  "auth_type",
+	                                  "token",
+	                                  "okta_url",
+	                                  "private_key_passphrase",
+	                                  "private_key",
+	                                  "role",
+	                                  "max_retries",
+	                                  "retry_backoff_ms",
+	                                  "prefetch_concurrency",
+	                                  "result_queue_size",
+	                                  "session_parameters",
+	                                  "timestamp_ns"};
 
 	// Process required fields
 	for (const auto &field : required_fields) {
@@ -225,6 +288,19 @@ void RegisterSnowflakeSecretType(DatabaseInstance &instance) {
 	create_function.named_parameters["private_key"] = LogicalType::VARCHAR;
 	create_function.named_parameters["private_key_passphrase"] = LogicalType::VARCHAR;
 
+	// Retry behaviour for transient errors
+	create_function.named_parameters["max_retries"] = LogicalType::INTEGER;
+	create_function.named_parameters["retry_backoff_ms"] = LogicalType::INTEGER;
+
+	// Result fetch tuning and session parameters
+	create_function.named_parameters["prefetch_concurrency"] = LogicalType::VARCHAR;
+	create_function.named_parameters["result_queue_size"] = LogicalType::INTEGER;
+	create_function.named_parameters["session_parameters"] =
+	    LogicalType::MAP(LogicalType::VARCHAR, LogicalType::VARCHAR);
+
+	// DuckDB type of TIMESTAMP_NTZ columns with a scale above 6
+	create_function.named_parameters["timestamp_ns"] = LogicalType::BOOLEAN;
+
 	// Register the create function
 	secret_manager.RegisterSecretFunction(create_function, OnCreateConflict::ERROR_ON_CONFLICT);
 }
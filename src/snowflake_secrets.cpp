@@ -76,6 +76,25 @@ snowflake::SnowflakeConfig SnowflakeSecretsHelper::GetCredentials(ClientContext
 		// Note: schema is not stored in SnowflakeConfig as per the struct
 		// definition
 
+		auto max_retries = snowflake_secret->GetMaxRetries();
+		if (!max_retries.empty()) {
+			config.max_retries = std::stoi(max_retries);
+		}
+		auto retry_backoff_ms = snowflake_secret->GetRetryBackoffMs();
+		if (!retry_backoff_ms.empty()) {
+			config.retry_backoff_ms = std::stoi(retry_backoff_ms);
+		}
+		auto prefetch_concurrency = snowflake_secret->GetPrefetchConcurrency();
+		if (!prefetch_concurrency.empty()) {
+			config.fetch_options.SetPrefetchConcurrency(prefetch_concurrency);
+		}
+		auto result_queue_size = snowflake_secret->GetResultQueueSize();
+		if (!result_queue_size.empty()) {
+			config.fetch_options.SetResultQueueSize(result_queue_size);
+		}
+		config.session_parameters = snowflake_secret->GetSessionParameters();
+		config.timestamp_ns = snowflake_secret->GetTimestampNs();
+
 		// Extract authentication-specific fields
 		auto auth_type_str = snowflake_secret->GetAuthType();
 		LOG_INFO("GetCredentials: auth_type_str = '%s'\n", auth_type_str.c_str());
@@ -116,6 +135,31 @@ snowflake::SnowflakeConfig SnowflakeSecretsHelper::GetCredentials(ClientContext
 	return config;
 }
 
+void SnowflakeSecretsHelper::ParseSessionParameters(const Value &value,
+                                                    std::map<std::string, std::string> &session_parameters) {
+	if (value.IsNull()) {
+		return;
+	}
+	switch (value.type().id()) {
+	case LogicalTypeId::MAP:
+		for (auto &entry : MapValue::GetChildren(value)) {
+			auto &key_value = StructValue::GetChildren(entry);
+			session_parameters[key_value[0].ToString()] = key_value[1].ToString();
+		}
+		break;
+	case LogicalTypeId::STRUCT: {
+		auto &child_types = StructType::GetChildTypes(value.type());
+		auto &children = StructValue::GetChildren(value);
+		for (idx_t i = 0; i < children.size(); i++) {
+			session_parameters[child_types[i].first] = children[i].ToString();
+		}
+		break;
+	}
+	default:
+		throw InvalidInputException("session_parameters must be a MAP or STRUCT, e.g. MAP {'TIMEZONE': 'UTC'}");
+	}
+}
+
 // Delete a Snowflake credentials secret
 bool SnowflakeSecretsHelper::DeleteCredentials(ClientContext &context, const std::string &profile_name) {
 	try {
@@ -205,7 +249,8 @@ bool SnowflakeSecretsHelper::ValidateCredentials(ClientContext &context, const s
 			std::memset(&error_obj, 0, sizeof(error_obj));
 			std::memset(&statement, 0, sizeof(statement));
 
-			AdbcStatusCode status = AdbcStatementNew(connection->GetConnection(), &statement, &error_obj);
+			auto session = connection->GetSession();
+			AdbcStatusCode status = AdbcStatementNew(&session->connection, &statement, &error_obj);
 			if (status != ADBC_STATUS_OK) {
 				if (error_obj.release) {
 					error_obj.release(&error_obj);
@@ -285,7 +330,8 @@ bool SnowflakeSecretsHelper::ValidateCredentials(ClientContext &context, const s
 			std::memset(&error_obj, 0, sizeof(error_obj));
 			std::memset(&statement, 0, sizeof(statement));
 
-			AdbcStatusCode status = AdbcStatementNew(connection->GetConnection(), &statement, &error_obj);
+			auto session = connection->GetSession();
+			AdbcStatusCode status = AdbcStatementNew(&session->connection, &statement, &error_obj);
 			if (status != ADBC_STATUS_OK) {
 				if (error_obj.release) {
 					error_obj.release(&error_obj);
@@ -0,0 +1,210 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_timestamp_conversion.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table/arrow/arrow_type_info.hpp"
+
+#include <cstdlib>
+
+namespace duckdb {
+namespace snowflake {
+
+static bool HasStructField(const ArrowSchema &schema, const char *name) {
+	for (int64_t i = 0; i < schema.n_children; i++) {
+		if (schema.children[i]->name && StringUtil::CIEquals(schema.children[i]->name, name)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+vector<SnowflakeColumnConversion> ApplyTimestampTypes(const ArrowSchema &schema, ArrowTableSchema &arrow_table,
+                                                      bool timestamp_ns) {
+	vector<SnowflakeColumnConversion> conversions;
+	unordered_map<idx_t, shared_ptr<ArrowType>> replacements;
+	for (int64_t child_idx = 0; child_idx < schema.n_children; child_idx++) {
+		auto &field = *schema.children[child_idx];
+		string format = field.format ? field.format : "";
+		// The driver describes each field with Snowflake's type; the native layout uses logicalType/scale
+		auto logical_type = GetArrowFieldMetadata(field.metadata, "logicalType");
+		if (logical_type.empty()) {
+			logical_type = GetArrowFieldMetadata(field.metadata, "DATA_TYPE");
+		}
+		auto scale_text = GetArrowFieldMetadata(field.metadata, "scale");
+		if (scale_text.empty()) {
+			scale_text = GetArrowFieldMetadata(field.metadata, "SCALE");
+		}
+		bool with_time_zone;
+		auto upper_type = StringUtil::Upper(logical_type);
+		if (StringUtil::StartsWith(upper_type, "TIMESTAMP_NTZ")) {
+			with_time_zone = false;
+		} else if (StringUtil::StartsWith(upper_type, "TIMESTAMP_LTZ") ||
+		           StringUtil::StartsWith(upper_type, "TIMESTAMP_TZ")) {
+			with_time_zone = true;
+		} else if (upper_type.empty() && StringUtil::StartsWith(format, "tsn:") && format.size() > 4) {
+			// Nanosecond timestamp with a time zone but no Snowflake metadata
+			with_time_zone = true;
+		} else {
+			continue;
+		}
+		uint8_t scale = 9;
+		if (!scale_text.empty()) {
+			auto parsed_scale = std::strtoll(scale_text.c_str(), nullptr, 10);
+			scale = static_cast<uint8_t>(MinValue<int64_t>(MaxValue<int64_t>(parsed_scale, 0), 9));
+		}
+
+		SnowflakeColumnLayout layout;
+		if (StringUtil::StartsWith(format, "tsn:")) {
+			layout = SnowflakeColumnLayout::TIMESTAMP_NS;
+		} else if (format == "l") {
+			layout = SnowflakeColumnLayout::SCALED_INT64;
+		} else if (format == "+s" && HasStructField(field, "epoch")) {
+			layout = HasStructField(field, "fraction") ? SnowflakeColumnLayout::TIMESTAMP_STRUCT
+			                                           : SnowflakeColumnLayout::SCALED_INT64;
+		} else {
+			// Already a layout DuckDB reads directly (e.g. microsecond timestamps)
+			continue;
+		}
+
+		LogicalType target_type;
+		if (with_time_zone) {
+			target_type = LogicalType::TIMESTAMP_TZ;
+		} else {
+			// Sub-microsecond digits are truncated unless timestamp_ns is set
+			target_type = timestamp_ns && scale > 6 ? LogicalType::TIMESTAMP_NS : LogicalType::TIMESTAMP;
+		}
+		if (layout == SnowflakeColumnLayout::TIMESTAMP_NS && target_type.id() == LogicalTypeId::TIMESTAMP_NS) {
+			continue;
+		}
+		auto unit = target_type.id() == LogicalTypeId::TIMESTAMP_NS ? ArrowDateTimeType::NANOSECONDS
+		                                                            : ArrowDateTimeType::MICROSECONDS;
+		auto col_idx = static_cast<idx_t>(child_idx);
+		string column_name = field.name ? field.name : "";
+		DPRINT("Reading %s column %s as %s\n", logical_type.c_str(), column_name.c_str(),
+		       target_type.ToString().c_str());
+		replacements[col_idx] = make_shared_ptr<ArrowType>(target_type, make_uniq<ArrowDateTimeInfo>(unit));
+		if (layout == SnowflakeColumnLayout::TIMESTAMP_NS) {
+			// Arrow timestamps are already in nanoseconds, whatever the column's scale
+			scale = 9;
+		}
+		conversions.push_back(SnowflakeColumnConversion {column_name, layout, target_type, scale});
+	}
+	ReplaceArrowColumnTypes(arrow_table, replacements);
+	return conversions;
+}
+
+//===--------------------------------------------------------------------===//
+// Conversion kernels
+//===--------------------------------------------------------------------===//
+static int64_t PowerOfTen(idx_t exponent) {
+	int64_t result = 1;
+	for (idx_t i = 0; i < exponent; i++) {
+		result *= 10;
+	}
+	return result;
+}
+
+// The values of a flat int64 column or of one field of a struct column, indexed like the column's rows
+template <class T>
+static const T *GetValues(const ArrowArray &array, idx_t field_idx) {
+	if (array.n_children == 0) {
+		return static_cast<const T *>(array.buffers[1]);
+	}
+	auto &field = *array.children[field_idx];
+	return static_cast<const T *>(field.buffers[1]) + field.offset;
+}
+
+// Throw if a valid row of `values` overflows when multiplied by `factor`
+static void CheckScaledRange(const ArrowArray &array, const SnowflakeColumnConversion &conversion,
+                             const int64_t *values, int64_t factor) {
+	auto max_value = NumericLimits<int64_t>::Maximum() / factor;
+	auto min_value = NumericLimits<int64_t>::Minimum() / factor;
+	auto start = static_cast<idx_t>(array.offset);
+	for (idx_t row = start; row < start + static_cast<idx_t>(array.length); row++) {
+		if ((values[row] < min_value || values[row] > max_value) && IsValidArrowRow(array, row)) {
+			throw ConversionException("Timestamp in row %llu of Snowflake column %s is out of the range of %s",
+			                          static_cast<unsigned long long>(row - start), conversion.column_name,
+			                          conversion.target_type.ToString());
+		}
+	}
+}
+
+// target = values * factor. Unsigned multiplication keeps out-of-range rows defined; if there are
+// any, CheckScaledRange decides whether one of them is valid.
+static bool ScaleUp(const ArrowArray &array, const int64_t *values, int64_t *target, int64_t factor) {
+	auto start = static_cast<idx_t>(array.offset);
+	auto end = start + static_cast<idx_t>(array.length);
+	auto max_value = NumericLimits<int64_t>::Maximum() / factor;
+	auto min_value = NumericLimits<int64_t>::Minimum() / factor;
+	bool in_range = true;
+	for (idx_t row = start; row < end; row++) {
+		in_range &= (values[row] >= min_value) & (values[row] <= max_value);
+		target[row] = static_cast<int64_t>(static_cast<uint64_t>(values[row]) * static_cast<uint64_t>(factor));
+	}
+	return in_range;
+}
+
+// target = floor(values / divisor), so times before 1970 round down like DuckDB's own conversions
+static void ScaleDown(const ArrowArray &array, const int64_t *values, int64_t *target, int64_t divisor) {
+	auto start = static_cast<idx_t>(array.offset);
+	auto end = start + static_cast<idx_t>(array.length);
+	for (idx_t row = start; row < end; row++) {
+		auto quotient = values[row] / divisor;
+		target[row] = quotient - static_cast<int64_t>((values[row] % divisor) < 0);
+	}
+}
+
+void ConvertTimestampColumn(ArrowArray &array, const SnowflakeColumnConversion &conversion) {
+	bool is_struct = array.n_children > 0;
+	if ((is_struct && array.n_buffers < 1) || (!is_struct && (array.n_buffers != 2 || !array.buffers[1]))) {
+		throw InvalidInputException("Unexpected Arrow layout for timestamp column %s", conversion.column_name);
+	}
+	// Digits of the fraction of a second kept by the target type
+	idx_t target_digits = conversion.target_type.id() == LogicalTypeId::TIMESTAMP_NS ? 9 : 6;
+	auto row_count = static_cast<idx_t>(array.offset + array.length);
+	auto buffer = make_unsafe_uniq_array_uninitialized<data_t>(row_count * sizeof(int64_t));
+	auto target = reinterpret_cast<int64_t *>(buffer.get());
+
+	switch (conversion.layout) {
+	case SnowflakeColumnLayout::TIMESTAMP_NS:
+	case SnowflakeColumnLayout::SCALED_INT64: {
+		// Flat values, or the "epoch" field of a struct, scaled by 10^scale
+		auto values = GetValues<int64_t>(array, 0);
+		if (conversion.scale > target_digits) {
+			ScaleDown(array, values, target, PowerOfTen(conversion.scale - target_digits));
+			break;
+		}
+		auto factor = PowerOfTen(target_digits - conversion.scale);
+		if (!ScaleUp(array, values, target, factor)) {
+			CheckScaledRange(array, conversion, values, factor);
+		}
+		break;
+	}
+	case SnowflakeColumnLayout::TIMESTAMP_STRUCT: {
+		// Seconds since the epoch plus nanoseconds
+		if (array.n_children < 2) {
+			throw InvalidInputException("Unexpected Arrow layout for timestamp column %s", conversion.column_name);
+		}
+		auto epochs = GetValues<int64_t>(array, 0);
+		auto fractions = GetValues<int32_t>(array, 1);
+		auto factor = PowerOfTen(target_digits);
+		if (!ScaleUp(array, epochs, target, factor)) {
+			CheckScaledRange(array, conversion, epochs, factor);
+		}
+		auto fraction_divisor = static_cast<int32_t>(PowerOfTen(9 - target_digits));
+		auto start = static_cast<idx_t>(array.offset);
+		for (idx_t row = start; row < row_count; row++) {
+			auto fraction = static_cast<uint64_t>(fractions[row] / fraction_divisor);
+			target[row] = static_cast<int64_t>(static_cast<uint64_t>(target[row]) + fraction);
+		}
+		break;
+	}
+	default:
+		throw InternalException("Unsupported timestamp layout for column %s", conversion.column_name);
+	}
+	ReplaceColumnData(array, array.buffers[0], std::move(buffer));
+}
+
+} // namespace snowflake
+} // namespace duckdb
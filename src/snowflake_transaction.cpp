@@ -1,20 +1,167 @@
 #include "snowflake_transaction.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_query_builder.hpp"
+#include "storage/snowflake_catalog.hpp"
 #include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/client_context.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
 
 namespace duckdb {
 namespace snowflake {
 
-SnowflakeTransaction::SnowflakeTransaction(TransactionManager &manager, ClientContext &context)
-    : Transaction(manager, context) {
+SnowflakeTransaction::SnowflakeTransaction(TransactionManager &manager, ClientContext &context,
+                                           SnowflakeCatalog &catalog)
+    : Transaction(manager, context), config(catalog.GetConfig()), is_explicit(!context.transaction.IsAutoCommit()),
+      flush_threshold(catalog.GetOptions().insert_batch_size) {
 }
 
-SnowflakeTransactionManager::SnowflakeTransactionManager(AttachedDatabase &db) : TransactionManager(db) {
+SnowflakeTransaction::~SnowflakeTransaction() {
+	if (!connection) {
+		return;
+	}
+	// Ended without COMMIT or ROLLBACK reaching Snowflake (e.g. a failed commit); never hand a
+	// session with an open transaction back to the pool
+	try {
+		connection->Rollback();
+		ReleaseConnection();
+	} catch (std::exception &ex) {
+		ErrorData error(ex);
+		DPRINT("SnowflakeTransaction: failed to release session: %s\n", error.RawMessage().c_str());
+	}
+}
+
+SnowflakeTransaction &SnowflakeTransaction::Get(ClientContext &context, Catalog &catalog) {
+	return Transaction::Get(context, catalog).Cast<SnowflakeTransaction>();
+}
+
+bool SnowflakeTransaction::HasRemoteTransaction() {
+	lock_guard<mutex> guard(lock);
+	return connection != nullptr || !pending_inserts.empty();
+}
+
+shared_ptr<SnowflakeClient> SnowflakeTransaction::GetConnection() {
+	if (!is_explicit) {
+		return nullptr;
+	}
+	lock_guard<mutex> guard(lock);
+	FlushInternal();
+	return GetConnectionInternal();
+}
+
+string SnowflakeTransaction::GetSnapshotTimestamp() {
+	lock_guard<mutex> guard(lock);
+	if (snapshot_timestamp.empty()) {
+		snapshot_timestamp = SnowflakeClientManager::GetInstance().GetConnection(config)->GetCurrentTimestamp();
+		DPRINT("SnowflakeTransaction: reading the snapshot at %s\n", snapshot_timestamp.c_str());
+	}
+	return snapshot_timestamp;
+}
+
+shared_ptr<SnowflakeClient> SnowflakeTransaction::GetConnectionInternal() {
+	if (!connection) {
+		auto new_connection = SnowflakeClientManager::GetInstance().CreateConnection(config);
+		new_connection->SetAutoCommit(false);
+		connection = std::move(new_connection);
+		DPRINT("SnowflakeTransaction: started remote transaction\n");
+	}
+	return connection;
+}
+
+void SnowflakeTransaction::BufferInsert(const SnowflakeIngestTarget &target, const vector<string> &column_names,
+                                        DataChunk &chunk) {
+	D_ASSERT(is_explicit);
+	lock_guard<mutex> guard(lock);
+	optional_ptr<PendingInsert> pending;
+	for (auto &entry : pending_inserts) {
+		if (entry->target.ToString() == target.ToString() && entry->column_names == column_names) {
+			pending = entry.get();
+			break;
+		}
+	}
+	if (!pending) {
+		auto entry = make_uniq<PendingInsert>();
+		entry->target = target;
+		entry->column_names = column_names;
+		entry->rows = make_uniq<ColumnDataCollection>(Allocator::DefaultAllocator(), chunk.GetTypes());
+		pending = entry.get();
+		pending_inserts.push_back(std::move(entry));
+	}
+	pending->rows->Append(chunk);
+	if (pending->rows->Count() >= flush_threshold) {
+		FlushInsert(*pending);
+	}
+}
+
+void SnowflakeTransaction::FlushInsert(PendingInsert &pending) {
+	if (pending.rows->Count() == 0) {
+		return;
+	}
+	auto &target = pending.target;
+	string insert_prefix = "INSERT INTO " + target.database + "." + KeywordHelper::WriteQuoted(target.schema, '"') +
+	                       "." + KeywordHelper::WriteQuoted(target.table, '"') + " (";
+	for (idx_t i = 0; i < pending.column_names.size(); i++) {
+		insert_prefix += (i > 0 ? ", " : "") + KeywordHelper::WriteQuoted(pending.column_names[i], '"');
+	}
+	insert_prefix += ") VALUES ";
+
+	auto remote = GetConnectionInternal();
+	auto values_lists = SnowflakeQueryBuilder::BuildValuesLists(*pending.rows);
+	DPRINT("SnowflakeTransaction: flushing %llu rows into %s in %llu statements\n",
+	       static_cast<unsigned long long>(pending.rows->Count()), target.ToString().c_str(),
+	       static_cast<unsigned long long>(values_lists.size()));
+	pending.rows->Reset();
+	for (auto &values_list : values_lists) {
+		remote->ExecuteUpdate(insert_prefix + values_list);
+	}
+}
+
+void SnowflakeTransaction::FlushInternal() {
+	// Inserts are sent in the order their tables were first written to
+	for (auto &pending : pending_inserts) {
+		FlushInsert(*pending);
+	}
+	pending_inserts.clear();
+}
+
+void SnowflakeTransaction::Commit() {
+	lock_guard<mutex> guard(lock);
+	FlushInternal();
+	if (!connection) {
+		return;
+	}
+	connection->Commit();
+	DPRINT("SnowflakeTransaction: committed remote transaction\n");
+	ReleaseConnection();
+}
+
+void SnowflakeTransaction::Rollback() {
+	lock_guard<mutex> guard(lock);
+	pending_inserts.clear();
+	if (!connection) {
+		return;
+	}
+	connection->Rollback();
+	DPRINT("SnowflakeTransaction: rolled back remote transaction\n");
+	ReleaseConnection();
+}
+
+void SnowflakeTransaction::ReleaseConnection() {
+	if (!connection) {
+		return;
+	}
+	auto released = std::move(connection);
+	released->SetAutoCommit(true);
+}
+
+SnowflakeTransactionManager::SnowflakeTransactionManager(AttachedDatabase &db, SnowflakeCatalog &catalog)
+    : TransactionManager(db), catalog(catalog) {
 }
 
 Transaction &SnowflakeTransactionManager::StartTransaction(ClientContext &context) {
 	// Create a new transaction object (avoid recursive call to Transaction::Get)
-	auto transaction = make_uniq<SnowflakeTransaction>(*this, context);
+	auto transaction = make_uniq<SnowflakeTransaction>(*this, context, catalog);
 	auto &result = *transaction;
 	lock_guard<mutex> lock(transaction_lock);
 	transactions[result] = std::move(transaction);
@@ -22,14 +169,25 @@ Transaction &SnowflakeTransactionManager::StartTransaction(ClientContext &contex
 }
 
 ErrorData SnowflakeTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction) {
-	// For read-only external database, remove the transaction from our map
+	ErrorData result;
+	try {
+		transaction.Cast<SnowflakeTransaction>().Commit();
+	} catch (std::exception &ex) {
+		result = ErrorData(ex);
+	}
 	lock_guard<mutex> lock(transaction_lock);
 	transactions.erase(transaction);
-	return ErrorData();
+	return result;
 }
 
 void SnowflakeTransactionManager::RollbackTransaction(Transaction &transaction) {
-	// For read-only external database, remove the transaction from our map
+	try {
+		transaction.Cast<SnowflakeTransaction>().Rollback();
+	} catch (std::exception &ex) {
+		// The session is released either way; Snowflake drops the open transaction with it
+		ErrorData error(ex);
+		DPRINT("SnowflakeTransaction: rollback failed: %s\n", error.RawMessage().c_str());
+	}
 	lock_guard<mutex> lock(transaction_lock);
 	transactions.erase(transaction);
 }
@@ -41,7 +199,7 @@ void SnowflakeTransactionManager::Checkpoint(ClientContext &context, bool force)
 
 unique_ptr<TransactionManager> SnowflakeCreateTransactionManager(optional_ptr<StorageExtensionInfo> storage_info,
                                                                  AttachedDatabase &db, Catalog &catalog) {
-	return make_uniq<SnowflakeTransactionManager>(db);
+	return make_uniq<SnowflakeTransactionManager>(db, catalog.Cast<SnowflakeCatalog>());
 }
 
 } // namespace snowflake
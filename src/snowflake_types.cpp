@@ -1,181 +1,223 @@
 #include "snowflake_types.hpp"
+#include "snowflake_debug.hpp"
 #include "duckdb/common/string_util.hpp"
 #include "duckdb/common/exception/conversion_exception.hpp"
 
 namespace duckdb {
 namespace snowflake {
-LogicalType SnowflakeTypeToLogicalType(const std::string &snowflake_type_str) {
+// Parse the integer parameters of a type such as NUMBER(38,2) or TIMESTAMP_NTZ(9)
+static vector<int> ParseTypeParameters(const string &normalized_type, const string &snowflake_type_str) {
+	vector<int> result;
+	auto paren_pos = normalized_type.find('(');
+	if (paren_pos == string::npos) {
+		return result;
+	}
+	auto close_paren_pos = normalized_type.find(')', paren_pos);
+	if (close_paren_pos == string::npos) {
+		throw InvalidInputException("Expected closing ')' in type: " + snowflake_type_str);
+	}
+	auto params = normalized_type.substr(paren_pos + 1, close_paren_pos - paren_pos - 1);
+	for (auto &param : StringUtil::Split(params, ',')) {
+		try {
+			result.push_back(std::stoi(param));
+		} catch (const std::exception &e) {
+			throw ConversionException("Invalid type parameter '%s' in type: %s", param, snowflake_type_str);
+		}
+	}
+	return result;
+}
+
+static LogicalType ConvertNumber(const vector<int> &params, bool use_high_precision) {
+	// NUMBER, DECIMAL and NUMERIC default to NUMBER(38, 0); the integer aliases are always NUMBER(38, 0)
+	int precision = params.empty() ? 38 : params[0];
+	int scale = params.size() > 1 ? params[1] : 0;
+	if (precision < 1 || precision > 38) {
+		throw ConversionException("NUMBER precision %d out of range (1-38)", precision);
+	}
+	if (scale < 0 || scale > precision) {
+		throw ConversionException("NUMBER scale %d invalid (must be 0-%d)", scale, precision);
+	}
+	if (!use_high_precision) {
+		// The driver returns int64 for integers and float64 for everything else
+		return scale == 0 ? LogicalType::BIGINT : LogicalType::DOUBLE;
+	}
+	return LogicalType::DECIMAL(static_cast<uint8_t>(precision), static_cast<uint8_t>(scale));
+}
+
+static LogicalType ConvertTimestampNTZ(const vector<int> &params, bool timestamp_ns) {
+	// Same types as ApplyTimestampTypes binds for the column's scale (default 9)
+	int scale = params.empty() ? 9 : params[0];
+	if (scale < 0 || scale > 9) {
+		throw ConversionException("TIMESTAMP scale %d out of range (0-9)", scale);
+	}
+	return timestamp_ns && scale > 6 ? LogicalType::TIMESTAMP_NS : LogicalType::TIMESTAMP;
+}
+
+LogicalType SnowflakeTypeToLogicalType(const std::string &snowflake_type_str, bool use_high_precision,
+                                       bool timestamp_ns) {
 	string normalized_type = StringUtil::Upper(snowflake_type_str);
 	normalized_type = StringUtil::Replace(normalized_type, " ", "");
 
 	auto paren_pos = normalized_type.find('(');
 	string base_type = normalized_type.substr(0, paren_pos);
 
-	if (base_type.find("INT") != std::string::npos) {
-		if (base_type == "TINYINT") {
-			return LogicalType::TINYINT;
-		} else if (base_type == "SMALLINT") {
-			return LogicalType::SMALLINT;
-		} else if (base_type == "BIGINT") {
-			return LogicalType::BIGINT;
-		}
-		return LogicalType::INTEGER;
+	// Fixed-point numbers - every integer type is an alias of NUMBER(38, 0)
+	if (base_type == "NUMBER" || base_type == "DECIMAL" || base_type == "NUMERIC" || base_type == "FIXED") {
+		return ConvertNumber(ParseTypeParameters(normalized_type, snowflake_type_str), use_high_precision);
+	}
+	if (base_type == "INT" || base_type == "INTEGER" || base_type == "BIGINT" || base_type == "SMALLINT" ||
+	    base_type == "TINYINT" || base_type == "BYTEINT") {
+		return ConvertNumber({}, use_high_precision);
 	}
 
-	if (base_type == "VARCHAR" || base_type == "STRING") {
-		return LogicalType::VARCHAR;
+	// Floating point - Snowflake stores all of them as 64-bit doubles
+	if (base_type == "FLOAT" || base_type == "FLOAT4" || base_type == "FLOAT8" || base_type == "REAL" ||
+	    base_type == "DOUBLE" || base_type == "DOUBLEPRECISION") {
+		return LogicalType::DOUBLE;
 	}
 
+	if (base_type == "VARCHAR" || base_type == "STRING" || base_type == "TEXT" || base_type == "CHAR" ||
+	    base_type == "CHARACTER" || base_type == "NCHAR" || base_type == "NVARCHAR" || base_type == "NVARCHAR2" ||
+	    base_type == "CHARVARYING" || base_type == "NCHARVARYING") {
+		return LogicalType::VARCHAR;
+	}
+	if (base_type == "BINARY" || base_type == "VARBINARY") {
+		return LogicalType::BLOB;
+	}
 	if (base_type == "BOOLEAN") {
 		return LogicalType::BOOLEAN;
 	}
 
-	// Floating point types
-	if (base_type == "FLOAT" || base_type == "FLOAT4" || base_type == "REAL") {
-		return LogicalType::FLOAT;
+	// Date and time
+	if (base_type == "DATE") {
+		return LogicalType::DATE;
 	}
-
-	if (base_type == "DOUBLE" || base_type == "FLOAT8" || base_type == "DOUBLEPRECISION") {
-		return LogicalType::DOUBLE;
+	if (base_type == "TIME") {
+		return LogicalType::TIME;
 	}
-
-	// DECIMAL/NUMERIC types
-	if (base_type == "DECIMAL" || base_type == "NUMERIC") {
-		if (paren_pos == std::string::npos) {
-			// Default precision and scale for DECIMAL without parameters
-			return LogicalType::DECIMAL(18, 0);
-		}
-
-		auto close_paren_pos = normalized_type.find(')');
-		if (close_paren_pos == std::string::npos) {
-			throw InvalidInputException("Expected closing ')' for DECIMAL type: " + snowflake_type_str);
-		}
-
-		auto params = normalized_type.substr(paren_pos + 1, close_paren_pos - paren_pos - 1);
-		auto comma_pos = params.find(',');
-
-		int precision = 18; // Default precision
-		int scale = 0;      // Default scale
-
-		if (comma_pos == std::string::npos) {
-			// Only precision specified
-			try {
-				precision = std::stoi(params);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid precision '%s' in type: %s", params, snowflake_type_str);
-			}
-		} else {
-			// Both precision and scale specified
-			std::string precision_str = params.substr(0, comma_pos);
-			std::string scale_str = params.substr(comma_pos + 1);
-
-			try {
-				precision = std::stoi(precision_str);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid precision '%s' in type: %s", precision_str, snowflake_type_str);
-			}
-
-			try {
-				scale = std::stoi(scale_str);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid scale '%s' in type: %s", scale_str, snowflake_type_str);
-			}
-		}
-
-		if (precision < 1 || precision > 38) {
-			throw ConversionException("DECIMAL precision %d out of range (1-38)", precision);
-		}
-		if (scale < 0 || scale > precision) {
-			throw ConversionException("DECIMAL scale %d invalid (must be 0-%d)", scale, precision);
-		}
-
-		return LogicalType::DECIMAL(static_cast<uint8_t>(precision), static_cast<uint8_t>(scale));
+	if (base_type == "TIMESTAMP_NTZ" || base_type == "TIMESTAMPNTZ" || base_type == "TIMESTAMPWITHOUTTIMEZONE" ||
+	    base_type == "DATETIME" || base_type == "TIMESTAMP") {
+		// TIMESTAMP follows TIMESTAMP_TYPE_MAPPING, which defaults to TIMESTAMP_NTZ
+		return ConvertTimestampNTZ(ParseTypeParameters(normalized_type, snowflake_type_str), timestamp_ns);
+	}
+	if (base_type == "TIMESTAMP_LTZ" || base_type == "TIMESTAMPLTZ" || base_type == "TIMESTAMPWITHLOCALTIMEZONE" ||
+	    base_type == "TIMESTAMP_TZ" || base_type == "TIMESTAMPTZ" || base_type == "TIMESTAMPWITHTIMEZONE") {
+		// Both arrive as UTC instants; DuckDB displays them in the session time zone
+		return LogicalType::TIMESTAMP_TZ;
 	}
 
-	// NUMBER type (Snowflake's variable precision numeric)
-	if (base_type == "NUMBER") {
-		if (paren_pos == std::string::npos) {
-			// TODO create user setting to specify the behavior here. DOUBLE is
-			// relatively safe but loses precision for large decimals, and could
-			// possibly be losing out on performance.
-			return LogicalType::DOUBLE;
-		}
+	// Semi-structured and geospatial values are returned as JSON / GeoJSON text
+	if (base_type == "VARIANT" || base_type == "OBJECT" || base_type == "ARRAY" || base_type == "GEOGRAPHY" ||
+	    base_type == "GEOMETRY") {
+		return LogicalType::VARCHAR;
+	}
 
+	// VECTOR(INT, n) and VECTOR(FLOAT, n) hold 32-bit elements
+	if (base_type == "VECTOR") {
 		auto close_paren_pos = normalized_type.find(')');
-		if (close_paren_pos == std::string::npos) {
-			throw InvalidInputException("Expected closing ')' for NUMBER type: " + snowflake_type_str);
-		}
-
-		auto params = normalized_type.substr(paren_pos + 1, close_paren_pos - paren_pos - 1);
-
-		auto comma_pos = params.find(',');
-		int temp_precision = 0;
-		int temp_scale = 0;
-
-		if (comma_pos == std::string::npos) {
-			try {
-				temp_precision = std::stoi(params);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid precision '%s' in type: %s", params, snowflake_type_str);
-			}
-		} else {
-			std::string precision_str = params.substr(0, comma_pos);
-			std::string scale_str = params.substr(comma_pos + 1);
-
-			try {
-				temp_precision = std::stoi(precision_str);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid precision '%s' in type: %s", precision_str, snowflake_type_str);
-			}
-
-			try {
-				temp_scale = std::stoi(scale_str);
-			} catch (const std::exception &e) {
-				throw ConversionException("Invalid scale '%s' in type: %s", scale_str, snowflake_type_str);
-			}
+		if (paren_pos == string::npos || close_paren_pos == string::npos) {
+			throw InvalidInputException("Expected element type and dimension for VECTOR type: " + snowflake_type_str);
 		}
-
-		if (temp_precision < 1 || temp_precision > 38) {
-			throw ConversionException("NUMBER precision %d out of range (1-38)", temp_precision);
+		auto params = StringUtil::Split(normalized_type.substr(paren_pos + 1, close_paren_pos - paren_pos - 1), ',');
+		if (params.size() != 2) {
+			throw InvalidInputException("Expected element type and dimension for VECTOR type: " + snowflake_type_str);
 		}
-		if (temp_scale < 0 || temp_scale > temp_precision) {
-			throw ConversionException("NUMBER scale %d invalid (must be 0-%d)", temp_scale, temp_precision);
+		idx_t dimension;
+		try {
+			dimension = std::stoul(params[1]);
+		} catch (const std::exception &e) {
+			throw ConversionException("Invalid dimension '%s' in type: %s", params[1], snowflake_type_str);
 		}
-
-		uint8_t precision = static_cast<uint8_t>(temp_precision);
-		uint8_t scale = static_cast<uint8_t>(temp_scale);
-
-		return ConvertNumber(precision, scale);
+		auto element_type = params[0] == "FLOAT" ? LogicalType::FLOAT : LogicalType::INTEGER;
+		return LogicalType::ARRAY(element_type, dimension);
 	}
 
-	// TODO: Add more type mappings (TIMESTAMP_NTZ, TIMESTAMP_TZ, etc.)
-
-	return LogicalType::VARCHAR; // fallback type
+	DPRINT("Unknown Snowflake type %s, reading it as VARCHAR\n", snowflake_type_str.c_str());
+	return LogicalType::VARCHAR;
 }
 
-LogicalType ConvertNumber(uint8_t precision, uint8_t scale) {
-	// For integer types (scale = 0), map to appropriate integer type based on
-	// precision
-	if (scale == 0) {
-		if (precision <= 2) {
-			return LogicalType::TINYINT; // -128 to 127
-		}
-		if (precision <= 4) {
-			return LogicalType::SMALLINT; // -32,768 to 32,767
-		}
-		if (precision <= 9) {
-			return LogicalType::INTEGER; // -2,147,483,648 to 2,147,483,647
-		}
-		if (precision <= 18) {
-			return LogicalType::BIGINT; // -9,223,372,036,854,775,808 to
-			                            // 9,223,372,036,854,775,807
-		}
+string LogicalTypeToSnowflakeType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+		return "BOOLEAN";
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::UTINYINT:
+		return "NUMBER(3, 0)";
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::USMALLINT:
+		return "NUMBER(5, 0)";
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::UINTEGER:
+		return "NUMBER(10, 0)";
+	case LogicalTypeId::BIGINT:
+		return "NUMBER(19, 0)";
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::UHUGEINT:
+		return "NUMBER(38, 0)";
+	case LogicalTypeId::FLOAT:
+		return "FLOAT";
+	case LogicalTypeId::DOUBLE:
+		return "DOUBLE";
+	case LogicalTypeId::DECIMAL:
+		return StringUtil::Format("NUMBER(%d, %d)", DecimalType::GetWidth(type), DecimalType::GetScale(type));
+	case LogicalTypeId::BLOB:
+		return "BINARY";
+	case LogicalTypeId::DATE:
+		return "DATE";
+	case LogicalTypeId::TIME:
+		return "TIME(6)";
+	case LogicalTypeId::TIMESTAMP_SEC:
+		return "TIMESTAMP_NTZ(0)";
+	case LogicalTypeId::TIMESTAMP_MS:
+		return "TIMESTAMP_NTZ(3)";
+	case LogicalTypeId::TIMESTAMP:
+		return "TIMESTAMP_NTZ(6)";
+	case LogicalTypeId::TIMESTAMP_NS:
+		return "TIMESTAMP_NTZ(9)";
+	case LogicalTypeId::TIMESTAMP_TZ:
+		return "TIMESTAMP_TZ(6)";
+	case LogicalTypeId::UUID:
+		return "VARCHAR(36)";
+	default:
+		// VARCHAR, and everything that is written as text (INTERVAL, ENUM, nested types, ...)
+		return "VARCHAR";
 	}
+}
 
-	// For any type with scale > 0 or precision > 18, use DECIMAL to maintain
-	// exact precision This ensures no loss of precision for financial/monetary
-	// calculations
-	return LogicalType::DECIMAL(precision, scale);
+LogicalType GetSnowflakeIngestType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	case LogicalTypeId::DECIMAL:
+	case LogicalTypeId::VARCHAR:
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_SEC:
+	case LogicalTypeId::TIMESTAMP_MS:
+	case LogicalTypeId::TIMESTAMP_NS:
+	case LogicalTypeId::TIMESTAMP_TZ:
+		return type;
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+		return LogicalType::BIGINT;
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::UHUGEINT:
+		// NUMBER(38, 0) - values beyond 38 digits fail the cast instead of being truncated
+		return LogicalType::DECIMAL(38, 0);
+	default:
+		// UUID, INTERVAL, ENUM, nested types, ...
+		return LogicalType::VARCHAR;
+	}
 }
 } // namespace snowflake
 } // namespace duckdb
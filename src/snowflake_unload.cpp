@@ -0,0 +1,205 @@
+#include "snowflake_unload.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_execute.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+//! Unloaded files are split at this size, so there are enough of them to read in parallel
+static constexpr idx_t UNLOAD_MAX_FILE_SIZE = 256 * 1024 * 1024;
+
+struct SnowflakeUnloadGlobalState : public GlobalTableFunctionState {
+	~SnowflakeUnloadGlobalState() override {
+		Cleanup();
+	}
+
+	SnowflakeConfig config;
+	//! Table columns of the output columns; ROW_ID for a column no real one is needed for
+	vector<column_t> column_ids;
+	//! Stage path of the unloaded files, removed once the scan is done
+	string stage_path;
+	//! Local directory the files were downloaded to (empty: they are read from unload_location)
+	string local_directory;
+	DatabaseInstance *db = nullptr;
+	vector<string> files;
+	std::atomic<idx_t> next_file {0};
+
+	idx_t MaxThreads() const override {
+		return MaxValue<idx_t>(files.size(), 1);
+	}
+
+	void Cleanup() {
+		if (!stage_path.empty()) {
+			try {
+				RunSnowflakeStatement(config, "REMOVE " + stage_path);
+			} catch (std::exception &ex) {
+				DPRINT("Failed to remove the unloaded files at %s: %s\n", stage_path.c_str(), ex.what());
+			}
+			stage_path.clear();
+		}
+		if (!local_directory.empty() && db) {
+			try {
+				auto &fs = FileSystem::GetFileSystem(*db);
+				if (fs.DirectoryExists(local_directory)) {
+					fs.RemoveDirectory(local_directory);
+				}
+			} catch (std::exception &ex) {
+				DPRINT("Failed to remove %s: %s\n", local_directory.c_str(), ex.what());
+			}
+			local_directory.clear();
+		}
+	}
+};
+
+struct SnowflakeUnloadLocalState : public LocalTableFunctionState {
+	//! Reads the file being scanned; declared first so the result is released before it
+	unique_ptr<Connection> connection;
+	unique_ptr<QueryResult> result;
+};
+
+//! Directory downloaded files are kept in until the scan is done
+static string GetDownloadDirectory(ClientContext &context, FileSystem &fs, const string &unload_id) {
+	auto base = DBConfig::GetConfig(context).options.temporary_directory;
+	if (base.empty()) {
+		base = ".tmp";
+	}
+	if (!fs.IsPathAbsolute(base)) {
+		base = fs.JoinPath(FileSystem::GetWorkingDirectory(), base);
+	}
+	if (!fs.DirectoryExists(base)) {
+		fs.CreateDirectory(base);
+	}
+	return fs.JoinPath(base, "snowflake_unload_" + unload_id);
+}
+
+static unique_ptr<GlobalTableFunctionState> SnowflakeUnloadInitGlobal(ClientContext &context,
+                                                                      TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<SnowflakeUnloadBindData>();
+	auto state = make_uniq<SnowflakeUnloadGlobalState>();
+	state->config = bind_data.config;
+	state->db = &DatabaseInstance::GetDatabase(context);
+	state->column_ids = input.column_ids;
+
+	// Only the columns the query needs are unloaded, in the order of the output columns
+	vector<string> projection;
+	for (auto column_id : input.column_ids) {
+		if (!IsVirtualColumn(column_id)) {
+			projection.push_back(bind_data.names[column_id]);
+		}
+	}
+	if (projection.empty()) {
+		// e.g. COUNT(*): the files still need a row per row of the table
+		projection.push_back(bind_data.names[0]);
+	}
+	// Pushed-down filters refer to the output columns by position; only the matching rows are unloaded
+	vector<string> filter_columns;
+	for (auto column_id : input.column_ids) {
+		filter_columns.push_back(IsVirtualColumn(column_id) ? string() : bind_data.names[column_id]);
+	}
+	auto query = SnowflakeQueryBuilder::BuildQuery(bind_data.table_name, projection, input.filters.get(),
+	                                               filter_columns, nullptr, &bind_data.time_travel);
+
+	auto unload_id = StringUtil::Replace(UUID::ToString(UUID::GenerateRandomUUID()), "-", "");
+	state->stage_path = bind_data.options.stage + "/" + unload_id + "/";
+	auto unload = "COPY INTO " + state->stage_path + " FROM (" + query +
+	              ") FILE_FORMAT = (TYPE = PARQUET) HEADER = TRUE MAX_FILE_SIZE = " + to_string(UNLOAD_MAX_FILE_SIZE);
+	DPRINT("SnowflakeUnloadInitGlobal: %s\n", unload.c_str());
+	RunSnowflakeStatement(bind_data.config, unload);
+
+	auto &fs = FileSystem::GetFileSystem(context);
+	string file_pattern;
+	if (bind_data.options.location.empty()) {
+		state->local_directory = GetDownloadDirectory(context, fs, unload_id);
+		fs.CreateDirectory(state->local_directory);
+		RunSnowflakeStatement(bind_data.config, "GET " + state->stage_path + " " +
+		                                            KeywordHelper::WriteQuoted("file://" + state->local_directory + "/",
+		                                                                       '\''));
+		file_pattern = fs.JoinPath(state->local_directory, "*.parquet");
+	} else {
+		auto location = bind_data.options.location;
+		while (!location.empty() && location.back() == '/') {
+			location.pop_back();
+		}
+		file_pattern = location + "/" + unload_id + "/*.parquet";
+	}
+	for (auto &file : fs.GlobFiles(file_pattern, context, FileGlobOptions::ALLOW_EMPTY)) {
+		state->files.push_back(file.path);
+	}
+	DPRINT("SnowflakeUnloadInitGlobal: %llu files at %s\n", static_cast<unsigned long long>(state->files.size()),
+	       file_pattern.c_str());
+	return std::move(state);
+}
+
+static unique_ptr<LocalTableFunctionState> SnowflakeUnloadInitLocal(ExecutionContext &context,
+                                                                    TableFunctionInitInput &input,
+                                                                    GlobalTableFunctionState *global_state) {
+	auto &gstate = global_state->Cast<SnowflakeUnloadGlobalState>();
+	auto state = make_uniq<SnowflakeUnloadLocalState>();
+	state->connection = make_uniq<Connection>(*gstate.db);
+	return std::move(state);
+}
+
+static void SnowflakeUnloadScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &gstate = data.global_state->Cast<SnowflakeUnloadGlobalState>();
+	auto &lstate = data.local_state->Cast<SnowflakeUnloadLocalState>();
+	while (true) {
+		if (!lstate.result) {
+			auto file_idx = gstate.next_file++;
+			if (file_idx >= gstate.files.size()) {
+				return;
+			}
+			auto &file = gstate.files[file_idx];
+			lstate.result = lstate.connection->SendQuery("SELECT * FROM read_parquet(" +
+			                                             KeywordHelper::WriteQuoted(file, '\'') + ")");
+			if (lstate.result->HasError()) {
+				lstate.result->ThrowError();
+			}
+		}
+		auto chunk = lstate.result->Fetch();
+		if (!chunk || chunk->size() == 0) {
+			if (lstate.result->HasError()) {
+				lstate.result->ThrowError();
+			}
+			lstate.result.reset();
+			continue;
+		}
+		// The columns of the files are the unloaded columns, in the order of the output columns
+		idx_t file_column = 0;
+		for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
+			auto &target = output.data[col_idx];
+			if (IsVirtualColumn(gstate.column_ids[col_idx])) {
+				target.SetVectorType(VectorType::CONSTANT_VECTOR);
+				ConstantVector::SetNull(target, true);
+				continue;
+			}
+			auto &source = chunk->data[file_column++];
+			if (source.GetType() == target.GetType()) {
+				target.Reference(source);
+			} else {
+				VectorOperations::Cast(context, source, target, chunk->size());
+			}
+		}
+		output.SetCardinality(chunk->size());
+		return;
+	}
+}
+
+TableFunction GetSnowflakeUnloadScanFunction(bool enable_pushdown) {
+	TableFunction unload_scan("snowflake_unload_scan", {}, SnowflakeUnloadScan, nullptr, SnowflakeUnloadInitGlobal,
+	                          SnowflakeUnloadInitLocal);
+	unload_scan.projection_pushdown = true;
+	unload_scan.filter_pushdown = enable_pushdown;
+	return unload_scan;
+}
+
+} // namespace snowflake
+} // namespace duckdb
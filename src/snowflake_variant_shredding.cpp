@@ -0,0 +1,302 @@
+#include "snowflake_debug.hpp"
+#include "snowflake_variant_shredding.hpp"
+#include "snowflake_number_mapping.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table/arrow/arrow_type_info.hpp"
+#include "duckdb/parser/expression/case_expression.hpp"
+#include "duckdb/parser/expression/cast_expression.hpp"
+#include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/expression/comparison_expression.hpp"
+#include "duckdb/parser/expression/conjunction_expression.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/parser/expression/operator_expression.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+namespace snowflake {
+
+void SnowflakeVariantShredding::ParseColumns(const string &value) {
+	for (auto &column : StringUtil::Split(value, ',')) {
+		StringUtil::Trim(column);
+		if (!column.empty()) {
+			columns.insert(column);
+		}
+	}
+}
+
+bool SnowflakeVariantShredding::IsShredded(const string &table_name, const string &column_name) const {
+	return columns.find(table_name + "." + column_name) != columns.end() ||
+	       columns.find(column_name) != columns.end();
+}
+
+SnowflakeVariantFieldType InferVariantFieldType(const string &type_names) {
+	bool all_integer = true;
+	bool all_numeric = true;
+	case_insensitive_set_t types;
+	for (auto &type_name : StringUtil::Split(type_names, ',')) {
+		StringUtil::Trim(type_name);
+		// JSON null fits every field type
+		if (type_name.empty() || StringUtil::CIEquals(type_name, "NULL_VALUE")) {
+			continue;
+		}
+		types.insert(type_name);
+		all_integer = all_integer && StringUtil::CIEquals(type_name, "INTEGER");
+		all_numeric = all_numeric && (StringUtil::CIEquals(type_name, "INTEGER") ||
+		                              StringUtil::CIEquals(type_name, "DECIMAL") ||
+		                              StringUtil::CIEquals(type_name, "DOUBLE"));
+	}
+	if (types.empty()) {
+		return SnowflakeVariantFieldType::JSON;
+	}
+	if (all_integer) {
+		return SnowflakeVariantFieldType::BIGINT;
+	}
+	if (all_numeric) {
+		return SnowflakeVariantFieldType::DOUBLE;
+	}
+	if (types.size() == 1 && types.count("BOOLEAN")) {
+		return SnowflakeVariantFieldType::BOOLEAN;
+	}
+	if (types.size() == 1 && types.count("VARCHAR")) {
+		return SnowflakeVariantFieldType::VARCHAR;
+	}
+	return SnowflakeVariantFieldType::JSON;
+}
+
+vector<SnowflakeVariantField> GetVariantFields(const vector<std::pair<string, string>> &sampled_keys) {
+	vector<SnowflakeVariantField> fields;
+	case_insensitive_set_t field_names;
+	field_names.insert(VARIANT_OUTLIER_FIELD);
+	for (auto &entry : sampled_keys) {
+		if (entry.first.empty() || !field_names.insert(entry.first).second) {
+			continue;
+		}
+		fields.push_back(SnowflakeVariantField {entry.first, InferVariantFieldType(entry.second)});
+	}
+	return fields;
+}
+
+//===--------------------------------------------------------------------===//
+// Remote expressions
+//===--------------------------------------------------------------------===//
+static unique_ptr<ParsedExpression> MakeFunction(const string &name, unique_ptr<ParsedExpression> argument) {
+	vector<unique_ptr<ParsedExpression>> children;
+	children.push_back(std::move(argument));
+	return make_uniq<FunctionExpression>(name, std::move(children));
+}
+
+static unique_ptr<ParsedExpression> MakeFunction(const string &name, unique_ptr<ParsedExpression> first,
+                                                 unique_ptr<ParsedExpression> second,
+                                                 unique_ptr<ParsedExpression> third) {
+	vector<unique_ptr<ParsedExpression>> children;
+	children.push_back(std::move(first));
+	children.push_back(std::move(second));
+	children.push_back(std::move(third));
+	return make_uniq<FunctionExpression>(name, std::move(children));
+}
+
+// `value` (a VARIANT) as the type of the field, NULL where it holds another type
+static unique_ptr<ParsedExpression> GetTypedValue(const ParsedExpression &value, SnowflakeVariantFieldType type) {
+	string type_check;
+	unique_ptr<ParsedExpression> typed_value;
+	switch (type) {
+	case SnowflakeVariantFieldType::BIGINT:
+		// NUMBER(18, 0) always fits a BIGINT; larger integers end up in the outlier field
+		type_check = "is_integer";
+		typed_value = MakeFunction("try_to_number", make_uniq<CastExpression>(LogicalType::VARCHAR, value.Copy()),
+		                           make_uniq<ConstantExpression>(Value::INTEGER(18)),
+		                           make_uniq<ConstantExpression>(Value::INTEGER(0)));
+		break;
+	case SnowflakeVariantFieldType::DOUBLE:
+		type_check = "is_double";
+		typed_value = make_uniq<CastExpression>(LogicalType::DOUBLE, value.Copy());
+		break;
+	case SnowflakeVariantFieldType::BOOLEAN:
+		type_check = "is_boolean";
+		typed_value = make_uniq<CastExpression>(LogicalType::BOOLEAN, value.Copy());
+		break;
+	case SnowflakeVariantFieldType::VARCHAR:
+		type_check = "is_varchar";
+		typed_value = make_uniq<CastExpression>(LogicalType::VARCHAR, value.Copy());
+		break;
+	default:
+		return MakeFunction("to_json", value.Copy());
+	}
+	return MakeFunction("iff", MakeFunction(type_check, value.Copy()), std::move(typed_value),
+	                    make_uniq<ConstantExpression>(Value()));
+}
+
+SnowflakeColumnExpansion BuildVariantExpansion(const string &column_name, const vector<SnowflakeVariantField> &fields) {
+	SnowflakeColumnExpansion result;
+	ColumnRefExpression column(column_name);
+
+	auto flag = make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, column.Copy());
+	flag->alias = column_name;
+	result.select_list.push_back(std::move(flag));
+
+	vector<unique_ptr<ParsedExpression>> outlier_checks;
+	vector<unique_ptr<ParsedExpression>> delete_arguments;
+	delete_arguments.push_back(MakeFunction("as_object", column.Copy()));
+	for (auto &field : fields) {
+		// NULL for values that are not objects
+		vector<unique_ptr<ParsedExpression>> get_arguments;
+		get_arguments.push_back(MakeFunction("as_object", column.Copy()));
+		get_arguments.push_back(make_uniq<ConstantExpression>(Value(field.name)));
+		auto value = make_uniq<FunctionExpression>("get", std::move(get_arguments));
+		auto typed_value = GetTypedValue(*value, field.type);
+		if (field.type != SnowflakeVariantFieldType::JSON) {
+			// A value of another type; a JSON null is read as NULL
+			auto is_null_value = MakeFunction("is_null_value", value->Copy());
+			auto mismatch = make_uniq<ConjunctionExpression>(
+			    ExpressionType::CONJUNCTION_AND,
+			    make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NOT_NULL, value->Copy()),
+			    make_uniq<OperatorExpression>(ExpressionType::OPERATOR_NOT, std::move(is_null_value)));
+			mismatch->children.push_back(
+			    make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NULL, typed_value->Copy()));
+			outlier_checks.push_back(std::move(mismatch));
+		}
+		delete_arguments.push_back(make_uniq<ConstantExpression>(Value(field.name)));
+		result.fields[field.name] = typed_value->Copy();
+		typed_value->alias = column_name + "." + field.name;
+		result.select_list.push_back(std::move(typed_value));
+	}
+
+	// Keys that are not fields
+	unique_ptr<ParsedExpression> other_keys;
+	if (delete_arguments.size() == 1) {
+		other_keys = std::move(delete_arguments[0]);
+	} else {
+		other_keys = make_uniq<FunctionExpression>("object_delete", std::move(delete_arguments));
+	}
+	outlier_checks.insert(outlier_checks.begin(),
+	                      make_uniq<ComparisonExpression>(
+	                          ExpressionType::COMPARE_GREATERTHAN,
+	                          MakeFunction("array_size", MakeFunction("object_keys", std::move(other_keys))),
+	                          make_uniq<ConstantExpression>(Value::INTEGER(0))));
+	unique_ptr<ParsedExpression> is_outlier;
+	if (outlier_checks.size() == 1) {
+		is_outlier = std::move(outlier_checks[0]);
+	} else {
+		is_outlier = make_uniq<ConjunctionExpression>(ExpressionType::CONJUNCTION_OR, std::move(outlier_checks));
+	}
+
+	// CASE branches are evaluated in order, so the object functions only see objects
+	auto outlier_json = make_uniq<CaseExpression>();
+	CaseCheck null_check;
+	null_check.when_expr = make_uniq<OperatorExpression>(ExpressionType::OPERATOR_IS_NULL, column.Copy());
+	null_check.then_expr = make_uniq<ConstantExpression>(Value());
+	outlier_json->case_checks.push_back(std::move(null_check));
+	CaseCheck object_check;
+	object_check.when_expr =
+	    make_uniq<OperatorExpression>(ExpressionType::OPERATOR_NOT, MakeFunction("is_object", column.Copy()));
+	object_check.then_expr = MakeFunction("to_json", column.Copy());
+	outlier_json->case_checks.push_back(std::move(object_check));
+	CaseCheck outlier_check;
+	outlier_check.when_expr = std::move(is_outlier);
+	outlier_check.then_expr = MakeFunction("to_json", column.Copy());
+	outlier_json->case_checks.push_back(std::move(outlier_check));
+	outlier_json->else_expr = make_uniq<ConstantExpression>(Value());
+
+	result.fields[VARIANT_OUTLIER_FIELD] = outlier_json->Copy();
+	outlier_json->alias = column_name + "." + VARIANT_OUTLIER_FIELD;
+	result.select_list.push_back(std::move(outlier_json));
+	return result;
+}
+
+SnowflakeStructAssembly GetVariantAssembly(const string &column_name, const vector<SnowflakeVariantField> &fields) {
+	SnowflakeStructAssembly result;
+	result.column_name = column_name;
+	for (auto &field : fields) {
+		result.field_names.push_back(field.name);
+	}
+	result.field_names.push_back(VARIANT_OUTLIER_FIELD);
+	for (auto &field_name : result.field_names) {
+		result.field_columns.push_back(column_name + "." + field_name);
+	}
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// Result schema
+//===--------------------------------------------------------------------===//
+vector<SnowflakeColumnConversion> ApplyStructAssemblies(ArrowSchema &schema, ArrowTableSchema &arrow_table,
+                                                        const vector<SnowflakeStructAssembly> &assemblies) {
+	if (assemblies.empty()) {
+		return vector<SnowflakeColumnConversion>();
+	}
+	unordered_map<string, idx_t> column_indexes;
+	auto names = arrow_table.GetNames();
+	for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+		column_indexes[names[col_idx]] = col_idx;
+	}
+	auto get_column_index = [&](const string &column_name) {
+		auto entry = column_indexes.find(column_name);
+		if (entry == column_indexes.end()) {
+			throw InvalidInputException("The result is missing column %s of a shredded VARIANT column", column_name);
+		}
+		return entry->second;
+	};
+
+	// Integer fields arrive as NUMBER(18, 0), i.e. as decimal128 with use_high_precision
+	unordered_map<idx_t, LogicalType> target_types;
+	unordered_map<idx_t, idx_t> assembly_at;
+	unordered_set<idx_t> field_columns;
+	for (idx_t i = 0; i < assemblies.size(); i++) {
+		assembly_at[get_column_index(assemblies[i].column_name)] = i;
+		for (auto &field_column : assemblies[i].field_columns) {
+			auto col_idx = get_column_index(field_column);
+			field_columns.insert(col_idx);
+			if (IsDecimal128Column(*arrow_table.GetColumns().at(col_idx))) {
+				target_types[col_idx] = LogicalType::BIGINT;
+			}
+		}
+	}
+	auto conversions = ApplyNumberTypes(arrow_table, target_types);
+
+	if (static_cast<idx_t>(schema.n_children) != names.size()) {
+		throw InternalException("Arrow schema and bound columns of a shredded result differ");
+	}
+	auto &columns = arrow_table.GetColumns();
+	ArrowTableSchema result;
+	idx_t result_idx = 0;
+	// DuckDB names the projected columns by the schema child at their index: keep the children of the
+	// result columns first, in order, and the consumed field columns after them
+	vector<ArrowSchema *> result_children;
+	vector<ArrowSchema *> field_children;
+	for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+		if (field_columns.find(col_idx) != field_columns.end()) {
+			field_children.push_back(schema.children[col_idx]);
+			continue;
+		}
+		result_children.push_back(schema.children[col_idx]);
+		auto entry = assembly_at.find(col_idx);
+		if (entry == assembly_at.end()) {
+			result.AddColumn(result_idx++, columns.at(col_idx), names[col_idx]);
+			continue;
+		}
+		auto &assembly = assemblies[entry->second];
+		child_list_t<LogicalType> child_types;
+		vector<shared_ptr<ArrowType>> children;
+		for (idx_t field_idx = 0; field_idx < assembly.field_columns.size(); field_idx++) {
+			auto &child = columns.at(get_column_index(assembly.field_columns[field_idx]));
+			child_types.emplace_back(assembly.field_names[field_idx], child->GetDuckType());
+			children.push_back(child);
+		}
+		DPRINT("Reading %s as a STRUCT of %llu fields\n", assembly.column_name.c_str(),
+		       static_cast<unsigned long long>(children.size()));
+		auto struct_type = make_shared_ptr<ArrowType>(LogicalType::STRUCT(std::move(child_types)),
+		                                              make_uniq<ArrowStructInfo>(std::move(children)));
+		result.AddColumn(result_idx++, std::move(struct_type), assembly.column_name);
+	}
+	result_children.insert(result_children.end(), field_children.begin(), field_children.end());
+	std::copy(result_children.begin(), result_children.end(), schema.children);
+	arrow_table = std::move(result);
+	return conversions;
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -6,19 +6,59 @@
 namespace duckdb {
 namespace snowflake {
 
+static shared_ptr<SnowflakeClient> GetCatalogClient(const SnowflakeConfig &config, const SnowflakeOptions &options) {
+	auto &client_manager = SnowflakeClientManager::GetInstance();
+	if (options.async_connect) {
+		return client_manager.GetConnectionAsync(config);
+	}
+	return client_manager.GetConnection(config);
+}
+
 SnowflakeCatalog::SnowflakeCatalog(AttachedDatabase &db_p, const SnowflakeConfig &config,
                                    const SnowflakeOptions &options_p)
-    : Catalog(db_p), client(SnowflakeClientManager::GetInstance().GetConnection(config)), schemas(*this, client),
-      options(options_p) {
+    : Catalog(db_p), client(GetCatalogClient(config, options_p)), schemas(*this, client), options(options_p) {
 	DPRINT("SnowflakeCatalog constructor called\n");
-	if (!client || !client->IsConnected()) {
+	if (!client || (!options.async_connect && !client->IsConnected())) {
 		throw ConnectionException("Failed to connect to Snowflake");
 	}
-	DPRINT("SnowflakeCatalog connected successfully with enable_pushdown=%s\n",
-	       options.enable_pushdown ? "true" : "false");
+	if (!options.preload_schemas.empty()) {
+		warm_up_thread = std::thread([this]() { WarmUp(); });
+	}
+	DPRINT("SnowflakeCatalog created with enable_pushdown=%s, async_connect=%s\n",
+	       options.enable_pushdown ? "true" : "false", options.async_connect ? "true" : "false");
+}
+
+void SnowflakeCatalog::WarmUp() {
+	// Errors are not reported here: the sets stay unloaded and the first query
+	// that touches them retries the load and surfaces the error.
+	try {
+		vector<reference<SnowflakeSchemaEntry>> to_preload;
+		bool preload_all = options.preload_schemas.size() == 1 && options.preload_schemas[0] == "*";
+		if (preload_all) {
+			schemas.Scan([&](CatalogEntry &schema) { to_preload.push_back(schema.Cast<SnowflakeSchemaEntry>()); });
+		} else {
+			for (const auto &schema_name : options.preload_schemas) {
+				auto schema = schemas.GetEntry(schema_name);
+				if (!schema) {
+					DPRINT("WarmUp: schema %s not found, skipping\n", schema_name.c_str());
+					continue;
+				}
+				to_preload.push_back(schema->Cast<SnowflakeSchemaEntry>());
+			}
+		}
+		// Table lists are loaded outside of the schema set lock so lookups of other schemas are not blocked
+		for (auto &schema : to_preload) {
+			schema.get().PreloadTables();
+		}
+	} catch (const std::exception &e) {
+		DPRINT("SnowflakeCatalog warm-up failed: %s\n", e.what());
+	}
 }
 
 SnowflakeCatalog::~SnowflakeCatalog() {
+	if (warm_up_thread.joinable()) {
+		warm_up_thread.join();
+	}
 	// TODO consider adding option to allow connections to persist if user wants
 	// to DETACH and ATTACH multiple times
 	auto &client_manager = SnowflakeClientManager::GetInstance();
@@ -31,7 +71,7 @@ void SnowflakeCatalog::Initialize(bool load_builtin) {
 
 void SnowflakeCatalog::ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback) {
 	DPRINT("SnowflakeCatalog::ScanSchemas called\n");
-	schemas.Scan(context, [&](CatalogEntry &schema) {
+	schemas.Scan([&](CatalogEntry &schema) {
 		DPRINT("ScanSchemas callback for schema: %s\n", schema.name.c_str());
 		callback(schema.Cast<SchemaCatalogEntry>());
 	});
@@ -61,7 +101,7 @@ optional_ptr<SchemaCatalogEntry> SnowflakeCatalog::LookupSchema(CatalogTransacti
 		                      schema_name.c_str(), attached_db.c_str(), alias.c_str(), alias.c_str());
 	}
 
-	auto found_entry = schemas.GetEntry(transaction.GetContext(), schema_name);
+	auto found_entry = schemas.GetEntry(schema_name);
 	if (!found_entry && if_not_found == OnEntryNotFound::THROW_EXCEPTION) {
 		const auto &attached_db = client->GetConfig().database;
 		throw BinderException("Schema '%s' not found in attached database '%s'. To query a different "
@@ -93,25 +133,5 @@ string SnowflakeCatalog::GetDBPath() {
 	return config.account + "." + config.database;
 }
 
-PhysicalOperator &SnowflakeCatalog::PlanCreateTableAs(ClientContext &context, PhysicalPlanGenerator &planner,
-                                                      LogicalCreateTable &op, PhysicalOperator &plan) {
-	throw NotImplementedException("Snowflake catalog is read-only");
-}
-
-PhysicalOperator &SnowflakeCatalog::PlanInsert(ClientContext &context, PhysicalPlanGenerator &planner,
-                                               LogicalInsert &op, optional_ptr<PhysicalOperator> plan) {
-	throw NotImplementedException("Snowflake catalog is read-only");
-}
-
-PhysicalOperator &SnowflakeCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner,
-                                               LogicalDelete &op, PhysicalOperator &plan) {
-	throw NotImplementedException("Snowflake catalog is read-only");
-}
-
-PhysicalOperator &SnowflakeCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner,
-                                               LogicalUpdate &op, PhysicalOperator &plan) {
-	throw NotImplementedException("Snowflake catalog is read-only");
-}
-
 } // namespace snowflake
 } // namespace duckdb
@@ -3,8 +3,8 @@
 
 namespace duckdb {
 namespace snowflake {
-optional_ptr<CatalogEntry> SnowflakeCatalogSet::GetEntry(ClientContext &context, const string &name) {
-	TryLoadEntries(context);
+optional_ptr<CatalogEntry> SnowflakeCatalogSet::GetEntry(const string &name) {
+	TryLoadEntries();
 
 	lock_guard<mutex> lock(entry_lock);
 	// Case-insensitive lookup to match DuckDB convention
@@ -17,8 +17,8 @@ optional_ptr<CatalogEntry> SnowflakeCatalogSet::GetEntry(ClientContext &context,
 	return nullptr;
 }
 
-void SnowflakeCatalogSet::Scan(ClientContext &context, const std::function<void(CatalogEntry &)> &callback) {
-	TryLoadEntries(context);
+void SnowflakeCatalogSet::Scan(const std::function<void(CatalogEntry &)> &callback) {
+	TryLoadEntries();
 
 	lock_guard<mutex> lock(entry_lock);
 	for (const auto &entry : entries) {
@@ -26,12 +26,28 @@ void SnowflakeCatalogSet::Scan(ClientContext &context, const std::function<void(
 	}
 }
 
-void SnowflakeCatalogSet::TryLoadEntries(ClientContext &context) {
+optional_ptr<CatalogEntry> SnowflakeCatalogSet::CreateEntry(unique_ptr<CatalogEntry> entry) {
+	// Load first so a later lazy load does not run over the new entry
+	TryLoadEntries();
+
+	lock_guard<mutex> lock(entry_lock);
+	auto result = entry.get();
+	for (auto it = entries.begin(); it != entries.end(); ++it) {
+		if (StringUtil::CIEquals(it->first, entry->name)) {
+			entries.erase(it);
+			break;
+		}
+	}
+	entries[entry->name] = std::move(entry);
+	return result;
+}
+
+void SnowflakeCatalogSet::TryLoadEntries() {
 	lock_guard<mutex> lock(load_lock);
 	if (is_loaded) {
 		return;
 	}
-	LoadEntries(context);
+	LoadEntries();
 	is_loaded = true;
 }
 } // namespace snowflake
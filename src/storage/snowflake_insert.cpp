@@ -0,0 +1,573 @@
+#include "storage/snowflake_insert.hpp"
+#include "storage/snowflake_catalog.hpp"
+#include "storage/snowflake_schema_entry.hpp"
+#include "storage/snowflake_table_entry.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_ingest.hpp"
+#include "snowflake_query_builder.hpp"
+#include "snowflake_transaction.hpp"
+#include "snowflake_types.hpp"
+
+#include "duckdb/common/arrow/arrow_appender.hpp"
+#include "duckdb/common/arrow/arrow_type_extension.hpp"
+#include "duckdb/catalog/entry_lookup_info.hpp"
+#include "duckdb/common/types/uuid.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/execution/operator/projection/physical_projection.hpp"
+#include "duckdb/execution/physical_plan_generator.hpp"
+#include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/planner/expression/bound_cast_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/operator/logical_create_table.hpp"
+#include "duckdb/planner/operator/logical_insert.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeInsert::SnowflakeInsert(PhysicalPlan &physical_plan, LogicalOperator &op, TableCatalogEntry &table,
+                                 physical_index_vector_t<idx_t> column_index_map_p)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, op.types, 1), table(&table), schema(nullptr),
+      column_index_map(std::move(column_index_map_p)) {
+}
+
+SnowflakeInsert::SnowflakeInsert(PhysicalPlan &physical_plan, LogicalOperator &op, SchemaCatalogEntry &schema,
+                                 unique_ptr<BoundCreateTableInfo> info)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, op.types, 1), table(nullptr), schema(&schema),
+      info(std::move(info)) {
+}
+
+//===--------------------------------------------------------------------===//
+// States
+//===--------------------------------------------------------------------===//
+static string GetQualifiedName(const SnowflakeIngestTarget &target) {
+	return target.database + "." + KeywordHelper::WriteQuoted(target.schema, '"') + "." +
+	       KeywordHelper::WriteQuoted(target.table, '"');
+}
+
+class SnowflakeInsertGlobalState : public GlobalSinkState {
+public:
+	~SnowflakeInsertGlobalState() override {
+		// The insert failed before Finalize
+		DropStage();
+	}
+
+	SnowflakeConfig config;
+	//! Empty when CREATE TABLE IF NOT EXISTS found an existing table - nothing is inserted then
+	SnowflakeIngestTarget target;
+	//! The transient table the sink threads ingest into; applied to the target in Finalize
+	//! (empty table name inside a transaction)
+	SnowflakeIngestTarget stage;
+	//! Set inside BEGIN ... COMMIT: rows are written over the transaction's session
+	optional_ptr<SnowflakeTransaction> transaction;
+	//! Upserted rows collected inside a transaction, merged from a VALUES list in Finalize
+	mutex merge_rows_lock;
+	unique_ptr<ColumnDataCollection> merge_rows;
+	//! Names of the target columns, in the order of the input chunk
+	vector<string> column_names;
+	idx_t batch_size;
+	std::atomic<idx_t> insert_count {0};
+
+	void DropStage() {
+		if (stage.table.empty()) {
+			return;
+		}
+		auto stage_name = GetQualifiedName(stage);
+		stage.table.clear();
+		try {
+			auto connection = SnowflakeClientManager::GetInstance().GetConnection(config);
+			connection->ExecuteUpdate("DROP TABLE IF EXISTS " + stage_name);
+		} catch (std::exception &ex) {
+			ErrorData error(ex);
+			DPRINT("SnowflakeInsert: failed to drop staging table %s: %s\n", stage_name.c_str(),
+			       error.RawMessage().c_str());
+		}
+	}
+};
+
+class SnowflakeInsertLocalState : public LocalSinkState {
+public:
+	//! Each sink thread ingests over its own session so uploads run concurrently
+	shared_ptr<SnowflakeClient> connection;
+	unique_ptr<ArrowAppender> appender;
+	unique_ptr<SnowflakeIngestWriter> writer;
+};
+
+static string GetColumnList(const vector<string> &column_names) {
+	string result;
+	for (auto &column_name : column_names) {
+		result += (result.empty() ? "" : ", ") + KeywordHelper::WriteQuoted(column_name, '"');
+	}
+	return result;
+}
+
+static vector<string> GetInsertColumnNames(const SnowflakeInsert &insert, TableCatalogEntry &table) {
+	auto &columns = table.GetColumns();
+	vector<string> result;
+	if (insert.column_index_map.empty()) {
+		for (auto &column : columns.Physical()) {
+			result.push_back(column.Name());
+		}
+		return result;
+	}
+	// INSERT INTO tbl (b, a) - the input holds only the listed columns, in the listed order
+	idx_t column_count = 0;
+	vector<PhysicalIndex> column_indexes(columns.PhysicalColumnCount(), PhysicalIndex(DConstants::INVALID_INDEX));
+	for (idx_t c = 0; c < insert.column_index_map.size(); c++) {
+		auto column_index = PhysicalIndex(c);
+		auto mapped_index = insert.column_index_map[column_index];
+		if (mapped_index == DConstants::INVALID_INDEX) {
+			// Not inserted, Snowflake fills in the column default
+			continue;
+		}
+		column_indexes[mapped_index] = column_index;
+		column_count++;
+	}
+	for (idx_t c = 0; c < column_count; c++) {
+		result.push_back(columns.GetColumn(column_indexes[c]).Name());
+	}
+	return result;
+}
+
+unique_ptr<GlobalSinkState> SnowflakeInsert::GetGlobalSinkState(ClientContext &context) const {
+	auto result = make_uniq<SnowflakeInsertGlobalState>();
+	string stage_definition;
+	if (info) {
+		// CREATE TABLE AS - the table is created from the staged rows in Finalize
+		auto &base = info->Base();
+		auto &snowflake_catalog = schema->catalog.Cast<SnowflakeCatalog>();
+		auto table_name = SnowflakeQueryBuilder::NormalizeIdentifier(base.table);
+		EntryLookupInfo lookup(CatalogType::TABLE_ENTRY, table_name);
+		if (base.on_conflict == OnCreateConflict::IGNORE_ON_CONFLICT &&
+		    schema->LookupEntry(schema->catalog.GetCatalogTransaction(context), lookup)) {
+			// CREATE TABLE IF NOT EXISTS found an existing table - nothing is inserted
+			return std::move(result);
+		}
+		result->config = snowflake_catalog.GetConfig();
+		result->target.database = result->config.database;
+		result->target.schema = schema->name;
+		result->target.table = table_name;
+		string column_definitions;
+		for (auto &column : base.columns.Physical()) {
+			auto column_name = SnowflakeQueryBuilder::NormalizeIdentifier(column.Name());
+			column_definitions += (column_definitions.empty() ? "" : ", ") +
+			                      KeywordHelper::WriteQuoted(column_name, '"') + " " +
+			                      LogicalTypeToSnowflakeType(column.Type());
+			result->column_names.push_back(std::move(column_name));
+		}
+		result->batch_size = snowflake_catalog.GetOptions().insert_batch_size;
+		stage_definition = " (" + column_definitions + ") DATA_RETENTION_TIME_IN_DAYS = 0";
+	} else {
+		auto &target_table = *table;
+		auto &snowflake_table = target_table.Cast<SnowflakeTableEntry>();
+		auto &snowflake_catalog = target_table.catalog.Cast<SnowflakeCatalog>();
+
+		result->config = snowflake_table.GetConfig();
+		result->target.database = result->config.database;
+		result->target.schema = target_table.schema.name;
+		result->target.table = target_table.name;
+		result->column_names = GetInsertColumnNames(*this, target_table);
+		result->batch_size = snowflake_catalog.GetOptions().insert_batch_size;
+		auto &transaction = SnowflakeTransaction::Get(context, target_table.catalog);
+		if (transaction.IsExplicit()) {
+			// Creating a staging table is DDL, which would commit the Snowflake transaction
+			result->transaction = &transaction;
+			return std::move(result);
+		}
+		stage_definition = " DATA_RETENTION_TIME_IN_DAYS = 0 AS SELECT " + GetColumnList(result->column_names) +
+		                   " FROM " + GetQualifiedName(result->target) + " WHERE 1 = 0";
+	}
+	// Rows are uploaded to a staging table with the types of the inserted columns and applied to the
+	// target with a single statement in Finalize, so a failed insert leaves the target untouched. It is
+	// transient rather than temporary because the sink threads ingest over sessions of their own.
+	auto uuid = StringUtil::Replace(UUID::ToString(UUID::GenerateRandomUUID()), "-", "");
+	SnowflakeIngestTarget stage = result->target;
+	stage.table = "DUCKDB_STAGE_" + StringUtil::Upper(uuid);
+	auto connection = SnowflakeClientManager::GetInstance().GetConnection(result->config);
+	connection->ExecuteUpdate("CREATE TRANSIENT TABLE " + GetQualifiedName(stage) + stage_definition);
+	result->stage = std::move(stage);
+	DPRINT("SnowflakeInsert: inserting %llu columns into %s in batches of %llu rows\n",
+	       static_cast<unsigned long long>(result->column_names.size()), result->target.ToString().c_str(),
+	       static_cast<unsigned long long>(result->batch_size));
+	return std::move(result);
+}
+
+unique_ptr<LocalSinkState> SnowflakeInsert::GetLocalSinkState(ExecutionContext &context) const {
+	return make_uniq<SnowflakeInsertLocalState>();
+}
+
+//===--------------------------------------------------------------------===//
+// Sink
+//===--------------------------------------------------------------------===//
+static void FlushBatch(SnowflakeInsertLocalState &lstate) {
+	if (!lstate.appender || lstate.appender->RowCount() == 0) {
+		return;
+	}
+	auto batch = lstate.appender->Finalize();
+	lstate.appender.reset();
+	lstate.writer->Write(batch);
+}
+
+SinkResultType SnowflakeInsert::Sink(ExecutionContext &context, DataChunk &chunk, OperatorSinkInput &input) const {
+	auto &gstate = input.global_state.Cast<SnowflakeInsertGlobalState>();
+	auto &lstate = input.local_state.Cast<SnowflakeInsertLocalState>();
+	auto &types = children[0].get().types;
+	if (gstate.target.table.empty()) {
+		return SinkResultType::NEED_MORE_INPUT;
+	}
+	if (gstate.transaction) {
+		if (merge) {
+			lock_guard<mutex> guard(gstate.merge_rows_lock);
+			if (!gstate.merge_rows) {
+				gstate.merge_rows = make_uniq<ColumnDataCollection>(Allocator::DefaultAllocator(), types);
+			}
+			gstate.merge_rows->Append(chunk);
+		} else {
+			gstate.transaction->BufferInsert(gstate.target, gstate.column_names, chunk);
+		}
+		gstate.insert_count += chunk.size();
+		return SinkResultType::NEED_MORE_INPUT;
+	}
+
+	if (!lstate.writer) {
+		lstate.connection = SnowflakeClientManager::GetInstance().CreateConnection(gstate.config);
+		lstate.writer = make_uniq<SnowflakeIngestWriter>(lstate.connection, gstate.stage, types,
+		                                                 gstate.column_names, context.client.GetClientProperties());
+	}
+
+	idx_t offset = 0;
+	while (offset < chunk.size()) {
+		if (!lstate.appender) {
+			lstate.appender =
+			    make_uniq<ArrowAppender>(types, gstate.batch_size, context.client.GetClientProperties(),
+			                             ArrowTypeExtensionData::GetExtensionTypes(context.client, types));
+		}
+		auto space = gstate.batch_size - lstate.appender->RowCount();
+		auto append_count = MinValue<idx_t>(space, chunk.size() - offset);
+		lstate.appender->Append(chunk, offset, offset + append_count, chunk.size());
+		offset += append_count;
+		if (lstate.appender->RowCount() >= gstate.batch_size) {
+			FlushBatch(lstate);
+		}
+	}
+	return SinkResultType::NEED_MORE_INPUT;
+}
+
+SinkCombineResultType SnowflakeInsert::Combine(ExecutionContext &context, OperatorSinkCombineInput &input) const {
+	auto &gstate = input.global_state.Cast<SnowflakeInsertGlobalState>();
+	auto &lstate = input.local_state.Cast<SnowflakeInsertLocalState>();
+	if (!lstate.writer) {
+		// This thread did not receive any rows
+		return SinkCombineResultType::FINISHED;
+	}
+	FlushBatch(lstate);
+	gstate.insert_count += lstate.writer->Finish();
+	lstate.writer.reset();
+	lstate.connection.reset();
+	return SinkCombineResultType::FINISHED;
+}
+
+static string GetMergeQuery(const SnowflakeMergeInfo &merge, const SnowflakeInsertGlobalState &gstate,
+                            const string &source) {
+	string match_condition;
+	for (auto &key_column : merge.key_columns) {
+		auto quoted = KeywordHelper::WriteQuoted(key_column, '"');
+		match_condition += (match_condition.empty() ? "" : " AND ") + string("T.") + quoted + " = S." + quoted;
+	}
+	string query = "MERGE INTO " + GetQualifiedName(gstate.target) + " AS T USING " + source + " AS S ON " +
+	               match_condition;
+	if (!merge.assignments.empty()) {
+		query += " WHEN MATCHED";
+		if (!merge.update_condition.empty()) {
+			query += " AND " + merge.update_condition;
+		}
+		query += " THEN UPDATE SET " + StringUtil::Join(merge.assignments, ", ");
+	}
+	string insert_columns;
+	string insert_values;
+	for (auto &column_name : gstate.column_names) {
+		auto quoted = KeywordHelper::WriteQuoted(column_name, '"');
+		insert_columns += (insert_columns.empty() ? "" : ", ") + quoted;
+		insert_values += (insert_values.empty() ? "" : ", ") + string("S.") + quoted;
+	}
+	query += " WHEN NOT MATCHED THEN INSERT (" + insert_columns + ") VALUES (" + insert_values + ")";
+	return query;
+}
+
+// Snowflake does not enforce keys: a MERGE would insert every staged row of a new key, so staged rows
+// with the same key are rejected the way DuckDB rejects them
+static void ThrowIfDuplicateKey(const SnowflakeMergeInfo &merge, const vector<string> &duplicate_key) {
+	if (duplicate_key.empty()) {
+		return;
+	}
+	if (!merge.assignments.empty()) {
+		throw InvalidInputException("ON CONFLICT DO UPDATE can not update the same row twice in the same command. "
+		                            "Ensure that no rows proposed for insertion within the same command have "
+		                            "duplicate constrained values");
+	}
+	string key;
+	for (idx_t i = 0; i < merge.key_columns.size() && i < duplicate_key.size(); i++) {
+		key += (i > 0 ? ", " : "") + merge.key_columns[i] + ": " + duplicate_key[i];
+	}
+	throw ConstraintException("Duplicate key \"%s\" violates primary key constraint.", key);
+}
+
+static vector<string> FindDuplicateKey(const SnowflakeMergeInfo &merge, const SnowflakeInsertGlobalState &gstate) {
+	vector<idx_t> key_indexes;
+	for (auto &key_column : merge.key_columns) {
+		for (idx_t i = 0; i < gstate.column_names.size(); i++) {
+			if (gstate.column_names[i] == key_column) {
+				key_indexes.push_back(i);
+				break;
+			}
+		}
+	}
+	unordered_set<string> seen_keys;
+	for (auto &chunk : gstate.merge_rows->Chunks()) {
+		for (idx_t row = 0; row < chunk.size(); row++) {
+			vector<string> key;
+			string key_text;
+			bool has_null = false;
+			for (auto key_index : key_indexes) {
+				auto value = chunk.GetValue(key_index, row);
+				has_null = has_null || value.IsNull();
+				key.push_back(value.ToString());
+				key_text += to_string(key.back().size()) + ":" + key.back();
+			}
+			if (!has_null && !seen_keys.insert(key_text).second) {
+				return key;
+			}
+		}
+	}
+	return vector<string>();
+}
+
+SinkFinalizeType SnowflakeInsert::FinalizeTransactionMerge(SnowflakeInsertGlobalState &gstate) const {
+	if (!gstate.merge_rows) {
+		return SinkFinalizeType::READY;
+	}
+	ThrowIfDuplicateKey(*merge, FindDuplicateKey(*merge, gstate));
+	auto column_list = GetColumnList(gstate.column_names);
+	auto connection = gstate.transaction->GetConnection();
+	idx_t merged_rows = 0;
+	for (auto &values_list : SnowflakeQueryBuilder::BuildValuesLists(*gstate.merge_rows)) {
+		auto source = "(SELECT * FROM VALUES " + values_list + " AS V (" + column_list + "))";
+		auto affected_rows = connection->ExecuteUpdate(GetMergeQuery(*merge, gstate, source));
+		merged_rows += NumericCast<idx_t>(MaxValue<int64_t>(affected_rows, 0));
+	}
+	gstate.insert_count = merged_rows;
+	return SinkFinalizeType::READY;
+}
+
+SinkFinalizeType SnowflakeInsert::Finalize(Pipeline &pipeline, Event &event, ClientContext &context,
+                                           OperatorSinkFinalizeInput &input) const {
+	auto &gstate = input.global_state.Cast<SnowflakeInsertGlobalState>();
+	if (gstate.transaction) {
+		return merge ? FinalizeTransactionMerge(gstate) : SinkFinalizeType::READY;
+	}
+	if (gstate.stage.table.empty()) {
+		return SinkFinalizeType::READY;
+	}
+	if (info) {
+		// Create the table together with its rows, so a failed load neither leaves a half-loaded table
+		// behind nor replaces an existing one
+		try {
+			schema->Cast<SnowflakeSchemaEntry>().CreateTableAs(context, *info, GetQualifiedName(gstate.stage));
+		} catch (...) {
+			gstate.DropStage();
+			throw;
+		}
+		gstate.DropStage();
+		return SinkFinalizeType::READY;
+	}
+	if (gstate.insert_count == 0) {
+		gstate.DropStage();
+		return SinkFinalizeType::READY;
+	}
+	// All threads have loaded their rows: publish them with one statement
+	string query;
+	if (merge) {
+		query = GetMergeQuery(*merge, gstate, GetQualifiedName(gstate.stage));
+	} else {
+		auto column_list = GetColumnList(gstate.column_names);
+		query = "INSERT INTO " + GetQualifiedName(gstate.target) + " (" + column_list + ") SELECT " + column_list +
+		        " FROM " + GetQualifiedName(gstate.stage);
+	}
+	DPRINT("SnowflakeInsert: %s\n", query.c_str());
+	int64_t affected_rows;
+	try {
+		auto connection = SnowflakeClientManager::GetInstance().GetConnection(gstate.config);
+		if (merge) {
+			auto duplicate_key = connection->FindDuplicateKey(GetQualifiedName(gstate.stage), merge->key_columns);
+			ThrowIfDuplicateKey(*merge, duplicate_key);
+		}
+		affected_rows = connection->ExecuteUpdate(query);
+	} catch (...) {
+		gstate.DropStage();
+		throw;
+	}
+	gstate.DropStage();
+	if (affected_rows >= 0) {
+		// Inserted plus updated rows for upserts, as DuckDB reports them
+		gstate.insert_count = NumericCast<idx_t>(affected_rows);
+	}
+	return SinkFinalizeType::READY;
+}
+
+//===--------------------------------------------------------------------===//
+// Source
+//===--------------------------------------------------------------------===//
+SourceResultType SnowflakeInsert::GetData(ExecutionContext &context, DataChunk &chunk,
+                                          OperatorSourceInput &input) const {
+	auto &gstate = sink_state->Cast<SnowflakeInsertGlobalState>();
+	chunk.SetCardinality(1);
+	chunk.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(gstate.insert_count.load())));
+	return SourceResultType::FINISHED;
+}
+
+//===--------------------------------------------------------------------===//
+// Helpers
+//===--------------------------------------------------------------------===//
+string SnowflakeInsert::GetName() const {
+	return "SNOWFLAKE_INSERT";
+}
+
+InsertionOrderPreservingMap<string> SnowflakeInsert::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Table Name"] = table ? table->name : info->Base().table;
+	if (merge) {
+		result["Merge Keys"] = StringUtil::Join(merge->key_columns, ", ");
+	}
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// Plan
+//===--------------------------------------------------------------------===//
+static PhysicalOperator &AddCastToSnowflakeTypes(ClientContext &context, PhysicalPlanGenerator &planner,
+                                                 PhysicalOperator &plan) {
+	// Types without an Arrow/Snowflake counterpart are cast before they reach the sink
+	vector<LogicalType> ingest_types;
+	bool require_cast = false;
+	for (auto &type : plan.types) {
+		auto ingest_type = GetSnowflakeIngestType(type);
+		require_cast = require_cast || ingest_type != type;
+		ingest_types.push_back(std::move(ingest_type));
+	}
+	if (!require_cast) {
+		return plan;
+	}
+
+	vector<unique_ptr<Expression>> select_list;
+	for (idx_t i = 0; i < plan.types.size(); i++) {
+		unique_ptr<Expression> expr = make_uniq<BoundReferenceExpression>(plan.types[i], i);
+		if (plan.types[i] != ingest_types[i]) {
+			expr = BoundCastExpression::AddCastToType(context, std::move(expr), ingest_types[i]);
+		}
+		select_list.push_back(std::move(expr));
+	}
+	auto &proj = planner.Make<PhysicalProjection>(std::move(ingest_types), std::move(select_list),
+	                                              plan.estimated_cardinality);
+	proj.children.push_back(plan);
+	return proj;
+}
+
+static unique_ptr<SnowflakeMergeInfo> GetMergeInfo(ClientContext &context, LogicalInsert &op) {
+	if (op.on_conflict_condition) {
+		throw BinderException("ON CONFLICT target WHERE clause not yet supported for insertion into Snowflake table");
+	}
+	auto &table = op.table;
+	auto &columns = table.GetColumns();
+	auto is_inserted = [&](PhysicalIndex index) {
+		return op.column_index_map.empty() || op.column_index_map[index] != DConstants::INVALID_INDEX;
+	};
+
+	auto result = make_uniq<SnowflakeMergeInfo>();
+	if (!op.on_conflict_filter.empty()) {
+		for (auto &column_id : op.on_conflict_filter) {
+			result->key_columns.push_back(columns.GetColumn(LogicalIndex(column_id)).Name());
+		}
+	} else {
+		result->key_columns = table.Cast<SnowflakeTableEntry>().GetPrimaryKeyColumns(context);
+	}
+	if (result->key_columns.empty()) {
+		throw BinderException("Upserting into Snowflake table \"%s\" requires a PRIMARY KEY or ON CONFLICT columns",
+		                      table.name);
+	}
+	for (auto &key_column : result->key_columns) {
+		if (!is_inserted(columns.GetColumn(key_column).Physical())) {
+			throw BinderException("Upserting into Snowflake table \"%s\" requires a value for key column \"%s\"",
+			                      table.name, key_column);
+		}
+	}
+	if (op.action_type == OnConflictAction::NOTHING) {
+		return result;
+	}
+
+	// DO UPDATE expressions reference the would-be inserted row (EXCLUDED) in the first columns of
+	// their input, followed by the fetched columns of the existing row
+	auto excluded_count = columns.PhysicalColumnCount();
+	auto resolver = [&](idx_t index) -> unique_ptr<ParsedExpression> {
+		if (index < excluded_count) {
+			auto &column = columns.GetColumn(PhysicalIndex(index));
+			if (!is_inserted(column.Physical())) {
+				// The value would be the column default, which is not staged
+				return nullptr;
+			}
+			return make_uniq<ColumnRefExpression>(column.Name(), "S");
+		}
+		auto fetch_index = index - excluded_count;
+		if (fetch_index >= op.columns_to_fetch.size()) {
+			return nullptr;
+		}
+		return make_uniq<ColumnRefExpression>(columns.GetColumn(LogicalIndex(op.columns_to_fetch[fetch_index])).Name(),
+		                                      "T");
+	};
+	for (idx_t i = 0; i < op.set_columns.size(); i++) {
+		auto &column_name = columns.GetColumn(op.set_columns[i]).Name();
+		auto value = SnowflakeQueryBuilder::TransformExpression(*op.expressions[i], resolver);
+		if (!value) {
+			throw NotImplementedException("ON CONFLICT DO UPDATE SET %s = %s has no Snowflake translation", column_name,
+			                              op.expressions[i]->ToString());
+		}
+		result->assignments.push_back(KeywordHelper::WriteQuoted(column_name, '"') + " = " + value->ToString());
+	}
+	if (op.do_update_condition) {
+		auto condition = SnowflakeQueryBuilder::TransformExpression(*op.do_update_condition, resolver);
+		if (!condition) {
+			throw NotImplementedException("ON CONFLICT DO UPDATE WHERE %s has no Snowflake translation",
+			                              op.do_update_condition->ToString());
+		}
+		result->update_condition = condition->ToString();
+	}
+	return result;
+}
+
+PhysicalOperator &SnowflakeCatalog::PlanInsert(ClientContext &context, PhysicalPlanGenerator &planner,
+                                               LogicalInsert &op, optional_ptr<PhysicalOperator> plan) {
+	if (op.return_chunk) {
+		throw BinderException("RETURNING clause not yet supported for insertion into Snowflake table");
+	}
+	unique_ptr<SnowflakeMergeInfo> merge;
+	if (op.action_type != OnConflictAction::THROW) {
+		merge = GetMergeInfo(context, op);
+	}
+	D_ASSERT(plan);
+	auto &cast_plan = AddCastToSnowflakeTypes(context, planner, *plan);
+	auto &insert = planner.Make<SnowflakeInsert>(op, op.table, op.column_index_map);
+	insert.merge = std::move(merge);
+	insert.children.push_back(cast_plan);
+	return insert;
+}
+
+PhysicalOperator &SnowflakeCatalog::PlanCreateTableAs(ClientContext &context, PhysicalPlanGenerator &planner,
+                                                      LogicalCreateTable &op, PhysicalOperator &plan) {
+	auto &cast_plan = AddCastToSnowflakeTypes(context, planner, plan);
+	auto &insert = planner.Make<SnowflakeInsert>(op, op.schema, std::move(op.info));
+	insert.children.push_back(cast_plan);
+	return insert;
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -0,0 +1,221 @@
+#include "storage/snowflake_remote_statement.hpp"
+#include "storage/snowflake_catalog.hpp"
+#include "storage/snowflake_table_entry.hpp"
+#include "snowflake_debug.hpp"
+#include "snowflake_client_manager.hpp"
+#include "snowflake_query_builder.hpp"
+#include "snowflake_transaction.hpp"
+
+#include "duckdb/execution/physical_plan_generator.hpp"
+#include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/expression/conjunction_expression.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/planner/filter/conjunction_filter.hpp"
+#include "duckdb/planner/filter/optional_filter.hpp"
+#include "duckdb/planner/operator/logical_delete.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_update.hpp"
+
+namespace duckdb {
+namespace snowflake {
+
+SnowflakeRemoteStatement::SnowflakeRemoteStatement(PhysicalPlan &physical_plan, LogicalOperator &op,
+                                                   TableCatalogEntry &table, string sql_p)
+    : PhysicalOperator(physical_plan, PhysicalOperatorType::EXTENSION, op.types, 1), table(table),
+      sql(std::move(sql_p)) {
+}
+
+SourceResultType SnowflakeRemoteStatement::GetData(ExecutionContext &context, DataChunk &chunk,
+                                                   OperatorSourceInput &input) const {
+	// Inside BEGIN ... COMMIT the statement joins the transaction's Snowflake transaction
+	auto connection = SnowflakeTransaction::Get(context.client, table.catalog).GetConnection();
+	if (!connection) {
+		auto &config = table.Cast<SnowflakeTableEntry>().GetConfig();
+		connection = SnowflakeClientManager::GetInstance().GetConnection(config);
+	}
+	auto affected_rows = connection->ExecuteUpdate(sql);
+
+	chunk.SetCardinality(1);
+	chunk.SetValue(0, 0, Value::BIGINT(MaxValue<int64_t>(affected_rows, 0)));
+	return SourceResultType::FINISHED;
+}
+
+string SnowflakeRemoteStatement::GetName() const {
+	return "SNOWFLAKE_REMOTE_STATEMENT";
+}
+
+InsertionOrderPreservingMap<string> SnowflakeRemoteStatement::ParamsToString() const {
+	InsertionOrderPreservingMap<string> result;
+	result["Table Name"] = table.name;
+	result["SQL"] = sql;
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// Plan
+//===--------------------------------------------------------------------===//
+static NotImplementedException UntranslatableError(const string &statement, const string &reason) {
+	return NotImplementedException("%s on a Snowflake table cannot be translated into a single Snowflake statement "
+	                               "because %s. Run the statement in Snowflake directly instead.",
+	                               statement, reason);
+}
+
+// Resolve output column `index` of `op` to the Snowflake expression it computes
+static unique_ptr<ParsedExpression> ResolveColumn(LogicalOperator &op, idx_t index) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_GET: {
+		auto &get = op.Cast<LogicalGet>();
+		auto &column_ids = get.GetColumnIds();
+		auto &column_index = column_ids[get.projection_ids.empty() ? index : get.projection_ids[index]];
+		if (column_index.IsVirtualColumn()) {
+			// The row id - only used by DuckDB to locate rows, never in a translated expression
+			return nullptr;
+		}
+		return make_uniq<ColumnRefExpression>(get.names[column_index.GetPrimaryIndex()]);
+	}
+	case LogicalOperatorType::LOGICAL_FILTER: {
+		auto &filter = op.Cast<LogicalFilter>();
+		if (!filter.projection_map.empty()) {
+			index = filter.projection_map[index];
+		}
+		return ResolveColumn(*op.children[0], index);
+	}
+	case LogicalOperatorType::LOGICAL_PROJECTION: {
+		auto &child = *op.children[0];
+		return SnowflakeQueryBuilder::TransformExpression(
+		    *op.expressions[index], [&](idx_t child_index) { return ResolveColumn(child, child_index); });
+	}
+	default:
+		return nullptr;
+	}
+}
+
+static bool HasDynamicFilter(const TableFilter &filter) {
+	switch (filter.filter_type) {
+	case TableFilterType::DYNAMIC_FILTER:
+		return true;
+	case TableFilterType::OPTIONAL_FILTER:
+		return HasDynamicFilter(*filter.Cast<OptionalFilter>().child_filter);
+	case TableFilterType::CONJUNCTION_AND:
+		for (auto &child : filter.Cast<ConjunctionAndFilter>().child_filters) {
+			if (HasDynamicFilter(*child)) {
+				return true;
+			}
+		}
+		return false;
+	case TableFilterType::CONJUNCTION_OR:
+		for (auto &child : filter.Cast<ConjunctionOrFilter>().child_filters) {
+			if (HasDynamicFilter(*child)) {
+				return true;
+			}
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
+// Collect the predicates between the DML operator and the scan of its table. Every predicate must
+// translate - dropping one would modify more rows than the statement asked for.
+static void CollectConditions(const string &statement, LogicalOperator &op, TableCatalogEntry &table,
+                              vector<unique_ptr<ParsedExpression>> &conditions) {
+	switch (op.type) {
+	case LogicalOperatorType::LOGICAL_PROJECTION:
+		CollectConditions(statement, *op.children[0], table, conditions);
+		return;
+	case LogicalOperatorType::LOGICAL_FILTER: {
+		auto &child = *op.children[0];
+		for (auto &expr : op.expressions) {
+			auto condition = SnowflakeQueryBuilder::TransformExpression(
+			    *expr, [&](idx_t index) { return ResolveColumn(child, index); });
+			if (!condition) {
+				throw UntranslatableError(statement,
+				                          "the condition " + expr->ToString() + " has no Snowflake translation");
+			}
+			conditions.push_back(std::move(condition));
+		}
+		CollectConditions(statement, child, table, conditions);
+		return;
+	}
+	case LogicalOperatorType::LOGICAL_GET: {
+		auto &get = op.Cast<LogicalGet>();
+		if (get.GetTable().get() != &table) {
+			throw UntranslatableError(statement, "it reads from other tables");
+		}
+		vector<string> column_names;
+		for (auto &column_index : get.GetColumnIds()) {
+			column_names.push_back(column_index.IsVirtualColumn() ? string()
+			                                                      : get.names[column_index.GetPrimaryIndex()]);
+		}
+		for (auto &entry : get.table_filters.filters) {
+			if (HasDynamicFilter(*entry.second)) {
+				throw UntranslatableError(statement, "it depends on a runtime filter");
+			}
+		}
+		auto where_expression = SnowflakeQueryBuilder::BuildWhereExpression(&get.table_filters, column_names);
+		if (where_expression) {
+			conditions.push_back(std::move(where_expression));
+		}
+		return;
+	}
+	default:
+		throw UntranslatableError(statement, "it contains a " + LogicalOperatorToString(op.type) + " operator");
+	}
+}
+
+static string GetRemoteTableName(TableCatalogEntry &table) {
+	auto &config = table.Cast<SnowflakeTableEntry>().GetConfig();
+	return config.database + "." + KeywordHelper::WriteQuoted(table.schema.name, '"') + "." +
+	       KeywordHelper::WriteQuoted(table.name, '"');
+}
+
+static string GetWhereClause(const string &statement, LogicalOperator &child, TableCatalogEntry &table) {
+	vector<unique_ptr<ParsedExpression>> conditions;
+	CollectConditions(statement, child, table, conditions);
+	if (conditions.empty()) {
+		return string();
+	}
+	if (conditions.size() == 1) {
+		return " WHERE " + conditions[0]->ToString();
+	}
+	return " WHERE " + ConjunctionExpression(ExpressionType::CONJUNCTION_AND, std::move(conditions)).ToString();
+}
+
+PhysicalOperator &SnowflakeCatalog::PlanDelete(ClientContext &context, PhysicalPlanGenerator &planner,
+                                               LogicalDelete &op, PhysicalOperator &plan) {
+	if (op.return_chunk) {
+		throw BinderException("RETURNING clause not yet supported for deletion from a Snowflake table");
+	}
+	auto sql = "DELETE FROM " + GetRemoteTableName(op.table) + GetWhereClause("DELETE", *op.children[0], op.table);
+	DPRINT("SnowflakeCatalog::PlanDelete: %s\n", sql.c_str());
+	// The local scan plan is not executed; the statement runs entirely in Snowflake
+	return planner.Make<SnowflakeRemoteStatement>(op, op.table, std::move(sql));
+}
+
+PhysicalOperator &SnowflakeCatalog::PlanUpdate(ClientContext &context, PhysicalPlanGenerator &planner,
+                                               LogicalUpdate &op, PhysicalOperator &plan) {
+	if (op.return_chunk) {
+		throw BinderException("RETURNING clause not yet supported for updates of a Snowflake table");
+	}
+	auto &child = *op.children[0];
+	auto &columns = op.table.GetColumns();
+	string set_clause;
+	for (idx_t i = 0; i < op.columns.size(); i++) {
+		auto &column_name = columns.GetColumn(op.columns[i]).Name();
+		auto value = SnowflakeQueryBuilder::TransformExpression(
+		    *op.expressions[i], [&](idx_t index) { return ResolveColumn(child, index); });
+		if (!value) {
+			throw UntranslatableError("UPDATE", "the new value of " + column_name + " has no Snowflake translation");
+		}
+		set_clause += (i > 0 ? ", " : "") + KeywordHelper::WriteQuoted(column_name, '"') + " = " + value->ToString();
+	}
+	auto sql =
+	    "UPDATE " + GetRemoteTableName(op.table) + " SET " + set_clause + GetWhereClause("UPDATE", child, op.table);
+	DPRINT("SnowflakeCatalog::PlanUpdate: %s\n", sql.c_str());
+	return planner.Make<SnowflakeRemoteStatement>(op, op.table, std::move(sql));
+}
+
+} // namespace snowflake
+} // namespace duckdb
@@ -1,6 +1,6 @@
 #include "storage/snowflake_schema_entry.hpp"
 #include "storage/snowflake_table_set.hpp"
-#include "storage/snowflake_schema_entry.hpp"
+#include "storage/snowflake_table_entry.hpp"
 
 namespace duckdb {
 namespace snowflake {
@@ -30,7 +30,11 @@ optional_ptr<CatalogEntry> SnowflakeSchemaEntry::LookupEntry(CatalogTransaction
 		                      entry_name.c_str(), alias.c_str(), alias.c_str());
 	}
 
-	return tables->GetEntry(transaction.GetContext(), entry_name);
+	auto entry = tables->GetEntry(entry_name);
+	if (entry && transaction.context) {
+		entry->Cast<SnowflakeTableEntry>().LoadColumns(*transaction.context);
+	}
+	return entry;
 }
 
 void SnowflakeSchemaEntry::Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback) {
@@ -43,7 +47,11 @@ void SnowflakeSchemaEntry::Scan(ClientContext &context, CatalogType type,
 		return;
 	}
 
-	tables->Scan(context, callback);
+	tables->Scan(callback);
+}
+
+void SnowflakeSchemaEntry::PreloadTables() {
+	tables->TryLoadEntries();
 }
 
 bool SnowflakeSchemaEntry::CatalogTypeIsSupported(CatalogType type) {
@@ -70,7 +78,12 @@ optional_ptr<CatalogEntry> SnowflakeSchemaEntry::CreateFunction(CatalogTransacti
 
 optional_ptr<CatalogEntry> SnowflakeSchemaEntry::CreateTable(CatalogTransaction transaction,
                                                              BoundCreateTableInfo &info) {
-	throw NotImplementedException("CreateTable is not supported for Snowflake schemas");
+	return tables->CreateTable(transaction.GetContext(), info);
+}
+
+optional_ptr<CatalogEntry> SnowflakeSchemaEntry::CreateTableAs(ClientContext &context, BoundCreateTableInfo &info,
+                                                               const string &source) {
+	return tables->CreateTable(context, info, source);
 }
 
 optional_ptr<CatalogEntry> SnowflakeSchemaEntry::CreateView(CatalogTransaction transaction, CreateViewInfo &info) {
@@ -4,9 +4,9 @@
 
 namespace duckdb {
 namespace snowflake {
-void SnowflakeSchemaSet::LoadEntries(ClientContext &context) {
+void SnowflakeSchemaSet::LoadEntries() {
 	DPRINT("SnowflakeSchemaSet::LoadEntries called\n");
-	vector<string> schema_names = client->ListSchemas(context);
+	vector<string> schema_names = client->ListSchemas();
 	DPRINT("Got %zu schemas from ListSchemas\n", schema_names.size());
 
 	for (const auto &schema_name : schema_names) {
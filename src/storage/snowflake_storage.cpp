@@ -5,10 +5,37 @@
 #include "snowflake_secrets.hpp"
 
 #include "duckdb.hpp"
+#include "duckdb/common/string_util.hpp"
 
 namespace duckdb {
 namespace snowflake {
 
+// Find an ATTACH option (DuckDB might lowercase option names, so try both cases)
+static optional_ptr<Value> FindAttachOption(AttachInfo &info, const string &name) {
+	auto entry = info.options.find(name);
+	if (entry == info.options.end()) {
+		entry = info.options.find(StringUtil::Upper(name));
+	}
+	if (entry == info.options.end()) {
+		return nullptr;
+	}
+	return &entry->second;
+}
+
+// Parse boolean value (supports "true", "1", "false", "0")
+static bool ParseBooleanAttachOption(const string &name, const Value &value) {
+	string str_value = value.ToString();
+	if (str_value == "true" || str_value == "TRUE" || str_value == "1") {
+		return true;
+	}
+	if (str_value == "false" || str_value == "FALSE" || str_value == "0") {
+		return false;
+	}
+	throw InvalidInputException("Invalid value for %s: '%s'. "
+	                            "Expected true/false or 1/0.",
+	                            name.c_str(), str_value.c_str());
+}
+
 static unique_ptr<Catalog> SnowflakeAttach(optional_ptr<StorageExtensionInfo> storage_info, ClientContext &context,
                                            AttachedDatabase &db, const string &name, AttachInfo &info,
                                            AttachOptions &options) {
@@ -18,14 +45,11 @@ static unique_ptr<Catalog> SnowflakeAttach(optional_ptr<StorageExtensionInfo> st
 
 	// Check if SECRET option is provided (try both cases as DuckDB might
 	// lowercase options)
-	auto secret_entry = info.options.find("secret");
-	if (secret_entry == info.options.end()) {
-		secret_entry = info.options.find("SECRET");
-	}
+	auto secret_entry = FindAttachOption(info, "secret");
 
-	if (secret_entry != info.options.end()) {
+	if (secret_entry) {
 		// Use SECRET to get credentials
-		string secret_name = secret_entry->second.ToString();
+		string secret_name = secret_entry->ToString();
 		DPRINT("Using SECRET: %s\n", secret_name.c_str());
 
 		try {
@@ -47,35 +71,133 @@ static unique_ptr<Catalog> SnowflakeAttach(optional_ptr<StorageExtensionInfo> st
 		                            "or ATTACH '' AS name (TYPE snowflake, SECRET secret_name)");
 	}
 
-	if (options.access_mode != AccessMode::READ_ONLY) {
-		throw NotImplementedException("Snowflake currently only supports read-only access");
+	// Fetch tuning and session parameters given on ATTACH override those of the secret/connection string
+	auto prefetch_entry = FindAttachOption(info, "prefetch_concurrency");
+	if (prefetch_entry) {
+		config.fetch_options.SetPrefetchConcurrency(prefetch_entry->ToString());
+	}
+	auto queue_entry = FindAttachOption(info, "result_queue_size");
+	if (queue_entry) {
+		config.fetch_options.SetResultQueueSize(queue_entry->ToString());
+	}
+	auto session_entry = FindAttachOption(info, "session_parameters");
+	if (session_entry) {
+		SnowflakeSecretsHelper::ParseSessionParameters(*session_entry, config.session_parameters);
 	}
 
 	// Parse enable_pushdown option
 	SnowflakeOptions snowflake_options;
 	snowflake_options.access_mode = options.access_mode;
+	snowflake_options.fetch_options = config.fetch_options;
+
+	auto pushdown_entry = FindAttachOption(info, "enable_pushdown");
+	if (pushdown_entry) {
+		snowflake_options.enable_pushdown = ParseBooleanAttachOption("enable_pushdown", *pushdown_entry);
+		DPRINT("Pushdown %s by user option\n", snowflake_options.enable_pushdown ? "ENABLED" : "DISABLED");
+	} else {
+		DPRINT("Pushdown DISABLED by default (no enable_pushdown option provided)\n");
+	}
+
+	auto async_entry = FindAttachOption(info, "async_connect");
+	if (async_entry) {
+		snowflake_options.async_connect = ParseBooleanAttachOption("async_connect", *async_entry);
+	}
+
+	// Comma-separated list of schemas to warm up, or '*' for all of them
+	auto preload_entry = FindAttachOption(info, "preload_schemas");
+	if (preload_entry) {
+		for (auto &schema_name : StringUtil::Split(preload_entry->ToString(), ',')) {
+			StringUtil::Trim(schema_name);
+			if (!schema_name.empty()) {
+				snowflake_options.preload_schemas.push_back(schema_name);
+			}
+		}
+	}
+
+	auto batch_size_entry = FindAttachOption(info, "insert_batch_size");
+	if (batch_size_entry) {
+		auto batch_size = batch_size_entry->DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>();
+		if (batch_size <= 0) {
+			throw InvalidInputException("Invalid value for insert_batch_size: %lld. Expected a positive integer.",
+			                            static_cast<long long>(batch_size));
+		}
+		snowflake_options.insert_batch_size = static_cast<idx_t>(batch_size);
+	}
+
+	auto number_mapping_entry = FindAttachOption(info, "number_mapping");
+	if (number_mapping_entry) {
+		snowflake_options.number_policy.default_mapping =
+		    ParseNumberMapping("number_mapping", number_mapping_entry->ToString());
+	}
+	auto number_column_mapping_entry = FindAttachOption(info, "number_column_mapping");
+	if (number_column_mapping_entry) {
+		snowflake_options.number_policy.ParseColumnMappings(*number_column_mapping_entry);
+	}
 
-	auto pushdown_entry = info.options.find("enable_pushdown");
-	if (pushdown_entry == info.options.end()) {
-		pushdown_entry = info.options.find("ENABLE_PUSHDOWN");
+	auto variant_shredding_entry = FindAttachOption(info, "variant_shredding");
+	if (variant_shredding_entry) {
+		snowflake_options.variant_shredding.ParseColumns(variant_shredding_entry->ToString());
+	}
+	auto variant_sample_entry = FindAttachOption(info, "variant_sample_size");
+	if (variant_sample_entry) {
+		auto sample_rows = variant_sample_entry->DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>();
+		if (sample_rows <= 0) {
+			throw InvalidInputException("Invalid value for variant_sample_size: %lld. Expected a positive integer.",
+			                            static_cast<long long>(sample_rows));
+		}
+		snowflake_options.variant_shredding.sample_rows = static_cast<idx_t>(sample_rows);
 	}
 
-	if (pushdown_entry != info.options.end()) {
-		string pushdown_value = pushdown_entry->second.ToString();
-		// Parse boolean value (supports "true", "1", "false", "0")
-		if (pushdown_value == "true" || pushdown_value == "TRUE" || pushdown_value == "1") {
-			snowflake_options.enable_pushdown = true;
-			DPRINT("Pushdown ENABLED by user option\n");
-		} else if (pushdown_value == "false" || pushdown_value == "FALSE" || pushdown_value == "0") {
-			snowflake_options.enable_pushdown = false;
-			DPRINT("Pushdown DISABLED by user option\n");
+	auto unload_stage_entry = FindAttachOption(info, "unload_stage");
+	if (unload_stage_entry) {
+		auto stage = unload_stage_entry->ToString();
+		StringUtil::Trim(stage);
+		while (!stage.empty() && stage.back() == '/') {
+			stage.pop_back();
+		}
+		if (!stage.empty() && stage[0] != '@') {
+			throw InvalidInputException("Invalid value for unload_stage: '%s'. Expected a stage such as "
+			                            "'@my_stage/path'.",
+			                            unload_stage_entry->ToString());
+		}
+		snowflake_options.unload.stage = stage;
+	}
+	auto unload_location_entry = FindAttachOption(info, "unload_location");
+	if (unload_location_entry) {
+		snowflake_options.unload.location = unload_location_entry->ToString();
+	}
+	auto unload_threshold_entry = FindAttachOption(info, "unload_threshold");
+	if (unload_threshold_entry) {
+		// A byte count, or a size such as '50GB'
+		auto threshold = unload_threshold_entry->ToString();
+		Value bytes;
+		if (Value(threshold).DefaultTryCastAs(LogicalType::UBIGINT, bytes)) {
+			snowflake_options.unload.threshold_bytes = bytes.GetValue<uint64_t>();
 		} else {
-			throw InvalidInputException("Invalid value for enable_pushdown: '%s'. "
-			                            "Expected true/false or 1/0.",
-			                            pushdown_value.c_str());
+			snowflake_options.unload.threshold_bytes = DBConfig::ParseMemoryLimit(threshold);
+		}
+	}
+
+	auto snapshot_entry = FindAttachOption(info, "snapshot");
+	if (snapshot_entry && !snapshot_entry->IsNull()) {
+		auto snapshot = snapshot_entry->ToString();
+		auto lower_snapshot = StringUtil::Lower(snapshot);
+		if (lower_snapshot == "none") {
+			snowflake_options.snapshot_mode = SnowflakeSnapshotMode::NONE;
+		} else if (lower_snapshot == "transaction") {
+			snowflake_options.snapshot_mode = SnowflakeSnapshotMode::TRANSACTION;
+		} else {
+			Value timestamp;
+			string error;
+			if (!Value(snapshot).DefaultTryCastAs(LogicalType::TIMESTAMP_TZ, timestamp, &error)) {
+				throw InvalidInputException("Invalid value for snapshot: '%s'. Expected 'none', 'transaction' or a "
+				                            "timestamp.",
+				                            snapshot);
+			}
+			snowflake_options.snapshot_mode = SnowflakeSnapshotMode::TIMESTAMP;
+			snowflake_options.snapshot_timestamp =
+			    SnowflakeTimeTravel::FromAtClause("TIMESTAMP", timestamp).value.ToString();
 		}
-	} else {
-		DPRINT("Pushdown DISABLED by default (no enable_pushdown option provided)\n");
 	}
 
 	DPRINT("Creating SnowflakeCatalog\n");
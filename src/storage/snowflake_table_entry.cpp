@@ -3,34 +3,89 @@
 #include "snowflake_debug.hpp"
 #include "snowflake_client_manager.hpp"
 #include "snowflake_scan.hpp"
+#include "snowflake_transaction.hpp"
+#include "snowflake_resumable_stream.hpp"
+#include "snowflake_unload.hpp"
 #include "snowflake_arrow_utils.hpp"
+#include "snowflake_timestamp_conversion.hpp"
+#include "snowflake_variant_shredding.hpp"
 #include "duckdb/storage/table_storage_info.hpp"
 #include "duckdb/function/table/arrow.hpp"
 #include "duckdb/function/table/arrow/arrow_duck_schema.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 
 namespace duckdb {
 namespace snowflake {
 
 TableFunction SnowflakeTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data) {
+	return BindScan(context, bind_data, nullptr);
+}
+
+TableFunction SnowflakeTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data,
+                                                   const EntryLookupInfo &lookup_info) {
+	return BindScan(context, bind_data, lookup_info.GetAtClause());
+}
+
+TableFunction SnowflakeTableEntry::BindScan(ClientContext &context, unique_ptr<FunctionData> &bind_data,
+                                            optional_ptr<BoundAtClause> at_clause) {
 	DPRINT("SnowflakeTableEntry::GetScanFunction called for table %s.%s.%s\n", client->GetConfig().database.c_str(),
 	       schema.name.c_str(), name.c_str());
 
 	auto &config = client->GetConfig();
-	string query = "SELECT * FROM " + config.database + "." + schema.name + "." + name;
-	DPRINT("SnowflakeTableEntry: Query = '%s'\n", query.c_str());
+	auto &snowflake_catalog = catalog.Cast<SnowflakeCatalog>();
+	const auto &catalog_options = snowflake_catalog.GetOptions();
+	LoadVariantFields();
 
 	// TODO consider maintaining a thread-safe pool of connections in client, so
 	// we can use the client within SnowflakeTableEntry instead of creating a new
 	// client
 	auto &client_manager = SnowflakeClientManager::GetInstance();
 	auto connection = client_manager.GetConnection(config);
+	auto &transaction = SnowflakeTransaction::Get(context, catalog);
+	bool remote_transaction = transaction.HasRemoteTransaction();
+	if (remote_transaction) {
+		// Uncommitted writes are only visible to the session of the transaction
+		connection = transaction.GetConnection();
+	}
+
+	// An explicit AT clause, else the catalog's snapshot. A transaction that has written reads its
+	// own writes, which no snapshot contains.
+	SnowflakeTimeTravel time_travel;
+	if (at_clause) {
+		time_travel = SnowflakeTimeTravel::FromAtClause(at_clause->Unit(), at_clause->GetValue());
+	} else if (!remote_transaction) {
+		if (catalog_options.snapshot_mode == SnowflakeSnapshotMode::TIMESTAMP) {
+			time_travel = SnowflakeTimeTravel::AtTimestamp(catalog_options.snapshot_timestamp);
+		} else if (catalog_options.snapshot_mode == SnowflakeSnapshotMode::TRANSACTION) {
+			time_travel = SnowflakeTimeTravel::AtTimestamp(transaction.GetSnapshotTimestamp());
+		}
+	}
+	if (time_travel.IsSet()) {
+		// The binder uses the current columns, which a historical scan has to match
+		LoadColumns(context);
+	}
+	string query = GetScanQuery(time_travel);
+	DPRINT("SnowflakeTableEntry: Query = '%s'\n", query.c_str());
 
 	auto factory = make_uniq<SnowflakeArrowStreamFactory>(connection, query);
+	factory->session_bound = remote_transaction;
+	factory->inject_stream_failure = snowflake::GetInjectedStreamFailure(context);
+	Value reuse_results;
+	if (!remote_transaction && context.TryGetCurrentSetting("snowflake_reuse_results", reuse_results) &&
+	    !reuse_results.IsNull() && BooleanValue::Get(reuse_results)) {
+		// A transaction that has written reads data no recorded result contains
+		factory->result_tables.push_back(GetScanTableName());
+	}
 	DPRINT("SnowflakeTableEntry: Created factory at %p\n", (void *)factory.get());
+	if (column_expansions || time_travel.IsSet()) {
+		factory->table_name = GetScanTableName();
+		factory->time_travel = time_travel;
+		factory->column_expansions = column_expansions;
+		factory->struct_assemblies = struct_assemblies;
+	}
 
-	// Apply pushdown settings from catalog options
-	auto &snowflake_catalog = catalog.Cast<SnowflakeCatalog>();
-	const auto &catalog_options = snowflake_catalog.GetOptions();
+	// Apply pushdown and fetch settings from catalog options
+	factory->SetFetchOptions(catalog_options.fetch_options, TaskScheduler::GetScheduler(context).NumberOfThreads());
 	factory->filter_pushdown_enabled = catalog_options.enable_pushdown;
 	factory->projection_pushdown_enabled = catalog_options.enable_pushdown;
 	DPRINT("SnowflakeTableEntry: Pushdown %s (enable_pushdown=%s)\n",
@@ -52,6 +107,8 @@ TableFunction SnowflakeTableEntry::GetScanFunction(ClientContext &context, uniqu
 	vector<LogicalType> return_types;
 	ArrowTableFunction::PopulateArrowTableSchema(DBConfig::GetConfig(context), snowflake_bind_data->arrow_table,
 	                                             snowflake_bind_data->schema_root.arrow_schema);
+	snowflake_bind_data->factory->column_conversions =
+	    BindResultTypes(snowflake_bind_data->schema_root.arrow_schema, snowflake_bind_data->arrow_table);
 	names = snowflake_bind_data->arrow_table.GetNames();
 	return_types = snowflake_bind_data->arrow_table.GetTypes();
 	snowflake_bind_data->all_types = return_types;
@@ -61,12 +118,44 @@ TableFunction SnowflakeTableEntry::GetScanFunction(ClientContext &context, uniqu
 	snowflake_bind_data->factory->column_names = names;
 
 	// Populate columns if not already loaded (first time accessing this table)
-	if (!columns_loaded) {
-		for (idx_t i = 0; i < static_cast<idx_t>(names.size()); i++) {
-			DPRINT("  Column: %s, Type: %s\n", names[i].c_str(), return_types[i].ToString().c_str());
-			columns.AddColumn(ColumnDefinition(names[i], return_types[i]));
+	SetColumns(names, return_types);
+	if (time_travel.IsSet()) {
+		auto &current_columns = GetColumns();
+		bool same_columns = current_columns.LogicalColumnCount() == names.size();
+		for (idx_t col_idx = 0; same_columns && col_idx < names.size(); col_idx++) {
+			auto &column = current_columns.GetColumn(LogicalIndex(col_idx));
+			same_columns = StringUtil::CIEquals(column.Name(), names[col_idx]) && column.Type() == return_types[col_idx];
+		}
+		if (!same_columns) {
+			throw BinderException("The columns of %s at (%s) differ from its current columns; read it with "
+			                      "snowflake_query instead",
+			                      GetFullyQualifiedName(), time_travel.ToString());
+		}
+	}
+
+	// Large tables are unloaded to a stage and read from there in parallel. A transaction that has written
+	// reads its own writes, which only its session sees.
+	auto &unload = catalog_options.unload;
+	if (unload.IsEnabled() && !remote_transaction && !column_expansions) {
+		int64_t table_bytes = -1;
+		try {
+			table_bytes = connection->GetTableBytes(schema.name, name);
+		} catch (std::exception &ex) {
+			DPRINT("SnowflakeTableEntry: size of %s unknown: %s\n", name.c_str(), ex.what());
+		}
+		if (table_bytes >= 0 && static_cast<idx_t>(table_bytes) >= unload.threshold_bytes) {
+			DPRINT("SnowflakeTableEntry: unloading %s (%lld bytes)\n", name.c_str(),
+			       static_cast<long long>(table_bytes));
+			auto unload_data = make_uniq<SnowflakeUnloadBindData>();
+			unload_data->config = config;
+			unload_data->options = unload;
+			unload_data->table_name = GetScanTableName();
+			unload_data->time_travel = time_travel;
+			unload_data->names = names;
+			unload_data->types = return_types;
+			bind_data = std::move(unload_data);
+			return GetSnowflakeUnloadScanFunction(catalog_options.enable_pushdown);
 		}
-		columns_loaded = true;
 	}
 
 	DPRINT("SnowflakeTableEntry: Setting bind_data at %p\n", (void *)snowflake_bind_data.get());
@@ -78,16 +167,281 @@ TableFunction SnowflakeTableEntry::GetScanFunction(ClientContext &context, uniqu
 	return GetSnowflakeTableScanFunction(catalog_options.enable_pushdown);
 }
 
+string SnowflakeTableEntry::GetScanTableName() const {
+	return client->GetConfig().database + "." + schema.name + "." + name;
+}
+
+string SnowflakeTableEntry::GetScanQuery(const SnowflakeTimeTravel &time_travel) const {
+	if (column_expansions || time_travel.IsSet()) {
+		vector<string> projection;
+		if (column_expansions) {
+			projection = scan_columns;
+		}
+		return SnowflakeQueryBuilder::BuildQuery(GetScanTableName(), projection, nullptr, scan_columns,
+		                                         column_expansions.get(), &time_travel);
+	}
+	return "SELECT * FROM " + GetScanTableName();
+}
+
+void SnowflakeTableEntry::SetColumns(const vector<string> &names, const vector<LogicalType> &types) {
+	lock_guard<mutex> guard(columns_lock);
+	if (columns_loaded) {
+		return;
+	}
+	for (idx_t i = 0; i < static_cast<idx_t>(names.size()); i++) {
+		DPRINT("  Column: %s, Type: %s\n", names[i].c_str(), types[i].ToString().c_str());
+		columns.AddColumn(ColumnDefinition(names[i], types[i]));
+	}
+	columns_loaded = true;
+}
+
+void SnowflakeTableEntry::LoadColumns(ClientContext &context) {
+	{
+		lock_guard<mutex> guard(columns_lock);
+		if (columns_loaded) {
+			return;
+		}
+	}
+	LoadVariantFields();
+	auto connection = SnowflakeClientManager::GetInstance().GetConnection(client->GetConfig());
+	if (!column_expansions) {
+		// Shredded VARIANT columns are only described by the result schema of their scan
+		vector<string> names;
+		vector<LogicalType> types;
+		if (BindMetadataTypes(context, *connection, names, types)) {
+			SetColumns(names, types);
+			return;
+		}
+	}
+	// Same schema query as GetScanFunction so the column types match those of a later scan
+	SnowflakeArrowStreamFactory factory(connection, GetScanQuery());
+	ArrowSchemaWrapper schema_root;
+	SnowflakeGetArrowSchema(reinterpret_cast<ArrowArrayStream *>(&factory), schema_root.arrow_schema);
+
+	ArrowTableSchema arrow_table;
+	ArrowTableFunction::PopulateArrowTableSchema(DBConfig::GetConfig(context), arrow_table, schema_root.arrow_schema);
+	BindResultTypes(schema_root.arrow_schema, arrow_table);
+	SetColumns(arrow_table.GetNames(), arrow_table.GetTypes());
+}
+
+vector<string> SnowflakeTableEntry::GetPrimaryKeyColumns(ClientContext &context) {
+	{
+		lock_guard<mutex> guard(columns_lock);
+		if (primary_key_loaded) {
+			return primary_key;
+		}
+	}
+	vector<string> key_columns;
+	try {
+		auto connection = SnowflakeClientManager::GetInstance().GetConnection(client->GetConfig());
+		key_columns = connection->GetPrimaryKeyColumns(schema.name, name);
+	} catch (std::exception &ex) {
+		// Missing privileges on the constraint metadata must not break reads of the table
+		ErrorData error(ex);
+		DPRINT("Could not load the primary key of %s: %s\n", name.c_str(), error.RawMessage().c_str());
+	}
+	lock_guard<mutex> guard(columns_lock);
+	primary_key = std::move(key_columns);
+	primary_key_loaded = true;
+	return primary_key;
+}
+
+vector<SnowflakeColumnConversion> SnowflakeTableEntry::BindResultTypes(ArrowSchema &schema,
+                                                                       ArrowTableSchema &arrow_table) {
+	auto conversions = ApplyTimestampTypes(schema, arrow_table, client->GetConfig().timestamp_ns);
+	auto struct_conversions = ApplyStructAssemblies(schema, arrow_table, struct_assemblies);
+	conversions.insert(conversions.end(), struct_conversions.begin(), struct_conversions.end());
+	auto number_conversions = ApplyNumberMapping(arrow_table);
+	conversions.insert(conversions.end(), number_conversions.begin(), number_conversions.end());
+	return conversions;
+}
+
+bool SnowflakeTableEntry::BindMetadataTypes(ClientContext &context, SnowflakeClient &connection, vector<string> &names,
+                                            vector<LogicalType> &types) {
+	vector<SnowflakeColumn> table_columns;
+	try {
+		table_columns = connection.GetTableInfo(context, schema.name, name);
+	} catch (std::exception &ex) {
+		// e.g. a quoted lower-case name, or a type INFORMATION_SCHEMA does not fully describe
+		ErrorData error(ex);
+		DPRINT("Binding %s from its result schema: %s\n", name.c_str(), error.RawMessage().c_str());
+		return false;
+	}
+	for (auto &column : table_columns) {
+		names.push_back(column.name);
+		types.push_back(column.type);
+	}
+	for (auto &entry : GetNumberTypes(names, types)) {
+		types[entry.first] = entry.second;
+	}
+	return true;
+}
+
+vector<SnowflakeColumnConversion> SnowflakeTableEntry::ApplyNumberMapping(ArrowTableSchema &arrow_table) {
+	auto &arrow_columns = arrow_table.GetColumns();
+	auto &names = arrow_table.GetNames();
+	vector<LogicalType> decimal_types;
+	for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+		auto &arrow_type = *arrow_columns.at(col_idx);
+		decimal_types.push_back(IsDecimal128Column(arrow_type) ? arrow_type.GetDuckType() : LogicalType::INVALID);
+	}
+	return ApplyNumberTypes(arrow_table, GetNumberTypes(names, decimal_types));
+}
+
+unordered_map<idx_t, LogicalType> SnowflakeTableEntry::GetNumberTypes(const vector<string> &names,
+                                                                      const vector<LogicalType> &types) {
+	auto &policy = catalog.Cast<SnowflakeCatalog>().GetOptions().number_policy;
+
+	unordered_map<idx_t, LogicalType> target_types;
+	vector<idx_t> narrow_columns;
+	for (idx_t col_idx = 0; col_idx < names.size(); col_idx++) {
+		auto &decimal_type = types[col_idx];
+		if (decimal_type.id() != LogicalTypeId::DECIMAL) {
+			continue;
+		}
+		auto width = DecimalType::GetWidth(decimal_type);
+		auto scale = DecimalType::GetScale(decimal_type);
+		auto mapping = policy.GetMapping(name, names[col_idx]);
+		if (mapping == SnowflakeNumberMapping::NARROW && width > Decimal::MAX_WIDTH_INT64) {
+			// The declared precision does not tell, size the column by its values
+			narrow_columns.push_back(col_idx);
+			continue;
+		}
+		target_types[col_idx] = GetNumberType(mapping, width, scale);
+	}
+
+	if (!narrow_columns.empty()) {
+		vector<string> narrow_names;
+		vector<uint8_t> narrow_scales;
+		for (auto col_idx : narrow_columns) {
+			narrow_names.push_back(names[col_idx]);
+			narrow_scales.push_back(DecimalType::GetScale(types[col_idx]));
+		}
+		LoadNumberWidths(narrow_names, narrow_scales);
+		lock_guard<mutex> guard(columns_lock);
+		for (idx_t i = 0; i < narrow_columns.size(); i++) {
+			auto entry = number_widths.find(narrow_names[i]);
+			if (entry == number_widths.end() || entry->second == 0) {
+				// No values to size the column by - keep the declared precision
+				continue;
+			}
+			target_types[narrow_columns[i]] =
+			    GetNumberType(SnowflakeNumberMapping::NARROW, entry->second, narrow_scales[i]);
+		}
+	}
+	return target_types;
+}
+
+void SnowflakeTableEntry::LoadNumberWidths(const vector<string> &column_names, const vector<uint8_t> &scales) {
+	{
+		lock_guard<mutex> guard(columns_lock);
+		if (number_widths_loaded) {
+			return;
+		}
+	}
+	case_insensitive_map_t<uint8_t> widths;
+	try {
+		auto connection = SnowflakeClientManager::GetInstance().GetConnection(client->GetConfig());
+		auto ranges = connection->GetColumnRanges(schema.name, name, column_names);
+		for (idx_t i = 0; i < column_names.size(); i++) {
+			widths[column_names[i]] = MaxValue<uint8_t>(GetUnscaledWidth(ranges[i].first, scales[i]),
+			                                            GetUnscaledWidth(ranges[i].second, scales[i]));
+		}
+	} catch (std::exception &ex) {
+		// Without the ranges the columns keep their declared precision
+		ErrorData error(ex);
+		DPRINT("Could not load the value ranges of %s: %s\n", name.c_str(), error.RawMessage().c_str());
+	}
+	lock_guard<mutex> guard(columns_lock);
+	number_widths = std::move(widths);
+	number_widths_loaded = true;
+}
+
+void SnowflakeTableEntry::LoadVariantFields() {
+	{
+		lock_guard<mutex> guard(columns_lock);
+		if (variant_fields_loaded) {
+			return;
+		}
+	}
+	auto &shredding = catalog.Cast<SnowflakeCatalog>().GetOptions().variant_shredding;
+	vector<string> remote_columns;
+	auto expansions = make_shared_ptr<column_expansion_map_t>();
+	vector<SnowflakeStructAssembly> assemblies;
+	if (!shredding.columns.empty()) {
+		try {
+			auto connection = SnowflakeClientManager::GetInstance().GetConnection(client->GetConfig());
+			SnowflakeArrowStreamFactory factory(connection, "SELECT * FROM " + GetScanTableName());
+			ArrowSchemaWrapper schema_root;
+			SnowflakeGetArrowSchema(reinterpret_cast<ArrowArrayStream *>(&factory), schema_root.arrow_schema);
+			for (int64_t child_idx = 0; child_idx < schema_root.arrow_schema.n_children; child_idx++) {
+				auto column_name = schema_root.arrow_schema.children[child_idx]->name;
+				remote_columns.push_back(column_name ? column_name : "");
+			}
+			for (auto &column_name : remote_columns) {
+				if (!shredding.IsShredded(name, column_name)) {
+					continue;
+				}
+				try {
+					auto keys = connection->GetVariantKeys(schema.name, name, column_name, shredding.sample_rows);
+					auto fields = GetVariantFields(keys);
+					(*expansions)[column_name] = BuildVariantExpansion(column_name, fields);
+					assemblies.push_back(GetVariantAssembly(column_name, fields));
+				} catch (std::exception &ex) {
+					// e.g. not a VARIANT column - it is read as JSON text
+					ErrorData error(ex);
+					DPRINT("Could not shred %s.%s: %s\n", name.c_str(), column_name.c_str(),
+					       error.RawMessage().c_str());
+				}
+			}
+		} catch (std::exception &ex) {
+			ErrorData error(ex);
+			DPRINT("Could not load the columns of %s: %s\n", name.c_str(), error.RawMessage().c_str());
+		}
+	}
+	lock_guard<mutex> guard(columns_lock);
+	if (!assemblies.empty()) {
+		scan_columns = std::move(remote_columns);
+		column_expansions = std::move(expansions);
+		struct_assemblies = std::move(assemblies);
+	}
+	variant_fields_loaded = true;
+}
+
 unique_ptr<BaseStatistics> SnowflakeTableEntry::GetStatistics(ClientContext &context, column_t column_id) {
 	throw NotImplementedException("Snowflake does not support getting statistics for tables");
 }
 
 TableStorageInfo SnowflakeTableEntry::GetStorageInfo(ClientContext &context) {
 	TableStorageInfo result;
-	// Don't fetch row count to avoid ADBC statement conflicts
-	// Snowflake is read-only, so exact cardinality isn't critical
+	// Don't fetch row count to avoid ADBC statement conflicts,
+	// the exact cardinality isn't critical for planning remote scans
 	result.cardinality = 0;
 	result.index_info = vector<IndexInfo>();
+
+	auto key_columns = GetPrimaryKeyColumns(context);
+	if (key_columns.empty()) {
+		return result;
+	}
+	LoadColumns(context);
+	IndexInfo primary_key_info;
+	primary_key_info.is_unique = true;
+	primary_key_info.is_primary = true;
+	primary_key_info.is_foreign = false;
+	for (auto &key_column : key_columns) {
+		bool found = false;
+		for (auto &column : columns.Logical()) {
+			if (StringUtil::CIEquals(column.Name(), key_column)) {
+				primary_key_info.column_set.insert(column.Oid());
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			return result;
+		}
+	}
+	result.index_info.push_back(std::move(primary_key_info));
 	return result;
 }
 
@@ -1,11 +1,19 @@
 #include "storage/snowflake_table_set.hpp"
+#include "snowflake_debug.hpp"
 #include "storage/snowflake_table_entry.hpp"
+#include "snowflake_query_builder.hpp"
+#include "snowflake_types.hpp"
+#include "duckdb/common/enum_util.hpp"
+#include "duckdb/parser/constraints/not_null_constraint.hpp"
+#include "duckdb/parser/constraints/unique_constraint.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 
 namespace duckdb {
 namespace snowflake {
-void SnowflakeTableSet::LoadEntries(ClientContext &context) {
-	auto table_names = client->ListTables(context, schema_name);
+void SnowflakeTableSet::LoadEntries() {
+	auto table_names = client->ListTables(schema_name);
 
 	for (const auto &table_name : table_names) {
 		CreateTableInfo info;
@@ -20,5 +28,101 @@ void SnowflakeTableSet::LoadEntries(ClientContext &context) {
 		entries[table_name] = std::move(table_entry);
 	}
 }
+
+static string GetCreateTableSQL(const string &database, const string &schema_name, const CreateTableInfo &info) {
+	auto &columns = info.columns;
+	vector<bool> not_null(columns.LogicalColumnCount(), false);
+	vector<string> key_constraints;
+	for (auto &constraint : info.constraints) {
+		switch (constraint->type) {
+		case ConstraintType::NOT_NULL:
+			not_null[constraint->Cast<NotNullConstraint>().index.index] = true;
+			break;
+		case ConstraintType::UNIQUE: {
+			// Not enforced by Snowflake (except NOT NULL), but recorded for tools and MERGE keys
+			auto &unique = constraint->Cast<UniqueConstraint>();
+			vector<string> key_columns;
+			if (unique.HasIndex()) {
+				key_columns.push_back(columns.GetColumn(unique.GetIndex()).Name());
+			} else {
+				key_columns = unique.GetColumnNames();
+			}
+			string key_sql = unique.IsPrimaryKey() ? "PRIMARY KEY (" : "UNIQUE (";
+			for (idx_t i = 0; i < key_columns.size(); i++) {
+				key_sql += (i > 0 ? ", " : "") + SnowflakeQueryBuilder::WriteIdentifier(key_columns[i]);
+			}
+			key_constraints.push_back(key_sql + ")");
+			break;
+		}
+		default:
+			throw NotImplementedException("Constraint type %s is not supported for Snowflake tables",
+			                              EnumUtil::ToString(constraint->type));
+		}
+	}
+
+	string sql = "CREATE ";
+	if (info.on_conflict == OnCreateConflict::REPLACE_ON_CONFLICT) {
+		sql += "OR REPLACE ";
+	}
+	sql += "TABLE ";
+	if (info.on_conflict == OnCreateConflict::IGNORE_ON_CONFLICT) {
+		sql += "IF NOT EXISTS ";
+	}
+	sql += database + "." + KeywordHelper::WriteQuoted(schema_name, '"') + "." +
+	       SnowflakeQueryBuilder::WriteIdentifier(info.table) + " (";
+
+	idx_t column_count = 0;
+	for (auto &column : columns.Logical()) {
+		if (column.Generated()) {
+			throw NotImplementedException("Generated columns are not supported for Snowflake tables");
+		}
+		sql += (column_count++ > 0 ? ", " : "") + SnowflakeQueryBuilder::WriteIdentifier(column.Name()) + " " +
+		       LogicalTypeToSnowflakeType(column.Type());
+		if (not_null[column.Logical().index]) {
+			sql += " NOT NULL";
+		}
+		if (column.HasDefaultValue()) {
+			auto &default_value = column.DefaultValue();
+			if (default_value.GetExpressionClass() != ExpressionClass::CONSTANT) {
+				throw NotImplementedException("Only constant DEFAULT values are supported for Snowflake tables");
+			}
+			sql += " DEFAULT " + default_value.Cast<ConstantExpression>().value.ToSQLString();
+		}
+	}
+	for (auto &key_constraint : key_constraints) {
+		sql += ", " + key_constraint;
+	}
+	return sql + ")";
+}
+
+optional_ptr<CatalogEntry> SnowflakeTableSet::CreateTable(ClientContext &context, BoundCreateTableInfo &info,
+                                                          const string &source) {
+	auto &base = info.Base();
+	auto table_name = SnowflakeQueryBuilder::NormalizeIdentifier(base.table);
+	if (base.on_conflict == OnCreateConflict::IGNORE_ON_CONFLICT && GetEntry(table_name)) {
+		return nullptr;
+	}
+
+	auto sql = GetCreateTableSQL(client->GetConfig().database, schema_name, base);
+	if (!source.empty()) {
+		// CREATE OR REPLACE ... AS SELECT only replaces an existing table once all rows are written
+		sql += " AS SELECT * FROM " + source;
+	}
+	DPRINT("SnowflakeTableSet::CreateTable: %s\n", sql.c_str());
+	client->ExecuteUpdate(sql);
+
+	CreateTableInfo entry_info;
+	entry_info.table = table_name;
+	entry_info.schema = schema_name;
+	entry_info.catalog = schema.catalog.GetName();
+	entry_info.on_conflict = OnCreateConflict::IGNORE_ON_CONFLICT;
+	entry_info.temporary = false;
+
+	// Columns are read back from Snowflake so they match the types a scan of the table returns
+	auto table_entry = make_uniq<SnowflakeTableEntry>(schema.catalog, schema, entry_info, client);
+	table_entry->LoadColumns(context);
+	return CreateEntry(std::move(table_entry));
+}
+
 } // namespace snowflake
 } // namespace duckdb